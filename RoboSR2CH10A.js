@@ -14,7 +14,7 @@ const definition = {
     model: 'SR2CH10A',
     vendor: 'Robo',
     description: 'RoboSR2CH10A',
-    fromZigbee: [fz.on_off, fz.identify, {
+    fromZigbee: [fz.on_off, fz.identify, fz.power_on_behavior, {
         cluster: 'genOnOff',
         type: ['attributeReport', 'readResponse', 'commandOn', 'commandOff', 'commandToggle'],
         convert: (model, msg, publish, options, meta) => {
@@ -93,7 +93,7 @@ const definition = {
             }
         },
     }],
-    toZigbee: [tz.on_off, tz.identify, {
+    toZigbee: [tz.on_off, tz.identify, tz.power_on_behavior, {
         key: ['state_1', 'state_2', 'state'],
         convertSet: async (entity, key, value, meta) => {
             let endpoint, state;
@@ -150,6 +150,8 @@ const definition = {
     exposes: [
         e.switch().withEndpoint('1').withDescription('Relay 1 control (toggle via short button press)'),
         e.switch().withEndpoint('2').withDescription('Relay 2 control'),
+        e.power_on_behavior(['off', 'on', 'toggle', 'previous']).withEndpoint('1'),
+        e.power_on_behavior(['off', 'on', 'toggle', 'previous']).withEndpoint('2'),
         // e.identify().withDescription('Identify the device (via Zigbee or long button press for pairing)'), // TODO: Пока не реализовано в коде устройства - нужно добавить обработку команд identify в main.c
     ],
     meta: {
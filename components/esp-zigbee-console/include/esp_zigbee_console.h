@@ -44,6 +44,17 @@ esp_err_t esp_zb_console_deinit(void);
  */
 esp_err_t esp_zb_console_manage_ep_list(esp_zb_ep_list_t *ep_list);
 
+/**
+ * @brief Set the application ZCL command send status handler.
+ *
+ * The stack has a single send status callback slot. Console commands that
+ * temporarily take it over (ping, iperf) restore this handler when they finish
+ * instead of clearing the slot.
+ *
+ * @param cb  Application send status callback, NULL means none.
+ */
+void esp_zb_console_set_send_status_handler(esp_zb_zcl_command_send_status_callback_t cb);
+
 #ifdef __cplusplus
 }
 #endif
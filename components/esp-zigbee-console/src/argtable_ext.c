@@ -15,6 +15,19 @@
 #include "cmdline_parser.h"
 
 #include "argtable_ext.h"
+#include "heap_monitor.h"
+
+HEAP_MONITOR_TAG_DEFINE(s_argtable_tag, "argtable");
+
+void *arg_ext_malloc(size_t size)
+{
+    return HEAP_TAGGED_MALLOC(s_argtable_tag, size);
+}
+
+void arg_ext_free(void *ptr)
+{
+    HEAP_TAGGED_FREE(s_argtable_tag, ptr);
+}
 
 static void arg_common_resetfn(struct arg_lit* parent)
 {
@@ -90,7 +103,7 @@ arg_u8_t *arg_u8n(const char* shortopts, const char* longopts, const char* datat
 
     nbytes = sizeof(arg_u8_t) + (size_t)maxcount * sizeof(uint8_t);
 
-    result = (arg_u8_t*)malloc(nbytes);
+    result = (arg_u8_t*)arg_ext_malloc(nbytes);
 
     /* init the arg_hdr struct */
     result->hdr.flag = ARG_HASVALUE;
@@ -141,7 +154,7 @@ arg_u16_t *arg_u16n(const char* shortopts, const char* longopts, const char* dat
 
     nbytes = sizeof(arg_u16_t) + (size_t)maxcount * sizeof(uint16_t);
 
-    result = (arg_u16_t*)malloc(nbytes);
+    result = (arg_u16_t*)arg_ext_malloc(nbytes);
 
     /* init the arg_hdr struct */
     result->hdr.flag = ARG_HASVALUE;
@@ -192,7 +205,7 @@ arg_u32_t *arg_u32n(const char* shortopts, const char* longopts, const char* dat
 
     nbytes = sizeof(arg_u32_t) + (size_t)maxcount * sizeof(uint32_t);
 
-    result = (arg_u32_t*)malloc(nbytes);
+    result = (arg_u32_t*)arg_ext_malloc(nbytes);
 
     /* init the arg_hdr struct */
     result->hdr.flag = ARG_HASVALUE;
@@ -228,7 +241,7 @@ static esp_err_t arg_hex_scanfn(arg_hex_t* parent, const char* argval)
         if (!(0 < buffer_len && buffer_len < UINT16_MAX)) {
             return ESP_ERR_INVALID_SIZE;
         }
-        buffer = malloc(buffer_len);
+        buffer = arg_ext_malloc(buffer_len);
         if (buffer == NULL){
             return ESP_ERR_NO_MEM;
         }
@@ -238,7 +251,7 @@ static esp_err_t arg_hex_scanfn(arg_hex_t* parent, const char* argval)
             parent->hval[parent->count] = buffer;
             parent->count++;
         } else {
-            free(buffer);
+            arg_ext_free(buffer);
         }
     }
 
@@ -255,7 +268,7 @@ arg_hex_t *arg_hexn(const char* shortopts, const char* longopts, const char* dat
 
     nbytes = sizeof(arg_hex_t) + (size_t)maxcount * (sizeof(uint16_t) + sizeof(uint8_t *));
 
-    result = (arg_hex_t*)malloc(nbytes);
+    result = (arg_hex_t*)arg_ext_malloc(nbytes);
 
     /* init the arg_hdr struct */
     result->hdr.flag = ARG_HASVALUE;
@@ -282,7 +295,7 @@ void arg_hex_free(arg_hex_t* parent)
 {
     for (int i = 0; i < parent->count; i++) {
         if (parent->hval[i] != NULL) {
-            free(parent->hval[i]);
+            arg_ext_free(parent->hval[i]);
         }
     }
 }
@@ -340,7 +353,7 @@ arg_addr_t* arg_addrn(const char* shortopts, const char* longopts, const char* d
 
     nbytes = sizeof(arg_addr_t) + (size_t)maxcount * sizeof(esp_zb_zcl_addr_t);
 
-    result = (arg_addr_t*)malloc(nbytes);
+    result = (arg_addr_t*)arg_ext_malloc(nbytes);
 
     /* init the arg_hdr struct */
     result->hdr.flag = ARG_HASVALUE;
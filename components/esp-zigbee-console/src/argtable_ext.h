@@ -21,6 +21,15 @@ extern "C" {
 
 #define ESP_ZB_CLI_FREE_ARGSTRUCT(p_args) arg_freetable((void**)p_args, sizeof(*p_args) / sizeof(void*))
 
+/**
+ * @brief Allocators for argtable objects, tagged as "argtable" in the heap monitor.
+ *
+ * Installed with arg_set_allocators() so that the argtable core and these extensions
+ * allocate and free through the same tag.
+ */
+void *arg_ext_malloc(size_t size);
+void arg_ext_free(void *ptr);
+
 typedef struct arg_u8 {
     struct arg_hdr hdr; /* The mandatory argtable header struct */
     int count;          /* Number of matching command line args */
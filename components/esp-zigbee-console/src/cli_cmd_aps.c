@@ -13,9 +13,12 @@
 #include "aps/esp_zigbee_aps.h"
 #include "cmdline_parser.h"
 #include "cli_cmd_aps.h"
+#include "heap_monitor.h"
 
 #define TAG "cli_cmd_aps"
 
+HEAP_MONITOR_TAG_DEFINE(s_aps_asdu_tag, "aps_asdu");
+
 void esp_zb_cli_fill_aps_argtable(esp_zb_cli_aps_argtable_t *aps)
 {
     aps->dst_addr = arg_addrn("d", "dst-addr", "<addr:ADDR>", 0, 1, "destination address");
@@ -141,7 +144,7 @@ static esp_err_t cli_aps_send_raw(esp_zb_cli_cmd_t *self, int argc, char **argv)
     if (argtable.payload->count > 0 && repeat_count > 0) {
         uint32_t repeat_length = argtable.payload->hsize[0];
         req_params.asdu_length = repeat_length * repeat_count;
-        req_params.asdu = (uint8_t *)malloc(req_params.asdu_length);
+        req_params.asdu = (uint8_t *)HEAP_TAGGED_MALLOC(s_aps_asdu_tag, req_params.asdu_length);
         EXIT_ON_FALSE(req_params.asdu, ESP_ERR_NO_MEM, cli_output_line("no memory for aps send raw"));
         for (int i = 0; i < repeat_count; i++) {
             memcpy(req_params.asdu + i * repeat_length, argtable.payload->hval[0], repeat_length);
@@ -156,7 +159,7 @@ static esp_err_t cli_aps_send_raw(esp_zb_cli_cmd_t *self, int argc, char **argv)
     
 exit:
     if (req_params.asdu) {
-        free(req_params.asdu);
+        HEAP_TAGGED_FREE(s_aps_asdu_tag, req_params.asdu);
     }
     arg_hex_free(argtable.payload);
     ESP_ZB_CLI_FREE_ARGSTRUCT(&argtable);
@@ -15,6 +15,8 @@
 
 #include "esp_zigbee_console.h"
 #include "cli_cmd.h"
+#include "task_profiler.h"
+#include "heap_monitor.h"
 
 #define TAG "cli_cmd_misc"
 
@@ -204,7 +206,7 @@ static esp_err_t cli_memory_diag(esp_zb_cli_cmd_t *self, int argc, char **argv)
         arg_str_t *memory_type;
         arg_end_t *end;
     } argtable = {
-        .memory_type = arg_strn(NULL, NULL, "<heap|stack>", 1, 1, "Memory type"),
+        .memory_type = arg_strn(NULL, NULL, "<heap|history|allocs|stack|tasks>", 1, 1, "Memory type"),
         .end = arg_end(2),
     };
     esp_err_t ret = ESP_OK;
@@ -218,11 +220,59 @@ static esp_err_t cli_memory_diag(esp_zb_cli_cmd_t *self, int argc, char **argv)
         cli_output("Cur Free Heap: %d bytes\n", heap_caps_get_free_size(MALLOC_CAP_DEFAULT));
         cli_output("Min Free Heap: %d bytes\n", heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT));
         cli_output("Max Free Heap: %d bytes\n", heap_caps_get_total_size(MALLOC_CAP_DEFAULT));
+        heap_sample_t sample;
+        heap_monitor_sample(&sample);
+        cli_output("Largest Free Block: %lu bytes\n", (unsigned long)sample.largest_block);
+        cli_output("Fragmentation: %u.%u%%\n", sample.frag_permille / 10, sample.frag_permille % 10);
+    } else if (!strcmp(argtable.memory_type->sval[0], "history")) {
+        static heap_sample_t samples[HEAP_MONITOR_HISTORY];
+        size_t count = heap_monitor_get_history(samples);
+        EXIT_ON_FALSE(count > 0, ESP_ERR_INVALID_STATE, cli_output("No heap history sampled yet\n"));
+        cli_output("%10s %10s %10s %10s %7s\n", "Uptime(s)", "Free", "Min free", "Largest", "Frag");
+        for (size_t i = 0; i < count; i++) {
+            cli_output("%10lu %10lu %10lu %10lu %5u.%u%%\n", (unsigned long)samples[i].uptime_s,
+                       (unsigned long)samples[i].free_bytes, (unsigned long)samples[i].min_free_bytes,
+                       (unsigned long)samples[i].largest_block,
+                       samples[i].frag_permille / 10, samples[i].frag_permille % 10);
+        }
+    } else if (!strcmp(argtable.memory_type->sval[0], "allocs")) {
+        size_t count = heap_monitor_tag_count();
+        EXIT_ON_FALSE(count > 0, ESP_ERR_INVALID_STATE, cli_output("No tagged allocations yet\n"));
+        cli_output("%-12s %8s %8s %6s %8s %8s %10s\n", "Site", "Allocs", "Frees", "Fails", "Live", "Peak", "Total");
+        for (size_t i = 0; i < count; i++) {
+            heap_monitor_tag_t tag;
+            if (heap_monitor_tag_get(i, &tag) != ESP_OK) {
+                break;
+            }
+            cli_output("%-12s %8lu %8lu %6lu %8lu %8lu %10llu\n", tag.name,
+                       (unsigned long)tag.allocs, (unsigned long)tag.frees, (unsigned long)tag.failures,
+                       (unsigned long)tag.live_bytes, (unsigned long)tag.peak_bytes,
+                       (unsigned long long)tag.total_bytes);
+        }
     } else if (!strcmp(argtable.memory_type->sval[0], "stack")) {
-        const char *task_name = "Zigbee_main";
+        const char *task_name = "Zigbee_task";
         TaskHandle_t task_handle;
         EXIT_ON_FALSE((task_handle = xTaskGetHandle(task_name)) != NULL, ESP_ERR_NOT_FOUND);
         cli_output("Min Free Stack: %d bytes\n", uxTaskGetStackHighWaterMark(task_handle));
+    } else if (!strcmp(argtable.memory_type->sval[0], "tasks")) {
+        static task_profiler_snapshot_t snapshot;
+        task_profiler_get_snapshot(&snapshot);
+        EXIT_ON_FALSE(snapshot.samples > 0, ESP_ERR_INVALID_STATE, cli_output("No task profile sampled yet\n"));
+        cli_output("%-16s %4s %-5s %10s %7s %7s %7s %10s\n",
+                   "Task", "Prio", "State", "Stack free", "CPU win", "CPU all", "Active", "Heap");
+        for (uint32_t i = 0; i < snapshot.task_count; i++) {
+            const task_profile_t *task = &snapshot.tasks[i];
+            cli_output("%-16s %4u %-5s %10lu %5u.%u%% %5u.%u%% %7lu %10lu\n", task->name,
+                       (unsigned)task->priority, task_profiler_state_to_string(task->state),
+                       (unsigned long)task->stack_free_min,
+                       task->cpu_window_permille / 10, task->cpu_window_permille % 10,
+                       task->cpu_total_permille / 10, task->cpu_total_permille % 10,
+                       (unsigned long)task->active_windows, (unsigned long)task->heap_bytes);
+        }
+        cli_output("Samples: %lu, active = windows with CPU time (of %lu)%s%s\n",
+                   (unsigned long)snapshot.samples, (unsigned long)snapshot.samples,
+                   snapshot.runtime_stats ? "" : ", run time stats disabled",
+                   snapshot.heap_tracking ? "" : ", heap task tracking disabled");
     } else {
         EXIT_ON_ERROR(ESP_ERR_INVALID_ARG);
     }
@@ -13,6 +13,8 @@
 #include "cli_cmd.h"
 #include "cli_cmd_zcl.h"
 #include "esp_zigbee_console.h"
+#include "zb_lock_profiler.h"
+#include "argtable_ext.h"
 
 #define TAG "esp-zigbee-console"
 
@@ -23,6 +25,8 @@ typedef struct esp_zigbee_console_context_s {
 } esp_zigbee_console_context_t;
 
 static esp_zigbee_console_context_t *s_console_ctx = NULL;
+ZB_LOCK_SITE_DEFINE(s_cli_lock_site, "console_cmd");
+static esp_zb_zcl_command_send_status_callback_t s_app_send_status_cb = NULL;
 
 static esp_err_t esp_zb_console_init_ctx(void)
 {
@@ -98,6 +102,17 @@ esp_err_t esp_zb_console_notify_result(esp_err_t result) {
     return ret;
 }
 
+void esp_zb_console_set_send_status_handler(esp_zb_zcl_command_send_status_callback_t cb)
+{
+    s_app_send_status_cb = cb;
+    esp_zb_zcl_command_send_status_handler_register(cb);
+}
+
+void esp_zb_console_restore_send_status_handler(void)
+{
+    esp_zb_zcl_command_send_status_handler_register(s_app_send_status_cb);
+}
+
 static esp_err_t esp_zb_console_cmd_handler(int argc, char **argv)
 {
     extern const esp_zb_cli_cmd_t _esp_zb_cli_cmd_array_start;
@@ -106,9 +121,9 @@ static esp_err_t esp_zb_console_cmd_handler(int argc, char **argv)
     esp_err_t ret = ESP_ERR_NOT_FOUND;
     for (const esp_zb_cli_cmd_t *cmd = &_esp_zb_cli_cmd_array_start; cmd != &_esp_zb_cli_cmd_array_end; cmd++) {
         if (!strcmp(argv[0], cmd->name)) {
-            esp_zb_lock_acquire(portMAX_DELAY);
+            zb_lock_acquire(&s_cli_lock_site, portMAX_DELAY);
             ret = esp_zb_cli_process_cmd((esp_zb_cli_cmd_t *)cmd, argc, argv);
-            esp_zb_lock_release();
+            zb_lock_release(&s_cli_lock_site);
             if (ret == ESP_ERR_NOT_FINISHED) {
                 ret = esp_zb_console_wait_result();
             }
@@ -185,6 +200,9 @@ esp_err_t esp_zb_console_init(void)
 {
     esp_err_t ret = ESP_OK;
 
+#if CONFIG_HEAP_MONITOR_ALLOC_TAGS
+    arg_set_allocators(arg_ext_malloc, arg_ext_free);
+#endif
     ESP_GOTO_ON_ERROR(esp_zb_console_init_ctx(), exit, TAG, "Fail to init console context");
     ESP_GOTO_ON_ERROR(esp_zb_console_cmd_register_all(), exit, TAG, "Fail to register all commands");
     ESP_GOTO_ON_ERROR(esp_zb_console_repl_init(), exit, TAG, "Fail to init console REPL");
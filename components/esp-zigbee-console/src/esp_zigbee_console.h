@@ -22,6 +22,8 @@ esp_zb_cli_context_t *esp_zb_console_get_cli_ctx(void);
 
 esp_err_t esp_zb_console_notify_result(esp_err_t result);
 
+void esp_zb_console_restore_send_status_handler(void);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
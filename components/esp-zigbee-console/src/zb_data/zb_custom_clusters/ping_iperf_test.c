@@ -8,8 +8,13 @@
 #include "esp_timer.h"
 #include "esp_check.h"
 #include "ping_iperf_test.h"
+#include "../../esp_zigbee_console.h"
+#include "heap_monitor.h"
 
 #define TAG "ping_iperf_test"
+
+HEAP_MONITOR_TAG_DEFINE(s_ping_req_tag, "ping_req");
+HEAP_MONITOR_TAG_DEFINE(s_iperf_msg_tag, "iperf_msg");
 #define IS_ADDRESS_BROADCAST(addr) ((addr) >= 0xfff8)
 
 typedef struct iperf_context {
@@ -106,12 +111,12 @@ static void zb_ping_iperf_test_cluster_ping_req_send_status_callback(esp_zb_zcl_
     } else {
         ESP_LOGI(TAG, "Ping request success, tsn: %d", ping_ctx.ping_tsn);
     }
-    esp_zb_zcl_command_send_status_handler_register(NULL);
+    esp_zb_console_restore_send_status_handler();
 }
 
 static void ping_timeout_handler(uint8_t param)
 {
-    esp_zb_zcl_command_send_status_handler_register(NULL);
+    esp_zb_console_restore_send_status_handler();
     if (!ping_ctx.is_broadcast) {
         ESP_LOGE(TAG, "No ping response received, tsn: %d", ping_ctx.ping_tsn);
         finish_ping(ESP_FAIL);
@@ -138,7 +143,7 @@ esp_err_t esp_zb_ping_iperf_test_cluster_ping_req(const esp_zb_ping_req_info_t *
     req.zcl_basic_cmd.dst_endpoint = info->dst_ep;
     req.data.type = ESP_ZB_ZCL_ATTR_TYPE_SET;
     req.data.size = info->payload_len;
-    req.data.value = malloc(req.data.size);
+    req.data.value = HEAP_TAGGED_MALLOC(s_ping_req_tag, req.data.size);
     ESP_RETURN_ON_FALSE(req.data.value, ESP_ERR_NO_MEM, TAG, "malloc ping req data failed");
     memset(req.data.value, 1, req.data.size);
     uint8_t *value_ptr = (uint8_t *)req.data.value;
@@ -155,7 +160,7 @@ esp_err_t esp_zb_ping_iperf_test_cluster_ping_req(const esp_zb_ping_req_info_t *
     esp_zb_scheduler_alarm(ping_timeout_handler, 0, ping_ctx.timeout);
     ping_ctx.is_in_progress = true;
     ESP_LOGI(TAG, "Request to ping address: 0x%04x", req.zcl_basic_cmd.dst_addr_u.addr_short);
-    free(req.data.value);
+    HEAP_TAGGED_FREE(s_ping_req_tag, req.data.value);
 
     return ESP_OK;
 }
@@ -286,9 +291,9 @@ static void do_iperf(uint8_t param)
         iperf_ctx.message_to_iperf->custom_cmd_id = ESP_ZB_ZCL_CMD_PING_IPERF_TEST_IPERF_PROCESS;
     } else {
         if (iperf_ctx.message_to_iperf) {
-            free(iperf_ctx.message_to_iperf->data.value);
+            HEAP_TAGGED_FREE(s_iperf_msg_tag, iperf_ctx.message_to_iperf->data.value);
             iperf_ctx.message_to_iperf->data.value = NULL;
-            free(iperf_ctx.message_to_iperf);
+            HEAP_TAGGED_FREE(s_iperf_msg_tag, iperf_ctx.message_to_iperf);
             iperf_ctx.message_to_iperf = NULL;
         }
         iperf_ctx.client_in_progress = false;
@@ -322,7 +327,7 @@ static esp_zb_zcl_attr_t *zb_ping_iperf_get_iperf_attribute_val(uint8_t endpoint
 static esp_err_t iperf_message_set(const esp_zb_iperf_req_info_t *info)
 {
     esp_err_t ret = ESP_OK;
-    iperf_ctx.message_to_iperf = malloc(sizeof(esp_zb_zcl_custom_cluster_cmd_t));
+    iperf_ctx.message_to_iperf = HEAP_TAGGED_MALLOC(s_iperf_msg_tag, sizeof(esp_zb_zcl_custom_cluster_cmd_t));
     ESP_RETURN_ON_FALSE(iperf_ctx.message_to_iperf, ESP_FAIL, TAG, "Failed to allocate memory for iperf request data");
     iperf_ctx.message_to_iperf->zcl_basic_cmd.src_endpoint = info->src_endpoint;
     iperf_ctx.message_to_iperf->zcl_basic_cmd.dst_endpoint = info->dst_endpoint;
@@ -339,16 +344,16 @@ static esp_err_t iperf_message_set(const esp_zb_iperf_req_info_t *info)
 
     if (!attr || (*(uint16_t *)(attr->data_p)) == 0) {
         ESP_LOGE(TAG, "The length of the iperf payload should not be zero.");
-        free(iperf_ctx.message_to_iperf);
+        HEAP_TAGGED_FREE(s_iperf_msg_tag, iperf_ctx.message_to_iperf);
         return ESP_FAIL;
     }
     iperf_ctx.message_to_iperf->data.type = ESP_ZB_ZCL_ATTR_TYPE_SET;
     iperf_ctx.message_to_iperf->data.size = *(uint16_t *)(attr->data_p);
     iperf_ctx.iperf_data_len = *(uint16_t *)(attr->data_p);
-    iperf_ctx.message_to_iperf->data.value = calloc(1, iperf_ctx.message_to_iperf->data.size);
+    iperf_ctx.message_to_iperf->data.value = HEAP_TAGGED_CALLOC(s_iperf_msg_tag, 1, iperf_ctx.message_to_iperf->data.size);
     if (iperf_ctx.message_to_iperf->data.value == NULL) {
         ESP_LOGE(TAG, "Failed to allocate memory for iperf request data.value");
-        free(iperf_ctx.message_to_iperf);
+        HEAP_TAGGED_FREE(s_iperf_msg_tag, iperf_ctx.message_to_iperf);
         return ESP_FAIL;
     }
 
@@ -420,6 +425,6 @@ float esp_zb_ping_iperf_get_iperf_result(uint8_t endpoint, uint8_t cluster_role)
         return throughput;
     }
     throughput = *(float *)(attr->data_p);
-    esp_zb_zcl_command_send_status_handler_register(NULL);
+    esp_zb_console_restore_send_status_handler();
     return throughput;
 }
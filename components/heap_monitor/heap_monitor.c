@@ -0,0 +1,172 @@
+/*
+ * Heap Monitor
+ *
+ * История фрагментации кучи и учет выделений по местам (см. heap_monitor.h).
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "heap_monitor.h"
+
+static const char *TAG = "HEAP_MONITOR";
+
+static heap_sample_t s_history[HEAP_MONITOR_HISTORY];
+static size_t s_history_head = 0;        // Позиция следующей записи
+static size_t s_history_count = 0;
+static heap_monitor_tag_t *s_tags[HEAP_MONITOR_MAX_TAGS];
+static size_t s_tag_count = 0;
+static portMUX_TYPE s_monitor_lock = portMUX_INITIALIZER_UNLOCKED;
+static TimerHandle_t s_timer = NULL;
+
+void heap_monitor_sample(heap_sample_t *sample)
+{
+    size_t free_bytes = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+
+    sample->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    sample->free_bytes = free_bytes;
+    sample->min_free_bytes = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    sample->largest_block = largest;
+    sample->frag_permille = free_bytes > 0 ? (uint16_t)(1000 - (uint64_t)largest * 1000 / free_bytes) : 0;
+}
+
+/**
+ * @brief Callback таймера истории (задача таймеров)
+ */
+static void heap_monitor_timer_cb(TimerHandle_t timer)
+{
+    heap_sample_t sample;
+    heap_monitor_sample(&sample);
+
+    portENTER_CRITICAL(&s_monitor_lock);
+    s_history[s_history_head] = sample;
+    s_history_head = (s_history_head + 1) % HEAP_MONITOR_HISTORY;
+    if (s_history_count < HEAP_MONITOR_HISTORY) {
+        s_history_count++;
+    }
+    portEXIT_CRITICAL(&s_monitor_lock);
+
+    ESP_LOGD(TAG, "free %lu, min %lu, largest %lu, frag %u.%u%%",
+             (unsigned long)sample.free_bytes, (unsigned long)sample.min_free_bytes,
+             (unsigned long)sample.largest_block, sample.frag_permille / 10, sample.frag_permille % 10);
+}
+
+esp_err_t heap_monitor_start(void)
+{
+    if (s_timer != NULL) {
+        return ESP_OK;
+    }
+
+    s_timer = xTimerCreate("heap_monitor", pdMS_TO_TICKS(HEAP_MONITOR_PERIOD_MS), pdTRUE, NULL,
+                           heap_monitor_timer_cb);
+    if (s_timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTimerStart(s_timer, 0) != pdPASS) {
+        return ESP_FAIL;
+    }
+
+    /* Первая точка - сразу после загрузки */
+    heap_monitor_timer_cb(s_timer);
+    return ESP_OK;
+}
+
+size_t heap_monitor_get_history(heap_sample_t *samples)
+{
+    size_t count;
+
+    portENTER_CRITICAL(&s_monitor_lock);
+    count = s_history_count;
+    for (size_t i = 0; i < count; i++) {
+        size_t index = (s_history_head + HEAP_MONITOR_HISTORY - count + i) % HEAP_MONITOR_HISTORY;
+        samples[i] = s_history[index];
+    }
+    portEXIT_CRITICAL(&s_monitor_lock);
+    return count;
+}
+
+/**
+ * @brief Регистрация места выделения при первом использовании
+ * (вызывается под s_monitor_lock)
+ */
+static void heap_monitor_register(heap_monitor_tag_t *tag)
+{
+    if (!tag->registered && s_tag_count < HEAP_MONITOR_MAX_TAGS) {
+        s_tags[s_tag_count++] = tag;
+        tag->registered = true;
+    }
+}
+
+/**
+ * @brief Учет результата выделения
+ */
+static void heap_monitor_account_alloc(heap_monitor_tag_t *tag, void *ptr)
+{
+    size_t size = ptr ? heap_caps_get_allocated_size(ptr) : 0;
+
+    portENTER_CRITICAL(&s_monitor_lock);
+    heap_monitor_register(tag);
+    if (ptr == NULL) {
+        tag->failures++;
+    } else {
+        tag->allocs++;
+        tag->live_bytes += size;
+        tag->total_bytes += size;
+        if (tag->live_bytes > tag->peak_bytes) {
+            tag->peak_bytes = tag->live_bytes;
+        }
+    }
+    portEXIT_CRITICAL(&s_monitor_lock);
+}
+
+void *heap_monitor_malloc(heap_monitor_tag_t *tag, size_t size)
+{
+    void *ptr = malloc(size);
+    heap_monitor_account_alloc(tag, ptr);
+    return ptr;
+}
+
+void *heap_monitor_calloc(heap_monitor_tag_t *tag, size_t n, size_t size)
+{
+    void *ptr = calloc(n, size);
+    heap_monitor_account_alloc(tag, ptr);
+    return ptr;
+}
+
+void heap_monitor_free(heap_monitor_tag_t *tag, void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    size_t size = heap_caps_get_allocated_size(ptr);
+
+    portENTER_CRITICAL(&s_monitor_lock);
+    tag->frees++;
+    tag->live_bytes = tag->live_bytes > size ? tag->live_bytes - size : 0;
+    portEXIT_CRITICAL(&s_monitor_lock);
+
+    free(ptr);
+}
+
+size_t heap_monitor_tag_count(void)
+{
+    return s_tag_count;
+}
+
+esp_err_t heap_monitor_tag_get(size_t index, heap_monitor_tag_t *snapshot)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&s_monitor_lock);
+    if (index < s_tag_count) {
+        *snapshot = *s_tags[index];
+        err = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_monitor_lock);
+    return err;
+}
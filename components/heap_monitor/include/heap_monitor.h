@@ -0,0 +1,129 @@
+/*
+ * Heap Monitor
+ *
+ * Наблюдение за кучей для роутеров, работающих месяцами без перезагрузки.
+ *
+ * Раз в HEAP_MONITOR_PERIOD_MS программный таймер FreeRTOS записывает в
+ * кольцевой буфер (HEAP_MONITOR_HISTORY точек) свободную память, минимум
+ * свободной памяти с момента загрузки, наибольший свободный блок и
+ * коэффициент фрагментации:
+ *   фрагментация = 1 - наибольший_блок / свободно   (в десятых процента)
+ * Рост фрагментации при стабильном объеме свободной памяти означает, что
+ * крупный буфер скоро не сможет быть выделен.
+ *
+ * Учет по местам выделения (CONFIG_HEAP_MONITOR_ALLOC_TAGS): горячие
+ * аллокаторы выделяют память через HEAP_TAGGED_MALLOC/CALLOC и освобождают
+ * через HEAP_TAGGED_FREE с дескриптором места (HEAP_MONITOR_TAG_DEFINE).
+ * Для места считаются выделения, освобождения, ошибки, живые байты и пик.
+ * Растущие живые байты - утечка, большое число выделений - churn.
+ * Без CONFIG_HEAP_MONITOR_ALLOC_TAGS макросы раскрываются в malloc/free.
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HEAP_MONITOR_PERIOD_MS      60000   // Период записи истории
+#define HEAP_MONITOR_HISTORY        60      // Точек истории (час при периоде 60 с)
+#define HEAP_MONITOR_MAX_TAGS       16      // Максимум мест выделения
+
+/* Точка истории кучи */
+typedef struct {
+    uint32_t uptime_s;               // Время снимка от загрузки
+    uint32_t free_bytes;             // Свободно
+    uint32_t min_free_bytes;         // Минимум свободной памяти с момента загрузки
+    uint32_t largest_block;          // Наибольший свободный блок
+    uint16_t frag_permille;          // Фрагментация (0.1 %)
+} heap_sample_t;
+
+/* Место выделения */
+typedef struct heap_monitor_tag {
+    const char *name;                // Имя места выделения
+    bool registered;                 // Место добавлено в реестр
+    uint32_t allocs;                 // Успешных выделений
+    uint32_t frees;                  // Освобождений
+    uint32_t failures;               // Неудачных выделений
+    uint32_t live_bytes;             // Занято сейчас
+    uint32_t peak_bytes;             // Максимум занятого
+    uint64_t total_bytes;            // Всего выделено
+} heap_monitor_tag_t;
+
+/**
+ * @brief Определение дескриптора места выделения
+ * @param var Имя переменной
+ * @param tag_name Имя места (для консоли)
+ */
+#define HEAP_MONITOR_TAG_DEFINE(var, tag_name) static heap_monitor_tag_t var = { .name = (tag_name) }
+
+#if CONFIG_HEAP_MONITOR_ALLOC_TAGS
+#define HEAP_TAGGED_MALLOC(tag, size)       heap_monitor_malloc(&(tag), (size))
+#define HEAP_TAGGED_CALLOC(tag, n, size)    heap_monitor_calloc(&(tag), (n), (size))
+#define HEAP_TAGGED_FREE(tag, ptr)          heap_monitor_free(&(tag), (ptr))
+#else
+#define HEAP_TAGGED_MALLOC(tag, size)       malloc(size)
+#define HEAP_TAGGED_CALLOC(tag, n, size)    calloc((n), (size))
+#define HEAP_TAGGED_FREE(tag, ptr)          free(ptr)
+#endif
+
+/**
+ * @brief Запуск периодической записи истории кучи
+ * @return ESP_OK при успехе
+ */
+esp_err_t heap_monitor_start(void);
+
+/**
+ * @brief Текущее состояние кучи (без записи в историю)
+ * @param sample Буфер для точки
+ */
+void heap_monitor_sample(heap_sample_t *sample);
+
+/**
+ * @brief История кучи
+ * @param samples Буфер (HEAP_MONITOR_HISTORY точек)
+ * @return Количество точек, от старых к новым
+ */
+size_t heap_monitor_get_history(heap_sample_t *samples);
+
+/**
+ * @brief Выделение памяти с учетом места
+ */
+void *heap_monitor_malloc(heap_monitor_tag_t *tag, size_t size);
+
+/**
+ * @brief Выделение обнуленной памяти с учетом места
+ */
+void *heap_monitor_calloc(heap_monitor_tag_t *tag, size_t n, size_t size);
+
+/**
+ * @brief Освобождение памяти, выделенной через то же место
+ */
+void heap_monitor_free(heap_monitor_tag_t *tag, void *ptr);
+
+/**
+ * @brief Количество зарегистрированных мест выделения
+ */
+size_t heap_monitor_tag_count(void);
+
+/**
+ * @brief Снимок статистики места выделения
+ * @param index Номер места (0..heap_monitor_tag_count()-1)
+ * @param snapshot Буфер для снимка
+ * @return ESP_OK или ESP_ERR_NOT_FOUND
+ */
+esp_err_t heap_monitor_tag_get(size_t index, heap_monitor_tag_t *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,84 @@
+/*
+ * Task Profiler
+ *
+ * Единый профиль всех задач FreeRTOS вместо разрозненных проверок
+ * uxTaskGetStackHighWaterMark внутри отдельных задач.
+ *
+ * Снимок снимается программным таймером FreeRTOS (задача таймеров имеет
+ * низкий приоритет, поэтому профилирование не вытесняет рабочие задачи)
+ * раз в TASK_PROFILER_PERIOD_MS. Для каждой задачи собираются:
+ * - доля CPU за последнее окно и за все время (нужен
+ *   CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS);
+ * - минимальный запас стека (high-water mark);
+ * - активность: в скольких окнах задача получала процессор. Ядро
+ *   FreeRTOS не ведет счетчик переключений контекста по задачам, поэтому
+ *   активность - его приближение, не требующее правки ядра;
+ * - занятая куча (нужен CONFIG_HEAP_TASK_TRACKING).
+ *
+ * При запасе стека меньше TASK_PROFILER_STACK_WARN_BYTES выводится
+ * предупреждение (один раз на задачу).
+ */
+
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TASK_PROFILER_PERIOD_MS         5000  // Период снимка
+#define TASK_PROFILER_MAX_TASKS         24    // Максимум задач в снимке
+#define TASK_PROFILER_STACK_WARN_BYTES  512   // Порог предупреждения о стеке
+
+/* Профиль задачи */
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];  // Имя задачи
+    TaskHandle_t handle;                 // Дескриптор задачи
+    UBaseType_t priority;                // Текущий приоритет
+    eTaskState state;                    // Состояние на момент снимка
+    uint32_t stack_free_min;             // Минимальный запас стека (байт)
+    uint16_t cpu_window_permille;        // Доля CPU за последнее окно (0.1 %)
+    uint16_t cpu_total_permille;         // Доля CPU с момента загрузки (0.1 %)
+    uint32_t active_windows;             // Окон, в которых задача получала CPU
+    uint32_t heap_bytes;                 // Занятая куча (байт)
+    uint32_t heap_blocks;                // Занятых блоков кучи
+} task_profile_t;
+
+/* Снимок всех задач */
+typedef struct {
+    uint32_t samples;                    // Снято снимков
+    uint32_t task_count;                 // Задач в снимке
+    bool runtime_stats;                  // Доли CPU доступны
+    bool heap_tracking;                  // Учет кучи по задачам доступен
+    task_profile_t tasks[TASK_PROFILER_MAX_TASKS];
+} task_profiler_snapshot_t;
+
+/**
+ * @brief Запуск периодического профилирования
+ * @return ESP_OK при успехе
+ */
+esp_err_t task_profiler_start(void);
+
+/**
+ * @brief Копия последнего снимка
+ * @param snapshot Буфер для снимка
+ */
+void task_profiler_get_snapshot(task_profiler_snapshot_t *snapshot);
+
+/**
+ * @brief Название состояния задачи
+ */
+const char *task_profiler_state_to_string(eTaskState state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_PROFILER_H
@@ -0,0 +1,218 @@
+/*
+ * Task Profiler
+ *
+ * Периодический профиль задач FreeRTOS (см. task_profiler.h).
+ *
+ * Все рабочие буферы статические: снимок снимается в задаче таймеров,
+ * стек которой невелик.
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "task_profiler.h"
+#if CONFIG_HEAP_TASK_TRACKING
+#include "esp_heap_task_info.h"
+#endif
+
+#if !configUSE_TRACE_FACILITY
+#error "task_profiler requires CONFIG_FREERTOS_USE_TRACE_FACILITY"
+#endif
+
+static const char *TAG = "TASK_PROFILER";
+
+/* Рабочие буферы снимка (используются только в задаче таймеров) */
+static TaskStatus_t s_status[TASK_PROFILER_MAX_TASKS];
+static TaskHandle_t s_prev_handle[TASK_PROFILER_MAX_TASKS];
+static configRUN_TIME_COUNTER_TYPE s_prev_runtime[TASK_PROFILER_MAX_TASKS];
+static uint32_t s_prev_active[TASK_PROFILER_MAX_TASKS];
+static bool s_prev_warned[TASK_PROFILER_MAX_TASKS];
+static size_t s_prev_count = 0;
+static configRUN_TIME_COUNTER_TYPE s_prev_total_runtime = 0;
+#if CONFIG_HEAP_TASK_TRACKING
+static heap_task_totals_t s_heap_totals[TASK_PROFILER_MAX_TASKS];
+#endif
+
+/* Опубликованный снимок */
+static task_profiler_snapshot_t s_snapshot;
+static task_profiler_snapshot_t s_work;
+static portMUX_TYPE s_snapshot_lock = portMUX_INITIALIZER_UNLOCKED;
+static TimerHandle_t s_timer = NULL;
+
+/**
+ * @brief Поиск задачи в предыдущем снимке
+ * @return Индекс или -1
+ */
+static int task_profiler_find_prev(TaskHandle_t handle)
+{
+    for (size_t i = 0; i < s_prev_count; i++) {
+        if (s_prev_handle[i] == handle) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Доля в десятых процента
+ */
+static uint16_t task_profiler_permille(uint64_t part, uint64_t total)
+{
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t value = part * 1000 / total;
+    return value > 1000 ? 1000 : (uint16_t)value;
+}
+
+/**
+ * @brief Заполнение занятой кучи по задачам
+ */
+static void task_profiler_fill_heap(task_profiler_snapshot_t *work)
+{
+#if CONFIG_HEAP_TASK_TRACKING
+    size_t num_totals = 0;
+    heap_task_info_params_t params = {0};
+
+    params.caps[0] = MALLOC_CAP_8BIT;
+    params.mask[0] = MALLOC_CAP_8BIT;
+    params.totals = s_heap_totals;
+    params.num_totals = &num_totals;
+    params.max_totals = TASK_PROFILER_MAX_TASKS;
+    heap_caps_get_per_task_info(&params);
+
+    for (size_t i = 0; i < num_totals; i++) {
+        for (uint32_t t = 0; t < work->task_count; t++) {
+            if (work->tasks[t].handle == s_heap_totals[i].task) {
+                work->tasks[t].heap_bytes = s_heap_totals[i].size[0];
+                work->tasks[t].heap_blocks = s_heap_totals[i].count[0];
+                break;
+            }
+        }
+    }
+    work->heap_tracking = true;
+#else
+    work->heap_tracking = false;
+#endif
+}
+
+/**
+ * @brief Снимок всех задач (только из задачи таймеров)
+ */
+static void task_profiler_sample(void)
+{
+    configRUN_TIME_COUNTER_TYPE total_runtime = 0;
+    UBaseType_t count = uxTaskGetSystemState(s_status, TASK_PROFILER_MAX_TASKS, &total_runtime);
+    configRUN_TIME_COUNTER_TYPE window_runtime = total_runtime - s_prev_total_runtime;
+
+    if (count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, snapshot skipped", TASK_PROFILER_MAX_TASKS);
+        return;
+    }
+
+    memset(&s_work, 0, sizeof(s_work));
+    s_work.samples = s_snapshot.samples + 1;
+    s_work.task_count = count;
+    s_work.runtime_stats = total_runtime != 0;
+
+    static TaskHandle_t handles[TASK_PROFILER_MAX_TASKS];
+    static configRUN_TIME_COUNTER_TYPE runtimes[TASK_PROFILER_MAX_TASKS];
+    static uint32_t actives[TASK_PROFILER_MAX_TASKS];
+    static bool warned[TASK_PROFILER_MAX_TASKS];
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *status = &s_status[i];
+        task_profile_t *task = &s_work.tasks[i];
+        int prev = task_profiler_find_prev(status->xHandle);
+        configRUN_TIME_COUNTER_TYPE delta = status->ulRunTimeCounter - (prev >= 0 ? s_prev_runtime[prev] : 0);
+
+        strncpy(task->name, status->pcTaskName, sizeof(task->name) - 1);
+        task->handle = status->xHandle;
+        task->priority = status->uxCurrentPriority;
+        task->state = status->eCurrentState;
+        task->stack_free_min = status->usStackHighWaterMark * sizeof(StackType_t);
+        task->cpu_window_permille = task_profiler_permille(delta, window_runtime);
+        task->cpu_total_permille = task_profiler_permille(status->ulRunTimeCounter, total_runtime);
+        task->active_windows = (prev >= 0 ? s_prev_active[prev] : 0) + (delta != 0 ? 1 : 0);
+
+        /* Предупреждение о стеке - один раз на задачу */
+        warned[i] = prev >= 0 && s_prev_warned[prev];
+        if (!warned[i] && task->stack_free_min < TASK_PROFILER_STACK_WARN_BYTES) {
+            ESP_LOGW(TAG, "Task %s stack low: %lu bytes remaining",
+                     task->name, (unsigned long)task->stack_free_min);
+            warned[i] = true;
+        }
+
+        handles[i] = status->xHandle;
+        runtimes[i] = status->ulRunTimeCounter;
+        actives[i] = task->active_windows;
+    }
+
+    task_profiler_fill_heap(&s_work);
+
+    memcpy(s_prev_handle, handles, sizeof(handles[0]) * count);
+    memcpy(s_prev_runtime, runtimes, sizeof(runtimes[0]) * count);
+    memcpy(s_prev_active, actives, sizeof(actives[0]) * count);
+    memcpy(s_prev_warned, warned, sizeof(warned[0]) * count);
+    s_prev_count = count;
+    s_prev_total_runtime = total_runtime;
+
+    portENTER_CRITICAL(&s_snapshot_lock);
+    s_snapshot = s_work;
+    portEXIT_CRITICAL(&s_snapshot_lock);
+}
+
+/**
+ * @brief Callback таймера профилирования (задача таймеров)
+ */
+static void task_profiler_timer_cb(TimerHandle_t timer)
+{
+    task_profiler_sample();
+}
+
+esp_err_t task_profiler_start(void)
+{
+    if (s_timer != NULL) {
+        return ESP_OK;
+    }
+
+    s_timer = xTimerCreate("task_profiler", pdMS_TO_TICKS(TASK_PROFILER_PERIOD_MS), pdTRUE, NULL,
+                           task_profiler_timer_cb);
+    if (s_timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTimerStart(s_timer, 0) != pdPASS) {
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Task profiler started (period %d ms)", TASK_PROFILER_PERIOD_MS);
+    return ESP_OK;
+}
+
+void task_profiler_get_snapshot(task_profiler_snapshot_t *snapshot)
+{
+    portENTER_CRITICAL(&s_snapshot_lock);
+    *snapshot = s_snapshot;
+    portEXIT_CRITICAL(&s_snapshot_lock);
+}
+
+const char *task_profiler_state_to_string(eTaskState state)
+{
+    switch (state) {
+    case eRunning:
+        return "run";
+    case eReady:
+        return "ready";
+    case eBlocked:
+        return "block";
+    case eSuspended:
+        return "susp";
+    case eDeleted:
+        return "del";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * Zigbee Lock Profiler
+ *
+ * Инструментированная обертка над esp_zb_lock_acquire/esp_zb_lock_release.
+ *
+ * Каждое место захвата (call site) описывается статическим дескриптором
+ * ZB_LOCK_SITE_DEFINE и регистрируется при первом захвате. Для места
+ * захвата собираются гистограммы времени ожидания и удержания lock в
+ * логарифмической шкале: корзина i содержит интервалы [2^i, 2^(i+1)) мкс,
+ * корзина 0 - интервалы меньше 2 мкс, последняя - все, что длиннее.
+ * Дополнительно хранятся максимумы и имя задачи, на которой они случились,
+ * а также текущий владелец lock.
+ *
+ * Статистика изменяется только владельцем lock, поэтому обновления
+ * упорядочены самим lock; короткая критическая секция нужна лишь для
+ * согласованного снимка при чтении из консоли.
+ *
+ * Захваты внутри esp_zb_stack_main_loop (сам стек) не инструментируются -
+ * их влияние видно как время ожидания у остальных мест захвата.
+ */
+
+#ifndef ZB_LOCK_PROFILER_H
+#define ZB_LOCK_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ZB_LOCK_HIST_BUCKETS        20    // Последняя корзина: от 2^19 мкс (~0.5 с)
+#define ZB_LOCK_MAX_SITES           16    // Максимум зарегистрированных мест захвата
+#define ZB_LOCK_TASK_NAME_LEN       16
+
+/* Дескриптор места захвата */
+typedef struct zb_lock_site {
+    const char *name;                    // Имя места захвата
+    bool registered;                     // Место добавлено в реестр
+    uint32_t acquisitions;               // Успешных захватов
+    uint32_t timeouts;                   // Захватов, завершившихся таймаутом
+    uint32_t wait_hist[ZB_LOCK_HIST_BUCKETS];
+    uint32_t hold_hist[ZB_LOCK_HIST_BUCKETS];
+    uint32_t wait_max_us;                // Максимальное ожидание
+    uint32_t hold_max_us;                // Максимальное удержание
+    uint64_t wait_total_us;              // Суммарное ожидание
+    uint64_t hold_total_us;              // Суммарное удержание
+    char wait_max_task[ZB_LOCK_TASK_NAME_LEN];  // Задача с максимальным ожиданием
+    char hold_max_task[ZB_LOCK_TASK_NAME_LEN];  // Задача с максимальным удержанием
+} zb_lock_site_t;
+
+/* Текущий владелец lock */
+typedef struct {
+    bool held;                           // Lock захвачен через обертку
+    const char *site;                    // Место захвата
+    char task[ZB_LOCK_TASK_NAME_LEN];    // Задача-владелец
+    uint32_t held_us;                    // Время удержания на момент чтения
+} zb_lock_holder_t;
+
+/**
+ * @brief Определение дескриптора места захвата
+ * @param var Имя переменной
+ * @param site_name Имя места захвата (для консоли)
+ */
+#define ZB_LOCK_SITE_DEFINE(var, site_name) static zb_lock_site_t var = { .name = (site_name) }
+
+/**
+ * @brief Захват Zigbee lock с учетом статистики
+ * @param site Место захвата
+ * @param block_ticks Таймаут ожидания (portMAX_DELAY - без ограничения)
+ * @return true - lock захвачен
+ */
+bool zb_lock_acquire(zb_lock_site_t *site, TickType_t block_ticks);
+
+/**
+ * @brief Освобождение Zigbee lock с учетом времени удержания
+ * @param site Место захвата (то же, что в zb_lock_acquire)
+ */
+void zb_lock_release(zb_lock_site_t *site);
+
+/**
+ * @brief Количество зарегистрированных мест захвата
+ */
+size_t zb_lock_site_count(void);
+
+/**
+ * @brief Снимок статистики места захвата
+ * @param index Номер места захвата (0..zb_lock_site_count()-1)
+ * @param snapshot Буфер для снимка
+ * @return ESP_OK или ESP_ERR_NOT_FOUND
+ */
+esp_err_t zb_lock_site_get(size_t index, zb_lock_site_t *snapshot);
+
+/**
+ * @brief Текущий владелец lock
+ * @param holder Буфер для сведений о владельце
+ */
+void zb_lock_holder_get(zb_lock_holder_t *holder);
+
+/**
+ * @brief Сброс статистики всех мест захвата
+ */
+void zb_lock_stats_reset(void);
+
+/**
+ * @brief Нижняя граница корзины гистограммы
+ * @param bucket Номер корзины
+ * @return Граница в мкс
+ */
+uint32_t zb_lock_bucket_floor_us(int bucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ZB_LOCK_PROFILER_H
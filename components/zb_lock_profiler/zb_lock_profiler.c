@@ -0,0 +1,177 @@
+/*
+ * Zigbee Lock Profiler
+ *
+ * Статистика захватов Zigbee lock по местам вызова (см. zb_lock_profiler.h).
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_zigbee_core.h"
+#include "zb_lock_profiler.h"
+
+static zb_lock_site_t *s_sites[ZB_LOCK_MAX_SITES];
+static size_t s_site_count = 0;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Текущий владелец (изменяется только владельцем lock) */
+static zb_lock_site_t *s_holder_site = NULL;
+static TaskHandle_t s_holder_task = NULL;
+static int64_t s_hold_start_us = 0;
+
+/**
+ * @brief Номер корзины для интервала (floor(log2))
+ */
+static int zb_lock_bucket(uint32_t us)
+{
+    int bucket = 0;
+
+    while (us > 1 && bucket < ZB_LOCK_HIST_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+uint32_t zb_lock_bucket_floor_us(int bucket)
+{
+    return bucket <= 0 ? 0 : 1UL << bucket;
+}
+
+/**
+ * @brief Регистрация места захвата при первом использовании
+ */
+static void zb_lock_register(zb_lock_site_t *site)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    if (!site->registered && s_site_count < ZB_LOCK_MAX_SITES) {
+        s_sites[s_site_count++] = site;
+        site->registered = true;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief Копирование имени текущей задачи
+ */
+static void zb_lock_copy_task_name(char *dst, TaskHandle_t task)
+{
+    const char *name = task ? pcTaskGetName(task) : NULL;
+
+    strncpy(dst, name ? name : "?", ZB_LOCK_TASK_NAME_LEN - 1);
+    dst[ZB_LOCK_TASK_NAME_LEN - 1] = '\0';
+}
+
+bool zb_lock_acquire(zb_lock_site_t *site, TickType_t block_ticks)
+{
+    if (!site->registered) {
+        zb_lock_register(site);
+    }
+
+    int64_t wait_start_us = esp_timer_get_time();
+    bool acquired = esp_zb_lock_acquire(block_ticks);
+    int64_t now_us = esp_timer_get_time();
+    uint32_t wait_us = (uint32_t)(now_us - wait_start_us);
+
+    if (!acquired) {
+        portENTER_CRITICAL(&s_stats_lock);
+        site->timeouts++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        return false;
+    }
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&s_stats_lock);
+    site->acquisitions++;
+    site->wait_hist[zb_lock_bucket(wait_us)]++;
+    site->wait_total_us += wait_us;
+    bool new_max = wait_us > site->wait_max_us;
+    if (new_max) {
+        site->wait_max_us = wait_us;
+    }
+    s_holder_site = site;
+    s_holder_task = task;
+    s_hold_start_us = now_us;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    /* Имя задачи копируется вне критической секции - lock уже у нас */
+    if (new_max) {
+        zb_lock_copy_task_name(site->wait_max_task, task);
+    }
+    return true;
+}
+
+void zb_lock_release(zb_lock_site_t *site)
+{
+    uint32_t hold_us = (uint32_t)(esp_timer_get_time() - s_hold_start_us);
+    TaskHandle_t task = s_holder_task;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    site->hold_hist[zb_lock_bucket(hold_us)]++;
+    site->hold_total_us += hold_us;
+    bool new_max = hold_us > site->hold_max_us;
+    if (new_max) {
+        site->hold_max_us = hold_us;
+    }
+    s_holder_site = NULL;
+    s_holder_task = NULL;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    if (new_max) {
+        zb_lock_copy_task_name(site->hold_max_task, task);
+    }
+    esp_zb_lock_release();
+}
+
+size_t zb_lock_site_count(void)
+{
+    return s_site_count;
+}
+
+esp_err_t zb_lock_site_get(size_t index, zb_lock_site_t *snapshot)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    if (index < s_site_count) {
+        *snapshot = *s_sites[index];
+        err = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+    return err;
+}
+
+void zb_lock_holder_get(zb_lock_holder_t *holder)
+{
+    memset(holder, 0, sizeof(*holder));
+
+    portENTER_CRITICAL(&s_stats_lock);
+    zb_lock_site_t *site = s_holder_site;
+    TaskHandle_t task = s_holder_task;
+    int64_t start_us = s_hold_start_us;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    if (site == NULL) {
+        return;
+    }
+    holder->held = true;
+    holder->site = site->name;
+    holder->held_us = (uint32_t)(esp_timer_get_time() - start_us);
+    zb_lock_copy_task_name(holder->task, task);
+}
+
+void zb_lock_stats_reset(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    for (size_t i = 0; i < s_site_count; i++) {
+        zb_lock_site_t *site = s_sites[i];
+        const char *name = site->name;
+
+        memset(site, 0, sizeof(*site));
+        site->name = name;
+        site->registered = true;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
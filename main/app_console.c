@@ -0,0 +1,796 @@
+/*
+ * Application Console
+ *
+ * Команды консоли приложения RoboSR2CH10A (см. app_console.h).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_console.h"
+#include "device_config.h"
+#include "relay_actuator.h"
+#include "relay_event_bus.h"
+#include "attr_reporter.h"
+#include "attr_journal.h"
+#include "zb_commissioning.h"
+#include "zb_network_hint.h"
+#include "boot_profile.h"
+#include "zb_lock_profiler.h"
+#include "latency_trace.h"
+#include "deferred_log.h"
+#include "relay_state_store.h"
+#include "on_off_server.h"
+#include "relay_scheduler.h"
+#include "zb_time_sync.h"
+#include "scenes_server.h"
+#include "groups_server.h"
+#include "on_off_client.h"
+#include "gesture_map.h"
+#include "zb_data_model.h"
+#include "app_console.h"
+
+#if CONFIG_ZB_CONSOLE_ENABLED
+#include "esp_zigbee_console.h"
+
+static const char *TAG = "APP_CONSOLE";
+
+/**
+ * @brief Команда "relay": управление реле и статистика исполнителя
+ *
+ * relay <1|2> <on|off|toggle>
+ * relay stats
+ */
+static int app_console_cmd_relay(int argc, char **argv)
+{
+    if (argc == 2 && !strcmp(argv[1], "stats")) {
+        relay_actuator_stats_t stats;
+        relay_actuator_get_stats(&stats);
+        printf("Submitted:   %lu\n", (unsigned long)stats.submitted);
+        printf("Dropped:     %lu\n", (unsigned long)stats.dropped);
+        printf("Coalesced:   %lu\n", (unsigned long)stats.coalesced);
+        printf("GPIO writes: %lu\n", (unsigned long)stats.gpio_writes);
+        printf("Depth:       %lu (max %lu)\n", (unsigned long)stats.depth, (unsigned long)stats.depth_max);
+        printf("Latency us:  last %lu, min %lu, avg %lu, max %lu\n",
+               (unsigned long)stats.latency_last_us, (unsigned long)stats.latency_min_us,
+               (unsigned long)stats.latency_avg_us, (unsigned long)stats.latency_max_us);
+
+        relay_state_store_stats_t store;
+        relay_state_store_get_stats(&store);
+        printf("Persist:     %lu changes, %lu commits, %lu NVS writes, %lu skipped, %lu errors\n",
+               (unsigned long)store.changes, (unsigned long)store.commits, (unsigned long)store.nvs_writes,
+               (unsigned long)store.skipped, (unsigned long)store.errors);
+        for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+            printf("StartUpOnOff %d: 0x%02x\n", relay_num, relay_state_store_get_startup(relay_num));
+        }
+        return 0;
+    }
+
+    if (argc != 3) {
+        printf("Usage: relay <1-%d> <on|off|toggle> | relay stats\n", RELAY_COUNT);
+        return 1;
+    }
+
+    int relay_num = atoi(argv[1]);
+    if (relay_num < 1 || relay_num > RELAY_COUNT) {
+        printf("Invalid relay number: %s\n", argv[1]);
+        return 1;
+    }
+
+    relay_state_t state;
+    if (!strcmp(argv[2], "on")) {
+        state = RELAY_ON;
+    } else if (!strcmp(argv[2], "off")) {
+        state = RELAY_OFF;
+    } else if (!strcmp(argv[2], "toggle")) {
+        device_status_t status;
+        device_get_status(&status);
+        relay_state_t current = device_relay_state(&status, relay_num);
+        state = (current == RELAY_ON) ? RELAY_OFF : RELAY_ON;
+    } else {
+        printf("Invalid relay state: %s\n", argv[2]);
+        return 1;
+    }
+
+    esp_err_t err = relay_actuator_submit(RELAY_ORIGIN_CONSOLE, relay_num, state);
+    if (err != ESP_OK) {
+        printf("Failed to submit relay command: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Команда "report": статистика и конфигурация планировщика отчетов
+ *
+ * report stats
+ * report config
+ */
+static int app_console_cmd_report(int argc, char **argv)
+{
+    if (argc == 2 && !strcmp(argv[1], "config")) {
+        uint8_t endpoint;
+        uint16_t cluster_id;
+        uint16_t attr_id;
+        attr_report_config_t config;
+        for (uint8_t i = 0; attr_reporter_get_config(i, &endpoint, &cluster_id, &attr_id, &config) == ESP_OK; i++) {
+            printf("EP%d cluster 0x%04x attr 0x%04x: min %us, max %us (%s)\n",
+                   endpoint, cluster_id, attr_id, config.min_interval_s, config.max_interval_s,
+                   config.disabled ? "disabled by coordinator" :
+                   (config.configured ? "configured, reported by the stack" : "default"));
+        }
+        return 0;
+    }
+
+    if (argc != 2 || strcmp(argv[1], "stats")) {
+        printf("Usage: report <stats|config>\n");
+        return 1;
+    }
+
+    attr_reporter_stats_t stats;
+    attr_reporter_get_stats(&stats);
+    printf("Marks:       %lu (coalesced %lu)\n", (unsigned long)stats.marks, (unsigned long)stats.coalesced);
+    printf("Flushes:     %lu\n", (unsigned long)stats.flushes);
+    printf("Frames:      %lu (errors %lu)\n", (unsigned long)stats.frames, (unsigned long)stats.errors);
+    printf("Deferred:    %lu\n", (unsigned long)stats.deferred);
+    printf("Heartbeats:  %lu\n", (unsigned long)stats.heartbeats);
+    printf("Rate limited: %lu, suppressed %lu\n", (unsigned long)stats.rate_limited,
+           (unsigned long)stats.suppressed);
+    printf("Delegated:   %lu (reported by the stack)\n", (unsigned long)stats.delegated);
+    printf("Not delivered: %lu (failed send confirm, journaled)\n", (unsigned long)stats.confirm_failed);
+    printf("Lock wait:   max %lu us\n", (unsigned long)stats.lock_wait_max_us);
+
+    attr_journal_stats_t journal;
+    attr_journal_get_stats(&journal);
+    printf("Journal:     recorded %lu, overwritten %lu, flushed %lu, pending 0x%02lx\n",
+           (unsigned long)journal.recorded, (unsigned long)journal.overwritten,
+           (unsigned long)journal.flushed, (unsigned long)journal.pending_mask);
+    return 0;
+}
+
+/**
+ * @brief Команда "join": статистика подключения к сети
+ *
+ * join stats
+ */
+static int app_console_cmd_join(int argc, char **argv)
+{
+    if (argc != 2 || strcmp(argv[1], "stats")) {
+        printf("Usage: join stats\n");
+        return 1;
+    }
+
+    commissioning_stats_t stats;
+    commissioning_get_stats(&stats);
+    printf("State:        %s\n", commissioning_state_to_string(stats.state));
+    printf("Attempts:     %lu total, %lu in current cycle\n",
+           (unsigned long)stats.attempts_total, (unsigned long)stats.attempts_current);
+    printf("Failures:     %lu\n", (unsigned long)stats.failures_total);
+    printf("Joins:        %lu\n", (unsigned long)stats.joins);
+    printf("Last backoff: %lu ms\n", (unsigned long)stats.last_backoff_ms);
+    printf("Last join:    %lu attempt(s), %lu ms\n",
+           (unsigned long)stats.last_join_attempts, (unsigned long)stats.last_time_to_join_ms);
+    printf("Boot to join: %lu ms\n", (unsigned long)stats.boot_to_join_ms);
+    printf("Hint:         %lu attempt(s), %lu hit(s), %lu fallback(s), last join %s\n",
+           (unsigned long)stats.hint_attempts, (unsigned long)stats.hint_hits,
+           (unsigned long)stats.hint_fallbacks, stats.last_join_hinted ? "hinted" : "full scan");
+
+    zb_network_hint_t hint;
+    if (zb_network_hint_get(&hint)) {
+        printf("Saved net:    channel %d, PAN ID 0x%04x\n", hint.channel, hint.pan_id);
+    } else {
+        printf("Saved net:    none\n");
+    }
+    return 0;
+}
+
+/**
+ * @brief Команда "boot": профиль загрузки
+ *
+ * boot profile
+ */
+static int app_console_cmd_boot(int argc, char **argv)
+{
+    if (argc != 2 || strcmp(argv[1], "profile")) {
+        printf("Usage: boot profile\n");
+        return 1;
+    }
+
+    int64_t prev_us = 0;
+    printf("%-16s %10s %10s\n", "Milestone", "At (ms)", "Step (ms)");
+    for (int i = 0; i < BOOT_MILESTONE_MAX; i++) {
+        int64_t us = boot_profile_get_us((boot_milestone_t)i);
+        if (us < 0) {
+            printf("%-16s %10s %10s\n", boot_profile_milestone_to_string((boot_milestone_t)i), "-", "-");
+            continue;
+        }
+        printf("%-16s %10lld %10lld\n", boot_profile_milestone_to_string((boot_milestone_t)i),
+               us / 1000, (us - prev_us) / 1000);
+        prev_us = us;
+    }
+
+    zb_data_model_stats_t model;
+    zb_data_model_get_stats(&model);
+    printf("Data model: %d endpoints, %d clusters, %d constant attributes\n",
+           model.endpoints, model.clusters, model.attrs);
+    printf("Data model heap: %ld bytes in %ld blocks, built in %lu us\n",
+           (long)model.heap_bytes, (long)model.heap_blocks, (unsigned long)model.build_us);
+    return 0;
+}
+
+/**
+ * @brief Печать ненулевых корзин гистограммы Zigbee lock
+ */
+static void app_console_print_lock_hist(const char *label, const uint32_t *hist)
+{
+    printf("  %s:", label);
+    for (int i = 0; i < ZB_LOCK_HIST_BUCKETS; i++) {
+        if (hist[i] != 0) {
+            printf(" >=%luus:%lu", (unsigned long)zb_lock_bucket_floor_us(i), (unsigned long)hist[i]);
+        }
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Команда "lock": статистика Zigbee lock по местам захвата
+ *
+ * lock stats
+ * lock reset
+ */
+static int app_console_cmd_lock(int argc, char **argv)
+{
+    if (argc != 2) {
+        printf("Usage: lock <stats|reset>\n");
+        return 1;
+    }
+
+    if (!strcmp(argv[1], "reset")) {
+        zb_lock_stats_reset();
+        printf("Lock statistics reset\n");
+        return 0;
+    }
+
+    if (strcmp(argv[1], "stats")) {
+        printf("Usage: lock <stats|reset>\n");
+        return 1;
+    }
+
+    zb_lock_holder_t holder;
+    zb_lock_holder_get(&holder);
+    if (holder.held) {
+        printf("Holder: %s (%s), held %lu us\n", holder.task, holder.site, (unsigned long)holder.held_us);
+    } else {
+        printf("Holder: none\n");
+    }
+
+    for (size_t i = 0; i < zb_lock_site_count(); i++) {
+        zb_lock_site_t site;
+        if (zb_lock_site_get(i, &site) != ESP_OK) {
+            break;
+        }
+
+        uint32_t n = site.acquisitions ? site.acquisitions : 1;
+        printf("%s: %lu acquisitions, %lu timeouts\n", site.name,
+               (unsigned long)site.acquisitions, (unsigned long)site.timeouts);
+        printf("  wait avg %lu us, max %lu us (%s)\n", (unsigned long)(site.wait_total_us / n),
+               (unsigned long)site.wait_max_us, site.wait_max_task[0] ? site.wait_max_task : "-");
+        printf("  hold avg %lu us, max %lu us (%s)\n", (unsigned long)(site.hold_total_us / n),
+               (unsigned long)site.hold_max_us, site.hold_max_task[0] ? site.hold_max_task : "-");
+        app_console_print_lock_hist("wait", site.wait_hist);
+        app_console_print_lock_hist("hold", site.hold_hist);
+    }
+    return 0;
+}
+
+/**
+ * @brief Команда "latency": задержка команд реле по этапам
+ *
+ * latency stats
+ * latency history
+ * latency reset
+ */
+static int app_console_cmd_latency(int argc, char **argv)
+{
+    if (argc != 2) {
+        printf("Usage: latency <stats|history|reset>\n");
+        return 1;
+    }
+
+    if (!strcmp(argv[1], "reset")) {
+        latency_trace_reset();
+        printf("Latency statistics reset\n");
+        return 0;
+    }
+
+    if (!strcmp(argv[1], "history")) {
+        static latency_trace_record_t records[LATENCY_TRACE_HISTORY];
+        size_t count = latency_trace_get_history(records);
+
+        printf("Relay Origin    rx->gpio  gpio->rep  rep->conf (us)\n");
+        for (size_t i = 0; i < count; i++) {
+            const int64_t *st = records[i].stage_us;
+            long spans[3];
+            for (int s = 0; s < 3; s++) {
+                spans[s] = (st[s] != 0 && st[s + 1] != 0) ? (long)(st[s + 1] - st[s]) : -1;
+            }
+            printf("%5d %-8s %9ld %10ld %10ld%s\n", records[i].relay_num,
+                   relay_origin_to_string(records[i].origin), spans[0], spans[1], spans[2],
+                   records[i].failed ? " FAILED" : (records[i].noop ? " NOOP" : ""));
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "stats")) {
+        printf("Usage: latency <stats|history|reset>\n");
+        return 1;
+    }
+
+    static latency_trace_stats_t stats;
+    latency_trace_get_stats(&stats);
+    printf("Traces: %lu started, %lu completed, %lu no-op, %lu abandoned, %lu failed\n",
+           (unsigned long)stats.started, (unsigned long)stats.completed, (unsigned long)stats.noop,
+           (unsigned long)stats.abandoned, (unsigned long)stats.failed);
+    for (int span = 0; span < LATENCY_SPAN_MAX; span++) {
+        printf("%s: max %lu us\n ", latency_trace_span_to_string((latency_span_t)span),
+               (unsigned long)stats.max_us[span]);
+        for (int i = 0; i < LATENCY_TRACE_HIST_BUCKETS; i++) {
+            if (stats.hist[span][i] != 0) {
+                printf(" >=%luus:%lu", i == 0 ? 0UL : 1UL << i, (unsigned long)stats.hist[span][i]);
+            }
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+/**
+ * @brief Команда "onoff": таймеры и глобальная сцена кластера On/Off
+ *
+ * onoff status
+ */
+static int app_console_cmd_onoff(int argc, char **argv)
+{
+    if (argc != 2 || strcmp(argv[1], "status")) {
+        printf("Usage: onoff status\n");
+        return 1;
+    }
+
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        on_off_server_status_t status;
+        on_off_server_get_status(relay_num, &status);
+        printf("Relay %d: GlobalSceneControl %d, global scene %s, OnTime %u, OffWaitTime %u%s\n", relay_num,
+               status.global_scene_control, status.global_scene_on ? "on" : "off",
+               status.on_time, status.off_wait_time, status.off_wait_running ? " (guard running)" : "");
+    }
+
+    on_off_server_stats_t stats;
+    on_off_server_get_stats(&stats);
+    printf("Off with effect:     %lu\n", (unsigned long)stats.off_with_effect);
+    printf("Recall global scene: %lu (%lu ignored)\n", (unsigned long)stats.recall_global_scene,
+           (unsigned long)stats.recall_ignored);
+    printf("On with timed off:   %lu (%lu ignored, %lu during guard)\n", (unsigned long)stats.timed_off,
+           (unsigned long)stats.timed_off_ignored, (unsigned long)stats.timed_off_guarded);
+    printf("Timed off expired:   %lu, late ticks %lu\n", (unsigned long)stats.expirations,
+           (unsigned long)stats.late_ticks);
+
+    on_off_client_stats_t client;
+    on_off_client_get_stats(&client);
+    printf("Bound devices:       queued %lu (%lu dropped, %lu offline), sent %lu\n",
+           (unsigned long)client.queued, (unsigned long)client.dropped, (unsigned long)client.offline,
+           (unsigned long)client.sent);
+    printf("Bound confirms:      %lu ok, %lu failed, %lu lost, last %lu us, max %lu us\n",
+           (unsigned long)client.confirmed, (unsigned long)client.failed, (unsigned long)client.lost,
+           (unsigned long)client.last_confirm_us, (unsigned long)client.max_confirm_us);
+    return 0;
+}
+
+/**
+ * @brief Разбор состояния "on|off" для команды "sched"
+ */
+static bool app_console_parse_sched_state(const char *arg, relay_state_t *state)
+{
+    if (!strcmp(arg, "on")) {
+        *state = RELAY_ON;
+    } else if (!strcmp(arg, "off")) {
+        *state = RELAY_OFF;
+    } else {
+        printf("Invalid relay state: %s\n", arg);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Команда "sched": локальное расписание реле
+ *
+ * sched list
+ * sched countdown <реле> <мс> <on|off>
+ * sched inching <реле> <мс> - 0 выключает импульсный режим
+ * sched weekly <реле> <дни> <ЧЧ:ММ> <on|off> - дни цифрами 0..6 (0 - воскресенье) или "all"
+ * sched remove <id>
+ * sched time [<секунды>] - локальное время с 1970-01-01
+ */
+static int app_console_cmd_sched(int argc, char **argv)
+{
+    static const char *const type_names[RELAY_SCHED_TYPE_MAX] = { "countdown", "inching", "weekly" };
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+    uint8_t id = 0;
+
+    if (argc < 2) {
+        printf("Usage: sched <list|countdown|inching|weekly|remove|time>\n");
+        return 1;
+    }
+
+    if (argc == 2 && !strcmp(argv[1], "list")) {
+        static relay_sched_info_t info[RELAY_SCHED_MAX_ENTRIES];
+        size_t count = relay_scheduler_list(info, RELAY_SCHED_MAX_ENTRIES);
+        for (size_t i = 0; i < count; i++) {
+            const relay_sched_entry_t *entry = &info[i].entry;
+            printf("%3d %-9s relay %d %-3s", entry->id, type_names[entry->type], entry->relay_num,
+                   entry->state == RELAY_ON ? "on" : "off");
+            if (entry->type == RELAY_SCHED_WEEKLY) {
+                printf(" days 0x%02x at %02u:%02u", entry->days, entry->minute / 60, entry->minute % 60);
+            } else {
+                printf(" %lu ms", (unsigned long)entry->duration_ms);
+            }
+            if (info[i].armed) {
+                printf(", due in %lu ms\n", (unsigned long)info[i].remaining_ms);
+            } else {
+                printf(", idle\n");
+            }
+        }
+
+        relay_scheduler_stats_t stats;
+        relay_scheduler_get_stats(&stats);
+        printf("Entries: %d of %d, fired %lu (%lu dropped), max late %lu us\n", stats.entries,
+               RELAY_SCHED_MAX_ENTRIES, (unsigned long)stats.fired, (unsigned long)stats.submit_errors,
+               (unsigned long)stats.max_late_us);
+        printf("NVS: %lu writes, %lu errors\n", (unsigned long)stats.nvs_writes, (unsigned long)stats.nvs_errors);
+        return 0;
+    }
+
+    if (!strcmp(argv[1], "time")) {
+        if (argc == 3) {
+            err = relay_scheduler_set_time((time_t)strtoll(argv[2], NULL, 10));
+            if (err != ESP_OK) {
+                printf("Invalid time: %s\n", argv[2]);
+                return 1;
+            }
+        }
+
+        if (!relay_scheduler_time_valid()) {
+            printf("Clock not set\n");
+        } else {
+            time_t now = time(NULL);
+            struct tm tm;
+            char buf[32];
+            gmtime_r(&now, &tm);
+            strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+            printf("Local time: %s (day %d)\n", buf, tm.tm_wday);
+        }
+
+        zb_time_sync_stats_t sync;
+        zb_time_sync_get_stats(&sync);
+        printf("Coordinator sync: %lu requests, %lu syncs, last correction %ld s\n",
+               (unsigned long)sync.requests, (unsigned long)sync.syncs, (long)sync.last_correction_s);
+        return 0;
+    }
+
+    if (argc == 3 && !strcmp(argv[1], "remove")) {
+        err = relay_scheduler_remove((uint8_t)atoi(argv[2]));
+        if (err != ESP_OK) {
+            printf("Failed to remove entry: %s\n", esp_err_to_name(err));
+            return 1;
+        }
+        return 0;
+    }
+
+    uint8_t relay_num = (argc >= 3) ? (uint8_t)atoi(argv[2]) : 0;
+    relay_state_t state;
+
+    if (argc == 5 && !strcmp(argv[1], "countdown")) {
+        if (!app_console_parse_sched_state(argv[4], &state)) {
+            return 1;
+        }
+        err = relay_scheduler_add_countdown(relay_num, state, (uint32_t)strtoul(argv[3], NULL, 10), &id);
+    } else if (argc == 4 && !strcmp(argv[1], "inching")) {
+        err = relay_scheduler_set_inching(relay_num, (uint32_t)strtoul(argv[3], NULL, 10));
+    } else if (argc == 6 && !strcmp(argv[1], "weekly")) {
+        uint8_t days = 0;
+        if (!strcmp(argv[3], "all")) {
+            days = RELAY_SCHED_DAYS_ALL;
+        } else {
+            for (const char *p = argv[3]; *p != '\0'; p++) {
+                if (*p < '0' || *p > '6') {
+                    printf("Invalid days: %s\n", argv[3]);
+                    return 1;
+                }
+                days |= 1 << (*p - '0');
+            }
+        }
+
+        unsigned hour, minute;
+        if (sscanf(argv[4], "%u:%u", &hour, &minute) != 2 || hour > 23 || minute > 59) {
+            printf("Invalid time of day: %s\n", argv[4]);
+            return 1;
+        }
+        if (!app_console_parse_sched_state(argv[5], &state)) {
+            return 1;
+        }
+        err = relay_scheduler_add_weekly(relay_num, state, days, (uint16_t)(hour * 60 + minute), &id);
+    } else {
+        printf("Usage: sched <list|countdown|inching|weekly|remove|time>\n");
+        return 1;
+    }
+
+    if (err != ESP_OK) {
+        printf("Failed to update schedule: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    if (id != 0) {
+        printf("Added entry %d\n", id);
+    }
+    return 0;
+}
+
+/**
+ * @brief Команда "gesture": действия жестов кнопки
+ *
+ * gesture list
+ */
+static int app_console_cmd_gesture(int argc, char **argv)
+{
+    static const char *const gesture_names[BUTTON_GESTURE_MAX] = {
+        "single", "double", "triple", "hold", "release",
+    };
+    static const char *const action_names[GESTURE_ACTION_MAX] = {
+        "none", "toggle", "on", "off", "bind toggle", "bind on", "bind off",
+    };
+
+    if (argc != 2 || strcmp(argv[1], "list")) {
+        printf("Usage: gesture list\n");
+        return 1;
+    }
+
+    gesture_map_entry_t map[BUTTON_GESTURE_MAX];
+    button_gesture_config_t config;
+    gesture_map_stats_t stats;
+    gesture_map_get(map, &config);
+    gesture_map_get_stats(&stats);
+
+    for (int i = 0; i < BUTTON_GESTURE_MAX; i++) {
+        printf("%-8s %-12s", gesture_names[i], action_names[map[i].action]);
+        if (map[i].action != GESTURE_ACTION_NONE) {
+            printf(" EP%d", map[i].endpoint);
+        }
+        printf(" (%lu)\n", (unsigned long)stats.gestures[i]);
+    }
+    printf("Clicks up to %d, window %lu ms, hold %s (%lu ms), unmapped %lu\n", config.max_clicks,
+           (unsigned long)config.multi_click_ms, config.hold_enabled ? "on" : "off",
+           (unsigned long)config.hold_ms, (unsigned long)stats.unmapped);
+    return 0;
+}
+
+/**
+ * @brief Команда "groups": таблица групп
+ *
+ * groups list
+ */
+static int app_console_cmd_groups(int argc, char **argv)
+{
+    if (argc != 2 || strcmp(argv[1], "list")) {
+        printf("Usage: groups list\n");
+        return 1;
+    }
+
+    static groups_entry_t entries[GROUPS_TABLE_SIZE];
+    size_t count = groups_server_get_table(entries);
+    for (size_t i = 0; i < count; i++) {
+        printf("Group 0x%04x: endpoints 0x%02x\n", entries[i].group_id, entries[i].member_mask);
+    }
+
+    groups_server_stats_t stats;
+    groups_server_get_stats(&stats);
+    printf("Groups: %d of %d, added %lu, removed %lu, full %lu, APS errors %lu\n", (int)count,
+           GROUPS_TABLE_SIZE, (unsigned long)stats.added, (unsigned long)stats.removed,
+           (unsigned long)stats.table_full, (unsigned long)stats.aps_errors);
+    printf("Groupcast On/Off: %lu (%lu merged)\n", (unsigned long)stats.groupcast,
+           (unsigned long)stats.groupcast_merged);
+    printf("NVS: %lu writes, %lu errors\n", (unsigned long)stats.nvs_writes, (unsigned long)stats.nvs_errors);
+    return 0;
+}
+
+/**
+ * @brief Команда "scenes": таблица сцен
+ *
+ * scenes list
+ */
+static int app_console_cmd_scenes(int argc, char **argv)
+{
+    if (argc != 2 || strcmp(argv[1], "list")) {
+        printf("Usage: scenes list\n");
+        return 1;
+    }
+
+    static scenes_entry_t entries[SCENES_TABLE_SIZE];
+    size_t count = scenes_server_get_table(entries);
+    for (size_t i = 0; i < count; i++) {
+        printf("Group 0x%04x scene %3d: endpoints 0x%02x, on/off 0x%02x, state 0x%02x, transition %u s\n",
+               entries[i].group_id, entries[i].scene_id, entries[i].member_mask, entries[i].on_off_mask,
+               entries[i].state_mask, entries[i].transition_time);
+    }
+
+    scenes_server_stats_t stats;
+    scenes_server_get_stats(&stats);
+    printf("Scenes: %d of %d, stored %lu, removed %lu, full %lu\n", (int)count, SCENES_TABLE_SIZE,
+           (unsigned long)stats.stored, (unsigned long)stats.removed, (unsigned long)stats.table_full);
+    printf("Recall: %lu (%lu merged), not found %lu\n", (unsigned long)stats.recalled,
+           (unsigned long)stats.recall_merged, (unsigned long)stats.not_found);
+    printf("NVS: %lu writes, %lu errors\n", (unsigned long)stats.nvs_writes, (unsigned long)stats.nvs_errors);
+    return 0;
+}
+
+/**
+ * @brief Команда "dlog": отложенный журнал горячих путей
+ *
+ * dlog stats
+ * dlog show - последние записи в виде текста
+ * dlog dump - последние записи в сыром виде для tools/dlog_decode.py
+ */
+static int app_console_cmd_dlog(int argc, char **argv)
+{
+    if (argc != 2) {
+        printf("Usage: dlog <stats|show|dump>\n");
+        return 1;
+    }
+
+    if (!strcmp(argv[1], "stats")) {
+        deferred_log_stats_t stats;
+        deferred_log_get_stats(&stats);
+        printf("Captured:  %lu\n", (unsigned long)stats.captured);
+        printf("Rendered:  %lu\n", (unsigned long)stats.rendered);
+        printf("Dropped:   %lu\n", (unsigned long)stats.dropped);
+        printf("Truncated: %lu\n", (unsigned long)stats.truncated);
+        printf("Depth:     %lu (max %lu of %d)\n", (unsigned long)stats.depth,
+               (unsigned long)stats.depth_max, DEFERRED_LOG_RING_SIZE);
+        return 0;
+    }
+
+    bool dump = !strcmp(argv[1], "dump");
+    if (!dump && strcmp(argv[1], "show")) {
+        printf("Usage: dlog <stats|show|dump>\n");
+        return 1;
+    }
+
+    static deferred_log_record_t records[DEFERRED_LOG_RING_SIZE];
+    static char line[DEFERRED_LOG_LINE_MAX];
+    size_t count = deferred_log_get_recent(records);
+
+    for (size_t i = 0; i < count; i++) {
+        const deferred_log_record_t *record = &records[i];
+        if (dump) {
+            /* DLOG <мс> <уровень> <тег> <формат> <аргументы...> */
+            printf("DLOG %lu %u %08lx %08lx", (unsigned long)record->timestamp_ms, record->level,
+                   (unsigned long)(uintptr_t)record->tag, (unsigned long)(uintptr_t)record->format);
+            for (int a = 0; a < record->nargs; a++) {
+                printf(" %08lx", (unsigned long)record->args[a]);
+            }
+            printf("\n");
+        } else {
+            deferred_log_format(record, line, sizeof(line));
+            printf("(%lu) %s: %s\n", (unsigned long)record->timestamp_ms, record->tag, line);
+        }
+    }
+    return 0;
+}
+#endif /* CONFIG_ZB_CONSOLE_ENABLED */
+
+void app_console_set_send_status_handler(esp_zb_zcl_command_send_status_callback_t cb)
+{
+#if CONFIG_ZB_CONSOLE_ENABLED
+    esp_zb_console_set_send_status_handler(cb);
+#else
+    esp_zb_zcl_command_send_status_handler_register(cb);
+#endif
+}
+
+esp_err_t app_console_init(void)
+{
+#if CONFIG_ZB_CONSOLE_ENABLED
+    ESP_RETURN_ON_ERROR(esp_zb_console_init(), TAG, "Failed to init Zigbee console");
+
+    /* Консоль хранит указатель на строку справки */
+    static char relay_help[64];
+    snprintf(relay_help, sizeof(relay_help), "Relay control: relay <1-%d> <on|off|toggle> | relay stats", RELAY_COUNT);
+    const esp_console_cmd_t relay_cmd = {
+        .command = "relay",
+        .help = relay_help,
+        .func = app_console_cmd_relay,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&relay_cmd), TAG, "Failed to register relay command");
+
+    const esp_console_cmd_t report_cmd = {
+        .command = "report",
+        .help = "Attribute reporting: report <stats|config>",
+        .func = app_console_cmd_report,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&report_cmd), TAG, "Failed to register report command");
+
+    const esp_console_cmd_t join_cmd = {
+        .command = "join",
+        .help = "Network join statistics: join stats",
+        .func = app_console_cmd_join,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&join_cmd), TAG, "Failed to register join command");
+
+    const esp_console_cmd_t boot_cmd = {
+        .command = "boot",
+        .help = "Boot timing: boot profile",
+        .func = app_console_cmd_boot,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&boot_cmd), TAG, "Failed to register boot command");
+
+    const esp_console_cmd_t lock_cmd = {
+        .command = "lock",
+        .help = "Zigbee lock contention: lock <stats|reset>",
+        .func = app_console_cmd_lock,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&lock_cmd), TAG, "Failed to register lock command");
+
+    const esp_console_cmd_t latency_cmd = {
+        .command = "latency",
+        .help = "Relay command latency: latency <stats|history|reset>",
+        .func = app_console_cmd_latency,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&latency_cmd), TAG, "Failed to register latency command");
+
+    const esp_console_cmd_t onoff_cmd = {
+        .command = "onoff",
+        .help = "On/Off cluster timers, global scene and bound devices: onoff status",
+        .func = app_console_cmd_onoff,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&onoff_cmd), TAG, "Failed to register onoff command");
+
+    const esp_console_cmd_t sched_cmd = {
+        .command = "sched",
+        .help = "Local relay schedule: sched <list|countdown|inching|weekly|remove|time>",
+        .func = app_console_cmd_sched,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&sched_cmd), TAG, "Failed to register sched command");
+
+    const esp_console_cmd_t gesture_cmd = {
+        .command = "gesture",
+        .help = "Button gesture actions: gesture list",
+        .func = app_console_cmd_gesture,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&gesture_cmd), TAG, "Failed to register gesture command");
+
+    const esp_console_cmd_t groups_cmd = {
+        .command = "groups",
+        .help = "Group table: groups list",
+        .func = app_console_cmd_groups,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&groups_cmd), TAG, "Failed to register groups command");
+
+    const esp_console_cmd_t scenes_cmd = {
+        .command = "scenes",
+        .help = "Scene table: scenes list",
+        .func = app_console_cmd_scenes,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&scenes_cmd), TAG, "Failed to register scenes command");
+
+    const esp_console_cmd_t dlog_cmd = {
+        .command = "dlog",
+        .help = "Deferred hot-path log: dlog <stats|show|dump>",
+        .func = app_console_cmd_dlog,
+    };
+    ESP_RETURN_ON_ERROR(esp_console_cmd_register(&dlog_cmd), TAG, "Failed to register dlog command");
+
+    ESP_RETURN_ON_ERROR(esp_zb_console_start(), TAG, "Failed to start console");
+    ESP_LOGI(TAG, "Application console started");
+#endif
+    return ESP_OK;
+}
@@ -0,0 +1,38 @@
+/*
+ * Application Console
+ *
+ * Команды консоли приложения RoboSR2CH10A.
+ *
+ * Консоль поднимается поверх ESP Zigbee Console (components/esp-zigbee-console):
+ * в одном REPL доступны как команды стека Zigbee, так и команды приложения.
+ */
+
+#ifndef APP_CONSOLE_H
+#define APP_CONSOLE_H
+
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+
+/**
+ * @brief Инициализация и запуск консоли приложения
+ *
+ * Должна вызываться после esp_zb_init() и до регистрации обработчика
+ * действий Zigbee приложения: ESP Zigbee Console регистрирует собственный
+ * обработчик, который затем заменяется обработчиком приложения.
+ *
+ * @return ESP_OK при успехе (или если консоль отключена в конфигурации)
+ */
+esp_err_t app_console_init(void);
+
+/**
+ * @brief Регистрация обработчика подтверждения отправки ZCL команд
+ *
+ * У стека один слот для этого обработчика. Если консоль включена,
+ * обработчик передается ей, чтобы команды ping/iperf восстанавливали
+ * его после себя, а не очищали слот.
+ *
+ * @param cb Обработчик
+ */
+void app_console_set_send_status_handler(esp_zb_zcl_command_send_status_callback_t cb);
+
+#endif // APP_CONSOLE_H
@@ -0,0 +1,61 @@
+/*
+ * Attribute Journal
+ *
+ * Журнал недоставленных изменений атрибутов (см. attr_journal.h).
+ *
+ * Все изменения журнала выполняет задача отчетов (attr_reporter),
+ * поэтому синхронизация не требуется.
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "attr_journal.h"
+
+static const char *TAG = "ATTR_JOURNAL";
+
+#define ATTR_JOURNAL_ALL    ((1u << ATTR_JOURNAL_MAX_ENTRIES) - 1)
+
+static uint32_t s_pending = 0;
+static uint32_t s_recorded = 0;
+static uint32_t s_overwritten = 0;
+static uint32_t s_flushed = 0;
+
+void attr_journal_record(uint32_t mask)
+{
+    mask &= ATTR_JOURNAL_ALL;
+    if (mask == 0) {
+        return;
+    }
+
+    s_recorded += __builtin_popcount(mask);
+    s_overwritten += __builtin_popcount(s_pending & mask);
+    s_pending |= mask;
+    ESP_LOGD(TAG, "Journaled rows 0x%02lx", (unsigned long)mask);
+}
+
+void attr_journal_clear(uint32_t mask)
+{
+    uint32_t cleared = s_pending & mask;
+    if (cleared == 0) {
+        return;
+    }
+
+    s_pending &= ~cleared;
+    s_flushed += __builtin_popcount(cleared);
+    ESP_LOGI(TAG, "Delivered journaled changes (mask 0x%02lx)", (unsigned long)cleared);
+}
+
+uint32_t attr_journal_pending(void)
+{
+    return s_pending;
+}
+
+void attr_journal_get_stats(attr_journal_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    stats->recorded = s_recorded;
+    stats->overwritten = s_overwritten;
+    stats->flushed = s_flushed;
+    stats->pending_mask = s_pending;
+}
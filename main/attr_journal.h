@@ -0,0 +1,62 @@
+/*
+ * Attribute Journal
+ *
+ * Журнал изменений атрибутов, не доставленных в сеть.
+ *
+ * Журнал - маска строк таблицы отчетов в RAM: значение не хранится,
+ * отчет всегда отправляет текущее значение атрибута, поэтому журнал не
+ * растет, сколько бы раз реле ни переключали без связи. Строки попадают
+ * в журнал, когда устройство не в сети, запрос отчета завершился ошибкой
+ * или стек подтвердил отправку с ошибкой (родитель недоступен), и
+ * отправляются одной пачкой после следующей успешной отправки или
+ * подключения (steering или rejoin).
+ *
+ * Журнал не сохраняется в flash: после перезагрузки состояние реле
+ * восстанавливает relay_state_store, а при подключении к сети задача
+ * отчетов в любом случае отправляет все атрибуты
+ * (attr_reporter_mark_all), так что запись каждого изменения вне сети в
+ * NVS только изнашивала бы flash.
+ */
+
+#ifndef ATTR_JOURNAL_H
+#define ATTR_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Максимальное количество строк журнала */
+#define ATTR_JOURNAL_MAX_ENTRIES    8
+
+/* Статистика журнала */
+typedef struct {
+    uint32_t recorded;               // Записано изменений
+    uint32_t overwritten;            // Изменений строк, уже ожидавших отправки
+    uint32_t flushed;                // Строк, доставленных после восстановления связи
+    uint32_t pending_mask;           // Строки, ожидающие отправки
+} attr_journal_stats_t;
+
+/**
+ * @brief Запись недоставленных изменений
+ * @param mask Маска строк таблицы отчетов
+ */
+void attr_journal_record(uint32_t mask);
+
+/**
+ * @brief Удаление доставленных строк
+ * @param mask Маска строк, отчеты по которым отправлены
+ */
+void attr_journal_clear(uint32_t mask);
+
+/**
+ * @brief Маска строк, ожидающих отправки
+ * @return Битовая маска (бит = строка таблицы отчетов)
+ */
+uint32_t attr_journal_pending(void);
+
+/**
+ * @brief Получение статистики журнала
+ * @param stats Буфер для статистики
+ */
+void attr_journal_get_stats(attr_journal_stats_t *stats);
+
+#endif // ATTR_JOURNAL_H
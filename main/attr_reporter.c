@@ -0,0 +1,756 @@
+/*
+ * Attribute Reporter
+ *
+ * Планировщик отчетов об атрибутах Zigbee (см. attr_reporter.h).
+ *
+ * Грязные атрибуты хранятся в атомарной битовой маске (бит = строка
+ * таблицы отчетов), поэтому пометка из любой задачи - это один
+ * atomic_fetch_or и уведомление задачи отчетов.
+ *
+ * Конфигурацию отчетов (Configure Reporting) принимает и проверяет
+ * стек ZBOSS, задача отчетов периодически зеркалирует ее в свою
+ * таблицу через esp_zb_zcl_find_reporting_info(). Атрибуты с записью
+ * конфигурации в стеке стек отчитывает сам - задача только записывает
+ * их значение. Для остальных атрибутов задача решает, когда отправлять
+ * отчет, по интервалам по умолчанию:
+ * - изменение значения отправляется не раньше min_interval после
+ *   предыдущего отчета (изменения внутри интервала схлопываются);
+ * - если max_interval не равен 0, отчет повторяется не реже
+ *   max_interval даже без изменений;
+ * - max_interval = 0xFFFF отключает отчеты атрибута; отключение берется
+ *   из самой команды Configure Reporting (s_disabled_mask), так как стек
+ *   может не хранить для него запись конфигурации.
+ *
+ * Изменения, которые не удалось отправить (устройство вне сети, ошибка
+ * запроса или отрицательное подтверждение отправки), отмечаются в
+ * attr_journal и отправляются одной пачкой после подключения или
+ * следующей успешной отправки.
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_zigbee_core.h"
+#include "zboss_api.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "attr_reporter.h"
+#include "attr_journal.h"
+#include "zb_lock_profiler.h"
+#include "latency_trace.h"
+
+static const char *TAG = "ATTR_REPORT";
+
+ZB_LOCK_SITE_DEFINE(s_lock_site, "attr_reporter_flush");
+
+/* max_interval = 0xFFFF: отчеты атрибута отключены (ZCL) */
+#define ATTR_REPORT_MAX_INTERVAL_DISABLED   0xFFFF
+
+/* Строка таблицы отчетов */
+typedef struct {
+    uint8_t endpoint;                // Endpoint атрибута
+    uint16_t cluster_id;             // Кластер
+    uint16_t attr_id;                // Атрибут
+    uint8_t relay_num;               // Реле, состояние которого отражает атрибут (0 - нет)
+} attr_report_entry_t;
+
+/* Состояние отчетов атрибута (пишет только задача отчетов) */
+typedef struct {
+    attr_report_config_t config;     // Действующая конфигурация
+    TickType_t last_report_tick;     // Время последнего отчета
+    uint8_t reported_value;          // Последнее отправленное значение
+    bool reported;                   // Отчет уже отправлялся
+} attr_report_state_t;
+
+/* Отчет, ожидающий подтверждения отправки (доступ под Zigbee lock) */
+typedef struct {
+    bool pending;                    // Подтверждение еще не получено
+    uint8_t tsn;                     // TSN отчета
+} attr_report_inflight_t;
+
+/* Атрибут OnOff канала реле */
+#define ATTR_REPORT_RELAY(num, gpio, ep, level, clusters) \
+    { (ep), ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, (num) },
+
+/* Атрибуты, о которых устройство отправляет отчеты */
+static const attr_report_entry_t s_report_table[] = {
+    RELAY_CHANNEL_TABLE(ATTR_REPORT_RELAY)
+};
+
+#define ATTR_REPORT_COUNT   (sizeof(s_report_table) / sizeof(s_report_table[0]))
+#define ATTR_REPORT_ALL     ((1u << ATTR_REPORT_COUNT) - 1)
+
+_Static_assert(ATTR_REPORT_COUNT < 32, "attribute report table does not fit the dirty mask");
+_Static_assert(ATTR_REPORT_COUNT <= ATTR_JOURNAL_MAX_ENTRIES, "attribute report table does not fit the journal");
+
+static atomic_uint s_dirty_mask;
+static atomic_uint s_force_mask;
+static atomic_bool s_connected;
+static atomic_uint s_disabled_mask;     // Отключены координатором (NVS)
+static atomic_bool s_config_stale;      // Получена Configure Reporting - перечитать конфигурацию
+static TaskHandle_t s_reporter_task = NULL;
+
+/* Состояние задачи отчетов */
+static attr_report_state_t s_report_state[ATTR_REPORT_COUNT];
+static attr_report_inflight_t s_inflight[ATTR_REPORT_COUNT];
+static uint32_t s_pending_mask = 0;  // Изменения, ожидающие отчета (min_interval)
+static uint32_t s_forced_mask = 0;   // Отчеты без проверки изменения значения
+static TickType_t s_last_config_tick = 0;
+static bool s_config_loaded = false;
+
+/* Статистика */
+static atomic_uint s_marks;
+static atomic_uint s_coalesced;
+static uint32_t s_flushes = 0;
+static uint32_t s_frames = 0;
+static uint32_t s_errors = 0;
+static uint32_t s_deferred = 0;
+static uint32_t s_heartbeats = 0;
+static uint32_t s_rate_limited = 0;
+static uint32_t s_suppressed = 0;
+static uint32_t s_delegated = 0;
+static atomic_uint s_confirm_failed;
+static uint32_t s_lock_wait_max_us = 0;
+
+/**
+ * @brief Установка битов маски и пробуждение задачи отчетов
+ */
+static void attr_reporter_mark_mask(uint32_t mask)
+{
+    uint32_t previous = atomic_fetch_or(&s_dirty_mask, mask);
+
+    atomic_fetch_add(&s_marks, 1);
+    if ((previous & mask) == mask) {
+        atomic_fetch_add(&s_coalesced, 1);
+    }
+
+    if (s_reporter_task != NULL) {
+        xTaskNotifyGive(s_reporter_task);
+    }
+}
+
+/**
+ * @brief Оставшееся время до истечения интервала (в тиках)
+ */
+static TickType_t attr_reporter_remaining(TickType_t now, TickType_t since, uint16_t interval_s)
+{
+    TickType_t interval = pdMS_TO_TICKS((uint32_t)interval_s * 1000);
+    TickType_t elapsed = now - since;
+
+    return (elapsed >= interval) ? 0 : interval - elapsed;
+}
+
+/**
+ * @brief Нужен ли периодический отчет по max_interval
+ */
+static bool attr_reporter_heartbeat_enabled(const attr_report_config_t *config)
+{
+    return config->max_interval_s != 0 && config->max_interval_s != ATTR_REPORT_MAX_INTERVAL_DISABLED;
+}
+
+/**
+ * @brief Обновление конфигурации из хранилища стека (вызывается под Zigbee lock)
+ */
+static void attr_reporter_load_config(void)
+{
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        const attr_report_entry_t *entry = &s_report_table[i];
+        attr_report_config_t *config = &s_report_state[i].config;
+        esp_zb_zcl_attr_location_info_t location = {
+            .endpoint_id = entry->endpoint,
+            .cluster_id = entry->cluster_id,
+            .cluster_role = ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+            .manuf_code = ESP_ZB_ZCL_ATTR_NON_MANUFACTURER_SPECIFIC,
+            .attr_id = entry->attr_id,
+        };
+
+        esp_zb_zcl_reporting_info_t *info = esp_zb_zcl_find_reporting_info(location);
+        attr_report_config_t updated = {
+            .min_interval_s = ATTR_REPORT_DEFAULT_MIN_INTERVAL_S,
+            .max_interval_s = ATTR_REPORT_DEFAULT_MAX_INTERVAL_S,
+            .configured = false,
+        };
+        if (info != NULL) {
+            updated.min_interval_s = info->u.send_info.min_interval;
+            updated.max_interval_s = info->u.send_info.max_interval;
+            updated.configured = true;
+        }
+        /* Отключение действует и без записи в стеке */
+        if (atomic_load(&s_disabled_mask) & (1u << i)) {
+            updated.max_interval_s = ATTR_REPORT_MAX_INTERVAL_DISABLED;
+            updated.disabled = true;
+        }
+
+        if (updated.min_interval_s != config->min_interval_s ||
+            updated.max_interval_s != config->max_interval_s ||
+            updated.configured != config->configured || updated.disabled != config->disabled) {
+            ESP_LOGI(TAG, "EP%d cluster 0x%04x attr 0x%04x: min %us, max %us (%s)",
+                     entry->endpoint, entry->cluster_id, entry->attr_id,
+                     updated.min_interval_s, updated.max_interval_s,
+                     updated.disabled ? "disabled" : (updated.configured ? "configured" : "default"));
+            *config = updated;
+        }
+    }
+}
+
+/**
+ * @brief Текущее значение атрибута реле
+ */
+static uint8_t attr_reporter_value(const attr_report_entry_t *entry, const device_status_t *status)
+{
+    relay_state_t state = device_relay_state(status, entry->relay_num);
+    return (state == RELAY_ON) ? 0x01 : 0x00;
+}
+
+/**
+ * @brief Запись локального значения в атрибут ZCL (вызывается под Zigbee lock)
+ */
+static void attr_reporter_sync_value(const attr_report_entry_t *entry, uint8_t value)
+{
+    esp_zb_zcl_status_t zcl_status = esp_zb_zcl_set_attribute_val(entry->endpoint, entry->cluster_id,
+                                                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                                                  entry->attr_id, &value, false);
+    if (zcl_status != ESP_ZB_ZCL_STATUS_SUCCESS) {
+        ESP_LOGE(TAG, "Failed to set attribute 0x%04x for endpoint %d: %d",
+                 entry->attr_id, entry->endpoint, zcl_status);
+    }
+}
+
+/**
+ * @brief Отправка отчета об одном атрибуте (вызывается под Zigbee lock)
+ * @param entry Атрибут
+ * @param tsn TSN отчета
+ */
+static esp_err_t attr_reporter_send(const attr_report_entry_t *entry, uint8_t *tsn)
+{
+    esp_zb_zcl_report_attr_cmd_t report_cmd = {0};
+    report_cmd.zcl_basic_cmd.dst_addr_u.addr_short = 0x0000; // Координатор
+    report_cmd.zcl_basic_cmd.src_endpoint = entry->endpoint;
+    report_cmd.zcl_basic_cmd.dst_endpoint = 0x01;
+    report_cmd.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+    report_cmd.direction = ESP_ZB_ZCL_CMD_DIRECTION_TO_CLI;
+    report_cmd.clusterID = entry->cluster_id;
+    report_cmd.attributeID = entry->attr_id;
+
+    /* Запрос не возвращает TSN: кадр получает следующий номер из контекста
+     * ZCL, а под Zigbee lock другие отправители его не занимают */
+    *tsn = ZCL_CTX().seq_number;
+    return esp_zb_zcl_report_attr_cmd_req(&report_cmd);
+}
+
+/**
+ * @brief Маска атрибутов, по которым отчет положен сейчас
+ * @param now Текущее время
+ * @param heartbeat_mask Маска атрибутов, у которых истек max_interval
+ */
+static uint32_t attr_reporter_due_mask(TickType_t now, uint32_t *heartbeat_mask)
+{
+    uint32_t due = 0;
+
+    *heartbeat_mask = 0;
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        const attr_report_state_t *state = &s_report_state[i];
+        uint32_t bit = 1u << i;
+
+        if (state->config.max_interval_s == ATTR_REPORT_MAX_INTERVAL_DISABLED) {
+            continue;
+        }
+        if (s_forced_mask & bit) {
+            due |= s_pending_mask & bit;
+            continue;
+        }
+        if (state->config.configured) {
+            /* Отчеты об изменениях и периодические отправляет стек */
+            continue;
+        }
+        if (!state->reported) {
+            due |= s_pending_mask & bit;
+            continue;
+        }
+        if ((s_pending_mask & bit) &&
+            attr_reporter_remaining(now, state->last_report_tick, state->config.min_interval_s) == 0) {
+            due |= bit;
+        }
+        if (attr_reporter_heartbeat_enabled(&state->config) &&
+            attr_reporter_remaining(now, state->last_report_tick, state->config.max_interval_s) == 0) {
+            due |= bit;
+            *heartbeat_mask |= bit;
+        }
+    }
+    return due;
+}
+
+/**
+ * @brief Время до ближайшего положенного отчета или обновления конфигурации
+ */
+static TickType_t attr_reporter_next_wait(TickType_t now)
+{
+    if (!atomic_load(&s_connected)) {
+        return portMAX_DELAY;
+    }
+
+    TickType_t wait = attr_reporter_remaining(now, s_last_config_tick, ATTR_REPORT_CONFIG_POLL_S);
+
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        const attr_report_state_t *state = &s_report_state[i];
+        uint32_t bit = 1u << i;
+        TickType_t remaining;
+
+        if (state->config.max_interval_s == ATTR_REPORT_MAX_INTERVAL_DISABLED || state->config.configured) {
+            continue;
+        }
+        if (s_pending_mask & bit) {
+            remaining = attr_reporter_remaining(now, state->last_report_tick, state->config.min_interval_s);
+            if (remaining < wait) {
+                wait = remaining;
+            }
+        }
+        if (state->reported && attr_reporter_heartbeat_enabled(&state->config)) {
+            remaining = attr_reporter_remaining(now, state->last_report_tick, state->config.max_interval_s);
+            if (remaining < wait) {
+                wait = remaining;
+            }
+        }
+    }
+    return wait;
+}
+
+/**
+ * @brief Обработка изменений и отправка положенных отчетов
+ *
+ * Zigbee lock берется не больше одного раза: за один захват
+ * обновляются значения атрибутов, конфигурация и отправляются отчеты
+ * по всем endpoint.
+ */
+static void attr_reporter_process(void)
+{
+    uint32_t dirty = atomic_exchange(&s_dirty_mask, 0);
+    s_forced_mask |= atomic_exchange(&s_force_mask, 0);
+    s_pending_mask |= dirty | s_forced_mask;
+
+    /* Вне сети отчеты не отправляются - изменения ждут подключения в журнале */
+    if (!atomic_load(&s_connected)) {
+        if (dirty != 0) {
+            attr_journal_record(dirty);
+            s_deferred++;
+        }
+        return;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    bool config_due = !s_config_loaded || atomic_exchange(&s_config_stale, false) ||
+                      attr_reporter_remaining(now, s_last_config_tick, ATTR_REPORT_CONFIG_POLL_S) == 0;
+    uint32_t heartbeat_mask;
+    uint32_t due = attr_reporter_due_mask(now, &heartbeat_mask);
+
+    if (dirty == 0 && due == 0 && !config_due) {
+        return;
+    }
+
+    device_status_t status;
+    device_get_status(&status);
+
+    int64_t wait_start_us = esp_timer_get_time();
+    zb_lock_acquire(&s_lock_site, portMAX_DELAY);
+    uint32_t lock_wait_us = (uint32_t)(esp_timer_get_time() - wait_start_us);
+
+    if (config_due) {
+        attr_reporter_load_config();
+        s_last_config_tick = now;
+        s_config_loaded = true;
+        due = attr_reporter_due_mask(now, &heartbeat_mask);
+    }
+
+    uint32_t frames = 0;
+    uint32_t sent = 0;
+    uint32_t failed = 0;
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        const attr_report_entry_t *entry = &s_report_table[i];
+        attr_report_state_t *state = &s_report_state[i];
+        uint32_t bit = 1u << i;
+        uint8_t value = attr_reporter_value(entry, &status);
+
+        /* Атрибут реле обновляется сразу, даже если отчет придержан min_interval */
+        if (entry->relay_num != 0 && (dirty & bit)) {
+            attr_reporter_sync_value(entry, value);
+        }
+
+        if (state->config.max_interval_s == ATTR_REPORT_MAX_INTERVAL_DISABLED) {
+            s_pending_mask &= ~bit;
+            s_forced_mask &= ~bit;
+            continue;
+        }
+
+        /* Отчет об изменении отправит стек по записи значения выше */
+        if (state->config.configured && !(s_forced_mask & bit)) {
+            if (dirty & bit) {
+                s_delegated++;
+                if (entry->relay_num != 0) {
+                    latency_trace_report_delegated(entry->relay_num);
+                }
+            }
+            s_pending_mask &= ~bit;
+            continue;
+        }
+
+        if (!(due & bit)) {
+            if ((dirty & bit) && (s_pending_mask & bit)) {
+                s_rate_limited++;
+            }
+            continue;
+        }
+
+        bool changed = !state->reported || value != state->reported_value;
+        if (!changed && !(s_forced_mask & bit) && !(heartbeat_mask & bit)) {
+            /* Значение вернулось к отправленному за время min_interval */
+            s_suppressed++;
+            s_pending_mask &= ~bit;
+            continue;
+        }
+
+        uint8_t tsn;
+        esp_err_t err = attr_reporter_send(entry, &tsn);
+        if (entry->relay_num != 0) {
+            latency_trace_report(entry->relay_num, err == ESP_OK, tsn);
+        }
+        if (err == ESP_OK) {
+            s_inflight[i].pending = true;
+            s_inflight[i].tsn = tsn;
+            frames++;
+            sent |= bit;
+            if ((heartbeat_mask & bit) && !changed) {
+                s_heartbeats++;
+            }
+            /* Координатор знает только доставленное в стек значение */
+            state->reported_value = value;
+            state->reported = true;
+        } else {
+            failed |= bit;
+            s_errors++;
+            ESP_LOGE(TAG, "Failed to send report for endpoint %d: %s",
+                     entry->endpoint, esp_err_to_name(err));
+        }
+        /* Попытка отсчитывает интервалы и при ошибке: повтор - из журнала */
+        state->last_report_tick = now;
+        s_pending_mask &= ~bit;
+        s_forced_mask &= ~bit;
+    }
+
+    zb_lock_release(&s_lock_site);
+
+    if (failed != 0) {
+        attr_journal_record(failed);
+    }
+    if (sent != 0) {
+        attr_journal_clear(sent);
+
+        /* Связь есть - повторяем строки журнала, не попавшие в эту пачку */
+        uint32_t retry = attr_journal_pending() & ~failed;
+        if (retry != 0) {
+            atomic_fetch_or(&s_force_mask, retry);
+            attr_reporter_mark_mask(retry);
+        }
+    }
+
+    s_flushes++;
+    s_frames += frames;
+    if (lock_wait_us > s_lock_wait_max_us) {
+        s_lock_wait_max_us = lock_wait_us;
+    }
+    ESP_LOGD(TAG, "Flushed %lu reports (due 0x%02lx, pending 0x%02lx), lock wait %lu us",
+             (unsigned long)frames, (unsigned long)due, (unsigned long)s_pending_mask,
+             (unsigned long)lock_wait_us);
+}
+
+/**
+ * @brief Задача отчетов
+ *
+ * Спит до пометки атрибута или до ближайшего срока (min_interval
+ * придержанного изменения, max_interval, обновление конфигурации).
+ * После пробуждения по пометке выжидает окно накопления, чтобы
+ * изменения нескольких реле ушли одной пачкой.
+ */
+static void attr_reporter_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Starting attribute reporter task...");
+
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        s_report_state[i].config.min_interval_s = ATTR_REPORT_DEFAULT_MIN_INTERVAL_S;
+        s_report_state[i].config.max_interval_s = ATTR_REPORT_DEFAULT_MAX_INTERVAL_S;
+    }
+
+    while (1) {
+        if (ulTaskNotifyTake(pdTRUE, attr_reporter_next_wait(xTaskGetTickCount())) > 0) {
+            vTaskDelay(pdMS_TO_TICKS(ATTR_REPORT_COALESCE_MS));
+            ulTaskNotifyTake(pdTRUE, 0);
+        }
+
+        attr_reporter_process();
+    }
+}
+
+/**
+ * @brief Сохранение маски отключенных отчетов в NVS
+ */
+static void attr_reporter_save_disabled(uint32_t mask)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(ATTR_REPORT_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(nvs_handle, ATTR_REPORT_NVS_KEY, mask);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save disabled reports: %s", esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief Загрузка маски отключенных отчетов из NVS
+ */
+static void attr_reporter_load_disabled(void)
+{
+    nvs_handle_t nvs_handle;
+    uint32_t mask = 0;
+
+    if (nvs_open(ATTR_REPORT_NVS_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        nvs_get_u32(nvs_handle, ATTR_REPORT_NVS_KEY, &mask);
+        nvs_close(nvs_handle);
+    }
+    atomic_store(&s_disabled_mask, mask & ATTR_REPORT_ALL);
+    if (mask != 0) {
+        ESP_LOGI(TAG, "Reports disabled by coordinator: mask 0x%02lx", (unsigned long)mask);
+    }
+}
+
+/**
+ * @brief Изменение маски отключенных отчетов с перечитыванием конфигурации
+ */
+static void attr_reporter_update_disabled(uint32_t disable, uint32_t enable)
+{
+    uint32_t previous = atomic_load(&s_disabled_mask);
+    uint32_t mask = (previous | disable) & ~enable;
+
+    if (mask == previous) {
+        return;
+    }
+    atomic_store(&s_disabled_mask, mask);
+    attr_reporter_save_disabled(mask);
+    atomic_store(&s_config_stale, true);
+    if (s_reporter_task != NULL) {
+        xTaskNotifyGive(s_reporter_task);
+    }
+}
+
+esp_err_t attr_reporter_start(void)
+{
+    if (s_reporter_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    attr_reporter_load_disabled();
+
+    if (xTaskCreate(attr_reporter_task, "Report_task", ATTR_REPORTER_TASK_STACK_SIZE,
+                    NULL, ATTR_REPORTER_TASK_PRIORITY, &s_reporter_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create attribute reporter task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Строка таблицы атрибута (-1 - атрибута нет в таблице)
+ */
+static int attr_reporter_find(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id)
+{
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        const attr_report_entry_t *entry = &s_report_table[i];
+        if (entry->endpoint == endpoint && entry->cluster_id == cluster_id && entry->attr_id == attr_id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t attr_reporter_mark_dirty(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id)
+{
+    int row = attr_reporter_find(endpoint, cluster_id, attr_id);
+
+    if (row < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    attr_reporter_mark_mask(1u << row);
+    return ESP_OK;
+}
+
+void attr_reporter_mark_relay(uint8_t relay_num)
+{
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        if (s_report_table[i].relay_num == relay_num) {
+            attr_reporter_mark_mask(1u << i);
+        }
+    }
+}
+
+void attr_reporter_mark_all(void)
+{
+    atomic_fetch_or(&s_force_mask, ATTR_REPORT_ALL);
+    attr_reporter_mark_mask(ATTR_REPORT_ALL);
+}
+
+void attr_reporter_observe_command(uint8_t bufid)
+{
+    zb_zcl_parsed_hdr_t cmd_info;
+    ZB_ZCL_COPY_PARSED_HEADER(bufid, &cmd_info);
+
+    if (!cmd_info.is_common_command || cmd_info.is_manuf_specific || cmd_info.cmd_id != ZB_ZCL_CMD_CONFIG_REPORT ||
+        cmd_info.cmd_direction != ZB_ZCL_FRAME_DIRECTION_TO_SRV) {
+        return;
+    }
+
+    uint8_t endpoint = ZB_ZCL_PARSED_HDR_SHORT_DATA(&cmd_info).dst_endpoint;
+    const uint8_t *payload = (const uint8_t *)zb_buf_begin(bufid);
+    size_t length = zb_buf_len(bufid);
+    uint32_t disable = 0;
+    uint32_t enable = 0;
+
+    /* Записи: direction, attr_id, далее для отправки отчетов - type, min,
+     * max и reportable change (только аналоговые типы), для приема - timeout */
+    for (size_t pos = 0; pos + 3 <= length;) {
+        uint8_t direction = payload[pos];
+        uint16_t attr_id = (uint16_t)(payload[pos + 1] | (payload[pos + 2] << 8));
+
+        if (direction == ZB_ZCL_CONFIGURE_REPORTING_RECV_REPORT) {
+            pos += 5;
+            continue;
+        }
+        if (direction != ZB_ZCL_CONFIGURE_REPORTING_SEND_REPORT || pos + 8 > length) {
+            break;
+        }
+
+        uint8_t attr_type = payload[pos + 3];
+        uint16_t max_interval = (uint16_t)(payload[pos + 6] | (payload[pos + 7] << 8));
+        pos += 8;
+        if (zb_zcl_is_analog_data_type(attr_type)) {
+            pos += zb_zcl_get_analog_attribute_size(attr_type);
+        }
+
+        int row = attr_reporter_find(endpoint, cmd_info.cluster_id, attr_id);
+        if (row < 0) {
+            continue;
+        }
+        if (max_interval == ATTR_REPORT_MAX_INTERVAL_DISABLED) {
+            disable |= 1u << row;
+            enable &= ~(1u << row);
+        } else {
+            enable |= 1u << row;
+            disable &= ~(1u << row);
+        }
+    }
+
+    if (disable != 0 || enable != 0) {
+        attr_reporter_update_disabled(disable, enable);
+    }
+}
+
+void attr_reporter_clear_disabled(void)
+{
+    attr_reporter_update_disabled(0, ATTR_REPORT_ALL);
+}
+
+/**
+ * @brief Недоставленные отчеты - в журнал с повтором при следующей отправке
+ */
+static void attr_reporter_confirm_failed(uint32_t mask, esp_err_t status)
+{
+    attr_journal_record(mask);
+    atomic_fetch_add(&s_confirm_failed, 1);
+    ESP_LOGW(TAG, "Report not delivered (%s), journaled mask 0x%02lx", esp_err_to_name(status),
+             (unsigned long)mask);
+}
+
+bool attr_reporter_send_status_handler(const esp_zb_zcl_command_send_status_message_t *message)
+{
+    uint32_t delegated = 0;
+
+    for (size_t i = 0; i < ATTR_REPORT_COUNT; i++) {
+        if (s_report_table[i].endpoint != message->src_endpoint) {
+            continue;
+        }
+        if (s_inflight[i].pending && s_inflight[i].tsn == message->tsn) {
+            s_inflight[i].pending = false;
+            if (message->status != ESP_OK) {
+                attr_reporter_confirm_failed(1u << i, message->status);
+            } else {
+                /* Связь есть - повторяем строки журнала */
+                uint32_t retry = attr_journal_pending();
+                if (retry != 0) {
+                    atomic_fetch_or(&s_force_mask, retry);
+                    attr_reporter_mark_mask(retry);
+                }
+            }
+            return true;
+        }
+        if (s_report_state[i].config.configured) {
+            delegated |= 1u << i;
+        }
+    }
+
+    /* Команды клиента разобраны раньше: ошибка с endpoint настроенного
+     * атрибута - отчет, отправленный стеком */
+    if (delegated != 0 && message->status != ESP_OK) {
+        attr_reporter_confirm_failed(delegated, message->status);
+    }
+    return false;
+}
+
+void attr_reporter_set_connected(bool connected)
+{
+    bool was_connected = atomic_exchange(&s_connected, connected);
+
+    if (connected && !was_connected) {
+        uint32_t journaled = attr_journal_pending();
+        if (journaled != 0) {
+            ESP_LOGI(TAG, "Connected - flushing journaled changes (mask 0x%02lx)", (unsigned long)journaled);
+        }
+        attr_reporter_mark_all();
+    }
+}
+
+esp_err_t attr_reporter_get_config(uint8_t index, uint8_t *endpoint, uint16_t *cluster_id,
+                                   uint16_t *attr_id, attr_report_config_t *config)
+{
+    if (index >= ATTR_REPORT_COUNT) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    *endpoint = s_report_table[index].endpoint;
+    *cluster_id = s_report_table[index].cluster_id;
+    *attr_id = s_report_table[index].attr_id;
+    *config = s_report_state[index].config;
+    return ESP_OK;
+}
+
+void attr_reporter_get_stats(attr_reporter_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    stats->marks = atomic_load(&s_marks);
+    stats->coalesced = atomic_load(&s_coalesced);
+    stats->flushes = s_flushes;
+    stats->frames = s_frames;
+    stats->errors = s_errors;
+    stats->deferred = s_deferred;
+    stats->heartbeats = s_heartbeats;
+    stats->rate_limited = s_rate_limited;
+    stats->suppressed = s_suppressed;
+    stats->delegated = s_delegated;
+    stats->confirm_failed = atomic_load(&s_confirm_failed);
+    stats->lock_wait_max_us = s_lock_wait_max_us;
+}
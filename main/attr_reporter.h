@@ -0,0 +1,176 @@
+/*
+ * Attribute Reporter
+ *
+ * Планировщик отчетов об атрибутах Zigbee.
+ *
+ * Источники изменений (шина реле, подключение к сети, периодическая
+ * синхронизация) только помечают атрибуты "грязными" - это атомарная
+ * операция, которая никогда не блокирует вызывающую задачу. Задача
+ * отчетов выжидает короткое окно накопления, затем за один захват
+ * Zigbee lock обновляет значения и отправляет по одному отчету на
+ * каждый грязный атрибут всех endpoint. Повторные изменения атрибута
+ * внутри окна схлопываются в один кадр.
+ *
+ * Пока координатор не настроил отчеты атрибута командой Configure
+ * Reporting, отчеты отправляет приложение по значениям по умолчанию ниже:
+ * min_interval ограничивает частоту отчетов об изменениях, max_interval
+ * задает период повторных отчетов без изменений. Reportable change для
+ * атрибута On/Off не применяется (дискретный тип) - отчет отправляется
+ * при любом изменении значения.
+ *
+ * Настроенные координатором отчеты отправляет сам стек ZBOSS по записи
+ * значения атрибута; для таких атрибутов приложение только обновляет
+ * значение и не отправляет ни отчетов об изменениях, ни периодических,
+ * чтобы координатор не получал дубликатов. Принудительные отчеты
+ * (attr_reporter_mark_all) после подключения к сети отправляются для
+ * всех атрибутов: стек не повторяет отчеты при восстановлении связи.
+ *
+ * Configure Reporting с max_interval = 0xFFFF отключает отчеты атрибута.
+ * Стек может не хранить запись конфигурации для отключенного атрибута,
+ * поэтому отключение отслеживается по самой команде (просмотр входящих
+ * команд) и хранится в NVS до новой настройки или выхода из сети; без
+ * этого атрибут вернулся бы к отчетам приложения по умолчанию.
+ *
+ * Отчет, принятый стеком, может быть потерян позже (родитель недоступен,
+ * хотя устройство еще в сети). Отрицательное подтверждение отправки
+ * сопоставляется с отчетом по TSN и записывает строку в attr_journal;
+ * отрицательное подтверждение с endpoint настроенного атрибута, не
+ * совпавшее с отчетом приложения, считается потерей отчета стека. Строки
+ * журнала отправляются при следующей успешной отправке или подключении.
+ */
+
+#ifndef ATTR_REPORTER_H
+#define ATTR_REPORTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+#include "device_config.h"
+
+/* Параметры задачи отчетов */
+#define ATTR_REPORTER_TASK_STACK_SIZE   3072
+#define ATTR_REPORTER_TASK_PRIORITY     4     // Ниже исполнителя реле и Zigbee
+#define ATTR_REPORT_COALESCE_MS         20    // Окно накопления изменений перед отправкой
+#define ATTR_REPORT_CONFIG_POLL_S       10    // Период чтения конфигурации отчетов из стека
+
+/* Атрибуты, отчеты которых отключил координатор */
+#define ATTR_REPORT_NVS_NAMESPACE       "attr_report"
+#define ATTR_REPORT_NVS_KEY             "disabled"
+
+/* Конфигурация по умолчанию (до получения Configure Reporting) */
+#define ATTR_REPORT_DEFAULT_MIN_INTERVAL_S  0
+#define ATTR_REPORT_DEFAULT_MAX_INTERVAL_S  300
+
+/* Конфигурация отчетов атрибута */
+typedef struct {
+    uint16_t min_interval_s;         // Минимальный интервал между отчетами (с)
+    uint16_t max_interval_s;         // Максимальный интервал (с), 0 - без периодических, 0xFFFF - отключено
+    bool configured;                 // Запись конфигурации есть в стеке (отчеты отправляет стек)
+    bool disabled;                   // Отключены координатором (max_interval = 0xFFFF)
+} attr_report_config_t;
+
+/* Статистика планировщика отчетов */
+typedef struct {
+    uint32_t marks;                  // Пометок атрибутов
+    uint32_t coalesced;              // Пометок уже грязного атрибута (схлопнуто)
+    uint32_t flushes;                // Отправок пакета отчетов (захватов Zigbee lock)
+    uint32_t frames;                 // Отправлено кадров отчета
+    uint32_t errors;                 // Ошибок отправки
+    uint32_t deferred;               // Отправок, отложенных до подключения к сети
+    uint32_t heartbeats;             // Периодических отчетов без изменения значения (max_interval)
+    uint32_t rate_limited;           // Изменений, придержанных до истечения min_interval
+    uint32_t suppressed;             // Изменений, вернувшихся к отправленному значению
+    uint32_t delegated;              // Изменений, отчеты о которых отправляет стек
+    uint32_t confirm_failed;         // Отчетов, не доставленных по подтверждению стека
+    uint32_t lock_wait_max_us;       // Максимальное ожидание Zigbee lock
+} attr_reporter_stats_t;
+
+/**
+ * @brief Запуск задачи отчетов
+ * @return ESP_OK при успехе
+ */
+esp_err_t attr_reporter_start(void);
+
+/**
+ * @brief Пометка атрибута для отправки отчета
+ *
+ * Не блокируется, может вызываться из любой задачи.
+ *
+ * @param endpoint Endpoint атрибута
+ * @param cluster_id Кластер
+ * @param attr_id Атрибут
+ * @return ESP_OK или ESP_ERR_NOT_FOUND (атрибут не входит в таблицу отчетов)
+ */
+esp_err_t attr_reporter_mark_dirty(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id);
+
+/**
+ * @brief Пометка атрибута On/Off реле для отправки отчета
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ */
+void attr_reporter_mark_relay(uint8_t relay_num);
+
+/**
+ * @brief Пометка всех атрибутов таблицы для отправки отчета
+ *
+ * Отчет отправляется без проверки изменения значения и min_interval.
+ */
+void attr_reporter_mark_all(void);
+
+/**
+ * @brief Состояние подключения к сети
+ *
+ * Пока устройство не подключено, грязные атрибуты накапливаются и
+ * отправляются после подключения. При подключении помечаются все
+ * атрибуты, чтобы координатор получил актуальное состояние.
+ *
+ * @param connected true - устройство в сети
+ */
+void attr_reporter_set_connected(bool connected);
+
+/**
+ * @brief Просмотр входящей команды ZCL (Configure Reporting)
+ *
+ * Вызывается из обработчика raw-команд (контекст задачи Zigbee) до
+ * обработки стеком; команду не забирает.
+ *
+ * @param bufid Буфер команды
+ */
+void attr_reporter_observe_command(uint8_t bufid);
+
+/**
+ * @brief Сброс отключенных координатором отчетов (выход из сети)
+ */
+void attr_reporter_clear_disabled(void);
+
+/**
+ * @brief Обработка подтверждения отправки ZCL команды
+ *
+ * Вызывается из обработчика esp_zb_zcl_command_send_status (контекст
+ * задачи Zigbee, под Zigbee lock). При ошибке доставки строка таблицы
+ * записывается в журнал для повторной отправки.
+ *
+ * @param message Подтверждение
+ * @return true - подтверждение относится к отчету приложения
+ */
+bool attr_reporter_send_status_handler(const esp_zb_zcl_command_send_status_message_t *message);
+
+/**
+ * @brief Действующая конфигурация отчетов строки таблицы
+ * @param index Номер строки таблицы отчетов
+ * @param endpoint Endpoint атрибута
+ * @param cluster_id Кластер
+ * @param attr_id Атрибут
+ * @param config Конфигурация
+ * @return ESP_OK или ESP_ERR_NOT_FOUND (строки нет)
+ */
+esp_err_t attr_reporter_get_config(uint8_t index, uint8_t *endpoint, uint16_t *cluster_id,
+                                   uint16_t *attr_id, attr_report_config_t *config);
+
+/**
+ * @brief Получение статистики планировщика отчетов
+ * @param stats Буфер для статистики
+ */
+void attr_reporter_get_stats(attr_reporter_stats_t *stats);
+
+#endif // ATTR_REPORTER_H
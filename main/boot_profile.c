@@ -0,0 +1,128 @@
+/*
+ * Boot Profile
+ *
+ * Метки этапов загрузки (см. boot_profile.h).
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "device_config.h"
+#include "boot_profile.h"
+
+static const char *TAG = "BOOT_PROFILE";
+
+static int64_t s_milestone_us[BOOT_MILESTONE_MAX];
+static bool s_reached[BOOT_MILESTONE_MAX];
+static portMUX_TYPE s_profile_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Значение атрибута (octet string, хранится в атрибуте ZCL) */
+static uint8_t s_attr_value[BOOT_PROFILE_ATTR_SIZE];
+
+void boot_profile_mark(boot_milestone_t milestone)
+{
+    if (milestone >= BOOT_MILESTONE_MAX) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    bool first = false;
+
+    portENTER_CRITICAL(&s_profile_lock);
+    if (!s_reached[milestone]) {
+        s_reached[milestone] = true;
+        s_milestone_us[milestone] = now_us;
+        first = true;
+    }
+    portEXIT_CRITICAL(&s_profile_lock);
+
+    if (first) {
+        ESP_LOGI(TAG, "%s at %lld ms", boot_profile_milestone_to_string(milestone), now_us / 1000);
+    }
+}
+
+int64_t boot_profile_get_us(boot_milestone_t milestone)
+{
+    int64_t value = -1;
+
+    if (milestone >= BOOT_MILESTONE_MAX) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&s_profile_lock);
+    if (s_reached[milestone]) {
+        value = s_milestone_us[milestone];
+    }
+    portEXIT_CRITICAL(&s_profile_lock);
+    return value;
+}
+
+const char *boot_profile_milestone_to_string(boot_milestone_t milestone)
+{
+    switch (milestone) {
+    case BOOT_MILESTONE_APP_MAIN:
+        return "app_main";
+    case BOOT_MILESTONE_NVS_READY:
+        return "nvs_ready";
+    case BOOT_MILESTONE_NETIF_READY:
+        return "netif_ready";
+    case BOOT_MILESTONE_PLATFORM_READY:
+        return "platform_ready";
+    case BOOT_MILESTONE_ZB_INIT:
+        return "zb_init";
+    case BOOT_MILESTONE_ZB_REGISTERED:
+        return "zb_registered";
+    case BOOT_MILESTONE_TASKS_CREATED:
+        return "tasks_created";
+    case BOOT_MILESTONE_ZB_STARTED:
+        return "zb_started";
+    case BOOT_MILESTONE_ZB_STACK_READY:
+        return "zb_stack_ready";
+    case BOOT_MILESTONE_JOINED:
+        return "joined";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * @brief Сборка значения атрибута из текущих меток
+ */
+static void boot_profile_encode(uint8_t *value)
+{
+    value[0] = BOOT_PROFILE_ATTR_SIZE - 1;  // Длина octet string
+    value[1] = BOOT_PROFILE_FORMAT_VERSION;
+    value[2] = BOOT_MILESTONE_MAX;
+
+    for (int i = 0; i < BOOT_MILESTONE_MAX; i++) {
+        int64_t us = boot_profile_get_us((boot_milestone_t)i);
+        uint32_t ms = us < 0 ? BOOT_PROFILE_NOT_REACHED : (uint32_t)(us / 1000);
+        uint8_t *p = &value[3 + i * sizeof(uint32_t)];
+
+        p[0] = ms & 0xFF;
+        p[1] = (ms >> 8) & 0xFF;
+        p[2] = (ms >> 16) & 0xFF;
+        p[3] = (ms >> 24) & 0xFF;
+    }
+}
+
+esp_err_t boot_profile_add_attr(esp_zb_attribute_list_t *basic_cluster)
+{
+    boot_profile_encode(s_attr_value);
+    return esp_zb_cluster_add_manufacturer_attr(basic_cluster, ESP_ZB_ZCL_CLUSTER_ID_BASIC, BOOT_PROFILE_ATTR_ID,
+                                                ZIGBEE_MANUFACTURER_CODE, ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                                ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, s_attr_value);
+}
+
+void boot_profile_publish(void)
+{
+    boot_profile_encode(s_attr_value);
+
+    esp_zb_zcl_status_t status = esp_zb_zcl_set_manufacturer_attribute_val(
+        BOOT_PROFILE_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_BASIC, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+        ZIGBEE_MANUFACTURER_CODE, BOOT_PROFILE_ATTR_ID, s_attr_value, false);
+    if (status != ESP_ZB_ZCL_STATUS_SUCCESS) {
+        ESP_LOGW(TAG, "Failed to update boot profile attribute: 0x%02x", status);
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * Boot Profile
+ *
+ * Профилировщик загрузки: метки времени (esp_timer) ключевых этапов от
+ * входа в app_main до подключения к сети. Каждая метка фиксируется
+ * только один раз - при первом достижении этапа, поэтому повторные
+ * подключения не искажают профиль загрузки.
+ *
+ * Профиль доступен в консоли (boot profile) и как manufacturer-specific
+ * атрибут Basic кластера endpoint реле 1 (manufacturer code
+ * ZIGBEE_MANUFACTURER_CODE). Значение атрибута - octet string:
+ *   [0]       версия формата (BOOT_PROFILE_FORMAT_VERSION)
+ *   [1]       количество этапов N
+ *   [2..]     N x uint32 little-endian - время этапа от загрузки в мс,
+ *             0xFFFFFFFF - этап еще не достигнут
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+#include "device_config.h"
+
+/* Атрибут профиля в Basic кластере endpoint реле 1 */
+#define BOOT_PROFILE_ENDPOINT           relay_channel_endpoint(1)
+#define BOOT_PROFILE_ATTR_ID            0xF000
+#define BOOT_PROFILE_FORMAT_VERSION     2
+#define BOOT_PROFILE_NOT_REACHED        0xFFFFFFFFUL
+
+/* Этапы загрузки (в порядке прохождения) */
+typedef enum {
+    BOOT_MILESTONE_APP_MAIN = 0,     // Вход в app_main
+    BOOT_MILESTONE_NVS_READY,        // NVS и сохраненные данные загружены
+    BOOT_MILESTONE_NETIF_READY,      // esp_netif_init
+    BOOT_MILESTONE_PLATFORM_READY,   // esp_zb_platform_config
+    BOOT_MILESTONE_ZB_INIT,          // esp_zb_init
+    BOOT_MILESTONE_ZB_REGISTERED,    // Endpoint созданы и зарегистрированы
+    BOOT_MILESTONE_TASKS_CREATED,    // Задачи приложения созданы
+    BOOT_MILESTONE_ZB_STARTED,       // esp_zb_start
+    BOOT_MILESTONE_ZB_STACK_READY,   // DEVICE_FIRST_START / DEVICE_REBOOT
+    BOOT_MILESTONE_JOINED,           // Подключение к сети (steering или rejoin)
+    BOOT_MILESTONE_MAX
+} boot_milestone_t;
+
+/* Размер значения атрибута: длина + версия + количество + метки */
+#define BOOT_PROFILE_ATTR_SIZE          (3 + BOOT_MILESTONE_MAX * sizeof(uint32_t))
+
+/**
+ * @brief Фиксация этапа загрузки
+ *
+ * Учитывается только первый вызов для этапа. Может вызываться из любой задачи.
+ *
+ * @param milestone Этап
+ */
+void boot_profile_mark(boot_milestone_t milestone);
+
+/**
+ * @brief Время этапа от загрузки
+ * @param milestone Этап
+ * @return Время в мкс или -1, если этап еще не достигнут
+ */
+int64_t boot_profile_get_us(boot_milestone_t milestone);
+
+/**
+ * @brief Название этапа
+ */
+const char *boot_profile_milestone_to_string(boot_milestone_t milestone);
+
+/**
+ * @brief Добавление атрибута профиля в Basic кластер
+ *
+ * Вызывается при создании endpoint BOOT_PROFILE_ENDPOINT.
+ *
+ * @param basic_cluster Список атрибутов Basic кластера
+ * @return ESP_OK при успехе
+ */
+esp_err_t boot_profile_add_attr(esp_zb_attribute_list_t *basic_cluster);
+
+/**
+ * @brief Обновление значения атрибута профиля
+ *
+ * Вызывается из контекста задачи Zigbee (или под Zigbee lock).
+ */
+void boot_profile_publish(void);
+
+#endif // BOOT_PROFILE_H
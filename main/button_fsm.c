@@ -0,0 +1,75 @@
+/*
+ * Button Debounce State Machine
+ *
+ * Реализация автомата подавления дребезга кнопки (см. button_fsm.h).
+ * Модуль не использует ESP-IDF и может собираться на хосте.
+ */
+
+#include "button_fsm.h"
+
+/**
+ * @brief Принятие нового стабильного состояния и формирование события
+ */
+static uint32_t button_fsm_accept(button_fsm_t *fsm, bool pressed, int64_t now_us, button_event_t *event)
+{
+    fsm->stable_pressed = pressed;
+    fsm->lockout = true;
+
+    event->timestamp_us = now_us;
+    if (pressed) {
+        fsm->press_start_us = now_us;
+        event->type = BUTTON_EVENT_PRESS;
+        event->press_class = BUTTON_PRESS_NONE;
+        event->duration_ms = 0;
+    } else {
+        int64_t duration_us = now_us - fsm->press_start_us;
+        event->type = BUTTON_EVENT_RELEASE;
+        event->duration_ms = duration_us > 0 ? (uint32_t)(duration_us / 1000) : 0;
+        event->press_class = button_fsm_classify(fsm, event->duration_ms);
+    }
+
+    return BUTTON_FSM_EVENT | BUTTON_FSM_ARM_TIMER;
+}
+
+void button_fsm_init(button_fsm_t *fsm, uint32_t debounce_ms, uint32_t long_press_ms,
+                     uint32_t very_long_press_ms, bool pressed)
+{
+    fsm->stable_pressed = pressed;
+    fsm->lockout = false;
+    fsm->press_start_us = 0;
+    fsm->debounce_us = debounce_ms * 1000;
+    fsm->long_press_ms = long_press_ms;
+    fsm->very_long_press_ms = very_long_press_ms;
+}
+
+uint32_t button_fsm_edge(button_fsm_t *fsm, bool pressed, int64_t now_us, button_event_t *event)
+{
+    /* Во время окна блокировки фронты игнорируются - уровень будет перечитан по таймауту */
+    if (fsm->lockout || pressed == fsm->stable_pressed) {
+        return 0;
+    }
+
+    return button_fsm_accept(fsm, pressed, now_us, event);
+}
+
+uint32_t button_fsm_timeout(button_fsm_t *fsm, bool pressed, int64_t now_us, button_event_t *event)
+{
+    fsm->lockout = false;
+
+    /* Фронт был пропущен во время окна блокировки - принимаем его сейчас */
+    if (pressed != fsm->stable_pressed) {
+        return button_fsm_accept(fsm, pressed, now_us, event);
+    }
+
+    return 0;
+}
+
+button_press_class_t button_fsm_classify(const button_fsm_t *fsm, uint32_t duration_ms)
+{
+    if (duration_ms < fsm->long_press_ms) {
+        return BUTTON_PRESS_SHORT;
+    } else if (duration_ms < fsm->very_long_press_ms) {
+        return BUTTON_PRESS_LONG;
+    }
+    return BUTTON_PRESS_VERY_LONG;
+}
@@ -0,0 +1,99 @@
+/*
+ * Button Debounce State Machine
+ *
+ * Автомат подавления дребезга кнопки пэйринга.
+ *
+ * Модуль не зависит от ESP-IDF и FreeRTOS: на вход подаются фронты с
+ * временными метками (мкс), на выходе - события нажатия/отпускания.
+ * Благодаря этому автомат можно прогонять на хосте по записанным
+ * временным меткам фронтов.
+ *
+ * Алгоритм - "ранний" антидребезг с окном блокировки:
+ * - первый фронт, меняющий стабильное состояние, принимается сразу
+ *   (задержка обнаружения нажатия определяется только латентностью ISR);
+ * - после принятого фронта на BUTTON_DEBOUNCE_TIME_MS все фронты
+ *   игнорируются, по окончании окна уровень кнопки перечитывается.
+ */
+
+#ifndef BUTTON_FSM_H
+#define BUTTON_FSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Тип события кнопки */
+typedef enum {
+    BUTTON_EVENT_PRESS = 0,          // Кнопка нажата
+    BUTTON_EVENT_RELEASE             // Кнопка отпущена
+} button_event_type_t;
+
+/* Классификация нажатия по длительности */
+typedef enum {
+    BUTTON_PRESS_NONE = 0,           // Нет классификации (событие PRESS)
+    BUTTON_PRESS_SHORT,              // Короткое нажатие (< long_press_ms)
+    BUTTON_PRESS_LONG,               // Длинное нажатие (long_press_ms .. very_long_press_ms)
+    BUTTON_PRESS_VERY_LONG           // Очень длинное нажатие (>= very_long_press_ms)
+} button_press_class_t;
+
+/* Событие кнопки */
+typedef struct {
+    button_event_type_t type;        // Нажатие или отпускание
+    button_press_class_t press_class; // Классификация (только для RELEASE)
+    int64_t timestamp_us;            // Время принятого фронта (мкс)
+    uint32_t duration_ms;            // Длительность нажатия (только для RELEASE)
+} button_event_t;
+
+/* Флаги результата обработки фронта/таймаута */
+#define BUTTON_FSM_EVENT             (1 << 0)   // Сформировано событие
+#define BUTTON_FSM_ARM_TIMER         (1 << 1)   // Нужно запустить таймер окна блокировки
+
+/* Состояние автомата */
+typedef struct {
+    bool stable_pressed;             // Принятое (стабильное) состояние кнопки
+    bool lockout;                    // Идет окно блокировки дребезга
+    int64_t press_start_us;          // Время принятого нажатия
+    uint32_t debounce_us;            // Длительность окна блокировки
+    uint32_t long_press_ms;          // Порог длинного нажатия
+    uint32_t very_long_press_ms;     // Порог очень длинного нажатия
+} button_fsm_t;
+
+/**
+ * @brief Инициализация автомата
+ * @param fsm Автомат
+ * @param debounce_ms Окно подавления дребезга (мс)
+ * @param long_press_ms Порог длинного нажатия (мс)
+ * @param very_long_press_ms Порог очень длинного нажатия (мс)
+ * @param pressed Текущее состояние кнопки при инициализации
+ */
+void button_fsm_init(button_fsm_t *fsm, uint32_t debounce_ms, uint32_t long_press_ms,
+                     uint32_t very_long_press_ms, bool pressed);
+
+/**
+ * @brief Обработка фронта кнопки (вызывается из ISR)
+ * @param fsm Автомат
+ * @param pressed Уровень кнопки после фронта (true = нажата)
+ * @param now_us Время фронта (мкс)
+ * @param event Событие (заполняется при BUTTON_FSM_EVENT)
+ * @return Комбинация флагов BUTTON_FSM_EVENT / BUTTON_FSM_ARM_TIMER
+ */
+uint32_t button_fsm_edge(button_fsm_t *fsm, bool pressed, int64_t now_us, button_event_t *event);
+
+/**
+ * @brief Окончание окна блокировки (вызывается из таймера)
+ * @param fsm Автомат
+ * @param pressed Уровень кнопки на момент окончания окна
+ * @param now_us Текущее время (мкс)
+ * @param event Событие (заполняется при BUTTON_FSM_EVENT)
+ * @return Комбинация флагов BUTTON_FSM_EVENT / BUTTON_FSM_ARM_TIMER
+ */
+uint32_t button_fsm_timeout(button_fsm_t *fsm, bool pressed, int64_t now_us, button_event_t *event);
+
+/**
+ * @brief Классификация нажатия по длительности
+ * @param fsm Автомат (пороги)
+ * @param duration_ms Длительность нажатия (мс)
+ * @return Класс нажатия
+ */
+button_press_class_t button_fsm_classify(const button_fsm_t *fsm, uint32_t duration_ms);
+
+#endif // BUTTON_FSM_H
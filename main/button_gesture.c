@@ -0,0 +1,108 @@
+/*
+ * Button Gesture Recognizer
+ *
+ * Реализация распознавателя жестов кнопки (см. button_gesture.h).
+ * Модуль не использует ESP-IDF и может собираться на хосте.
+ */
+
+#include "button_gesture.h"
+
+/**
+ * @brief Жест по числу кликов серии
+ */
+static button_gesture_t button_gesture_clicks(uint8_t clicks)
+{
+    return (button_gesture_t)(BUTTON_GESTURE_SINGLE + clicks - 1);
+}
+
+void button_gesture_init(button_gesture_fsm_t *fsm, const button_gesture_config_t *config)
+{
+    fsm->pressed = false;
+    fsm->holding = false;
+    fsm->press_us = 0;
+    button_gesture_configure(fsm, config);
+}
+
+void button_gesture_configure(button_gesture_fsm_t *fsm, const button_gesture_config_t *config)
+{
+    fsm->config = *config;
+    if (fsm->config.max_clicks < 1) {
+        fsm->config.max_clicks = 1;
+    } else if (fsm->config.max_clicks > 3) {
+        fsm->config.max_clicks = 3;
+    }
+
+    fsm->clicks = 0;
+    fsm->deadline_us = (fsm->pressed && fsm->config.hold_enabled && !fsm->holding)
+                       ? fsm->press_us + (int64_t)fsm->config.hold_ms * 1000
+                       : BUTTON_GESTURE_NO_DEADLINE;
+}
+
+button_gesture_t button_gesture_event(button_gesture_fsm_t *fsm, const button_event_t *event)
+{
+    if (event->type == BUTTON_EVENT_PRESS) {
+        fsm->pressed = true;
+        fsm->press_us = event->timestamp_us;
+        /* Окно клика закрыто нажатием; дальше ждем только порог удержания */
+        fsm->deadline_us = fsm->config.hold_enabled
+                           ? event->timestamp_us + (int64_t)fsm->config.hold_ms * 1000
+                           : BUTTON_GESTURE_NO_DEADLINE;
+        return BUTTON_GESTURE_NONE;
+    }
+
+    fsm->pressed = false;
+    fsm->deadline_us = BUTTON_GESTURE_NO_DEADLINE;
+
+    if (fsm->holding) {
+        fsm->holding = false;
+        fsm->clicks = 0;
+        return BUTTON_GESTURE_HOLD_RELEASE;
+    }
+
+    /* Длинное нажатие - системное действие (пэйринг), не клик */
+    if (event->press_class != BUTTON_PRESS_SHORT) {
+        fsm->clicks = 0;
+        return BUTTON_GESTURE_NONE;
+    }
+
+    fsm->clicks++;
+    if (fsm->clicks >= fsm->config.max_clicks) {
+        /* Больше кликов не ожидается - без окна ожидания */
+        uint8_t clicks = fsm->clicks;
+        fsm->clicks = 0;
+        return button_gesture_clicks(clicks);
+    }
+
+    fsm->deadline_us = event->timestamp_us + (int64_t)fsm->config.multi_click_ms * 1000;
+    return BUTTON_GESTURE_NONE;
+}
+
+button_gesture_t button_gesture_timeout(button_gesture_fsm_t *fsm, int64_t now_us)
+{
+    if (now_us < fsm->deadline_us) {
+        return BUTTON_GESTURE_NONE;
+    }
+    fsm->deadline_us = BUTTON_GESTURE_NO_DEADLINE;
+
+    if (fsm->pressed) {
+        if (!fsm->config.hold_enabled || fsm->holding) {
+            return BUTTON_GESTURE_NONE;
+        }
+        fsm->holding = true;
+        fsm->clicks = 0;
+        return BUTTON_GESTURE_HOLD_START;
+    }
+
+    if (fsm->clicks == 0) {
+        return BUTTON_GESTURE_NONE;
+    }
+
+    uint8_t clicks = fsm->clicks;
+    fsm->clicks = 0;
+    return button_gesture_clicks(clicks);
+}
+
+int64_t button_gesture_deadline(const button_gesture_fsm_t *fsm)
+{
+    return fsm->deadline_us;
+}
@@ -0,0 +1,102 @@
+/*
+ * Button Gesture Recognizer
+ *
+ * Распознавание жестов кнопки по событиям автомата антидребезга
+ * (button_fsm): одиночный, двойной и тройной клик, начало и конец
+ * удержания.
+ *
+ * Модуль не зависит от ESP-IDF и FreeRTOS: на вход подаются события
+ * нажатия/отпускания с временными метками и вызовы по истечении срока
+ * (button_gesture_deadline), на выходе - жесты. Благодаря этому
+ * распознаватель можно прогонять на хосте по синтетическим временным
+ * меткам фронтов.
+ *
+ * Решение принимается с минимальной задержкой:
+ * - клик с максимальным числом нажатий (max_clicks) сообщается сразу
+ *   при отпускании; при max_clicks = 1 одиночный клик не ждет окна
+ *   повторного нажатия;
+ * - меньшее число кликов сообщается по истечении multi_click_ms после
+ *   последнего отпускания без нового нажатия;
+ * - при разрешенном удержании нажатие дольше hold_ms дает HOLD_START
+ *   (без ожидания отпускания), отпускание после него - HOLD_RELEASE;
+ *   клики, набранные до удержания, отбрасываются.
+ * Нажатия длиннее порога длинного нажатия автомата антидребезга (режим
+ * пэйринга) кликами не считаются.
+ */
+
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "button_fsm.h"
+
+#define BUTTON_GESTURE_NO_DEADLINE  INT64_MAX
+
+/* Жест */
+typedef enum {
+    BUTTON_GESTURE_NONE = -1,
+    BUTTON_GESTURE_SINGLE = 0,       // Одиночный клик
+    BUTTON_GESTURE_DOUBLE,           // Двойной клик
+    BUTTON_GESTURE_TRIPLE,           // Тройной клик
+    BUTTON_GESTURE_HOLD_START,       // Начало удержания
+    BUTTON_GESTURE_HOLD_RELEASE,     // Отпускание после удержания
+    BUTTON_GESTURE_MAX
+} button_gesture_t;
+
+/* Параметры распознавания */
+typedef struct {
+    uint32_t multi_click_ms;         // Окно ожидания следующего клика
+    uint32_t hold_ms;                // Порог удержания
+    uint8_t max_clicks;              // Наибольшее число кликов в жесте (1..3)
+    bool hold_enabled;               // Распознавать удержание
+} button_gesture_config_t;
+
+/* Состояние распознавателя */
+typedef struct {
+    button_gesture_config_t config;
+    bool pressed;                    // Кнопка нажата
+    bool holding;                    // Идет удержание (HOLD_START сообщен)
+    uint8_t clicks;                  // Клики текущей серии
+    int64_t press_us;                // Время последнего нажатия
+    int64_t deadline_us;             // Срок удержания или окна клика
+} button_gesture_fsm_t;
+
+/**
+ * @brief Инициализация распознавателя
+ * @param fsm Распознаватель
+ * @param config Параметры
+ */
+void button_gesture_init(button_gesture_fsm_t *fsm, const button_gesture_config_t *config);
+
+/**
+ * @brief Смена параметров (незавершенная серия кликов сбрасывается)
+ * @param fsm Распознаватель
+ * @param config Параметры
+ */
+void button_gesture_configure(button_gesture_fsm_t *fsm, const button_gesture_config_t *config);
+
+/**
+ * @brief Обработка события кнопки
+ * @param fsm Распознаватель
+ * @param event Событие автомата антидребезга
+ * @return Распознанный жест или BUTTON_GESTURE_NONE
+ */
+button_gesture_t button_gesture_event(button_gesture_fsm_t *fsm, const button_event_t *event);
+
+/**
+ * @brief Обработка истечения срока
+ * @param fsm Распознаватель
+ * @param now_us Текущее время (мкс)
+ * @return Распознанный жест или BUTTON_GESTURE_NONE
+ */
+button_gesture_t button_gesture_timeout(button_gesture_fsm_t *fsm, int64_t now_us);
+
+/**
+ * @brief Ближайший срок, к которому нужно вызвать button_gesture_timeout
+ * @param fsm Распознаватель
+ * @return Время (мкс) или BUTTON_GESTURE_NO_DEADLINE
+ */
+int64_t button_gesture_deadline(const button_gesture_fsm_t *fsm);
+
+#endif // BUTTON_GESTURE_H
@@ -0,0 +1,191 @@
+/*
+ * Deferred Log
+ *
+ * Отложенный бинарный журнал (см. deferred_log.h).
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "deferred_log.h"
+
+static const char *TAG = "DLOG";
+
+#define DEFERRED_LOG_RING_MASK  (DEFERRED_LOG_RING_SIZE - 1)
+
+_Static_assert((DEFERRED_LOG_RING_SIZE & DEFERRED_LOG_RING_MASK) == 0,
+               "DEFERRED_LOG_RING_SIZE must be a power of two");
+
+static deferred_log_record_t s_ring[DEFERRED_LOG_RING_SIZE];
+static uint32_t s_head = 0;              // Номер следующей записи
+static uint32_t s_tail = 0;              // Номер следующей записи к выводу
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task = NULL;
+
+static uint32_t s_dropped = 0;
+static uint32_t s_truncated = 0;
+static uint32_t s_rendered = 0;
+static uint32_t s_depth_max = 0;
+
+/* Буква уровня и цвет, как в ESP_LOGx */
+static const struct {
+    char letter;
+    const char *color;
+} s_levels[] = {
+    [ESP_LOG_NONE]    = {'N', ""},
+    [ESP_LOG_ERROR]   = {'E', LOG_COLOR_E},
+    [ESP_LOG_WARN]    = {'W', LOG_COLOR_W},
+    [ESP_LOG_INFO]    = {'I', LOG_COLOR_I},
+    [ESP_LOG_DEBUG]   = {'D', LOG_COLOR_D},
+    [ESP_LOG_VERBOSE] = {'V', LOG_COLOR_V},
+};
+
+void deferred_log_write(esp_log_level_t level, const char *tag, uint32_t nargs, const char *format, ...)
+{
+    deferred_log_record_t record = {
+        .timestamp_ms = esp_log_timestamp(),
+        .tag = tag,
+        .format = format,
+        .level = (uint8_t)level,
+        .nargs = (uint8_t)(nargs > DEFERRED_LOG_MAX_ARGS ? DEFERRED_LOG_MAX_ARGS : nargs),
+    };
+
+    va_list ap;
+    va_start(ap, format);
+    for (uint32_t i = 0; i < record.nargs; i++) {
+        record.args[i] = va_arg(ap, uint32_t);
+    }
+    va_end(ap);
+
+    bool was_empty;
+    portENTER_CRITICAL(&s_lock);
+    uint32_t depth = s_head - s_tail;
+    if (depth >= DEFERRED_LOG_RING_SIZE) {
+        s_dropped++;
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    s_ring[s_head & DEFERRED_LOG_RING_MASK] = record;
+    s_head++;
+    if (nargs > DEFERRED_LOG_MAX_ARGS) {
+        s_truncated++;
+    }
+    if (depth + 1 > s_depth_max) {
+        s_depth_max = depth + 1;
+    }
+    was_empty = (depth == 0);
+    portEXIT_CRITICAL(&s_lock);
+
+    if (was_empty && s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+void deferred_log_format(const deferred_log_record_t *record, char *buf, size_t size)
+{
+    const uint32_t *a = record->args;
+
+    /* Все аргументы 32-битные: лишние слова строкой формата не читаются */
+    snprintf(buf, size, record->format, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+/**
+ * @brief Вывод записи через esp_log_write
+ */
+static void deferred_log_render(const deferred_log_record_t *record)
+{
+    static char line[DEFERRED_LOG_LINE_MAX];
+    esp_log_level_t level = (esp_log_level_t)record->level;
+
+    if (level <= ESP_LOG_NONE || level > ESP_LOG_VERBOSE) {
+        return;
+    }
+
+    deferred_log_format(record, line, sizeof(line));
+    esp_log_write(level, record->tag, "%s%c (%lu) %s: %s" LOG_RESET_COLOR "\n",
+                  s_levels[level].color, s_levels[level].letter,
+                  (unsigned long)record->timestamp_ms, record->tag, line);
+}
+
+/**
+ * @brief Задача вывода журнала
+ *
+ * Просыпается по уведомлению о первой записи в пустой буфер (или раз в
+ * DEFERRED_LOG_IDLE_FLUSH_MS) и выводит все накопленные записи.
+ */
+static void deferred_log_task(void *pvParameters)
+{
+    uint32_t dropped_reported = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DEFERRED_LOG_IDLE_FLUSH_MS));
+
+        while (1) {
+            deferred_log_record_t record;
+            uint32_t dropped;
+
+            portENTER_CRITICAL(&s_lock);
+            bool empty = (s_head == s_tail);
+            if (!empty) {
+                record = s_ring[s_tail & DEFERRED_LOG_RING_MASK];
+                s_tail++;
+            }
+            dropped = s_dropped;
+            portEXIT_CRITICAL(&s_lock);
+
+            if (dropped != dropped_reported) {
+                ESP_LOGW(TAG, "%lu deferred log record(s) dropped", (unsigned long)(dropped - dropped_reported));
+                dropped_reported = dropped;
+            }
+            if (empty) {
+                break;
+            }
+
+            deferred_log_render(&record);
+            s_rendered++;
+        }
+    }
+}
+
+esp_err_t deferred_log_start(void)
+{
+    if (s_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xTaskCreate(deferred_log_task, "Log_task", DEFERRED_LOG_TASK_STACK_SIZE,
+                    NULL, DEFERRED_LOG_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create deferred log task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+size_t deferred_log_get_recent(deferred_log_record_t *records)
+{
+    portENTER_CRITICAL(&s_lock);
+    uint32_t count = s_head < DEFERRED_LOG_RING_SIZE ? s_head : DEFERRED_LOG_RING_SIZE;
+    uint32_t first = s_head - count;
+    for (uint32_t i = 0; i < count; i++) {
+        records[i] = s_ring[(first + i) & DEFERRED_LOG_RING_MASK];
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return count;
+}
+
+void deferred_log_get_stats(deferred_log_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_lock);
+    stats->captured = s_head;
+    stats->rendered = s_rendered;
+    stats->dropped = s_dropped;
+    stats->truncated = s_truncated;
+    stats->depth = s_head - s_tail;
+    stats->depth_max = s_depth_max;
+    portEXIT_CRITICAL(&s_lock);
+}
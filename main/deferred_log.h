@@ -0,0 +1,137 @@
+/*
+ * Deferred Log
+ *
+ * Отложенный бинарный журнал для горячих путей (обработчик атрибутов
+ * Zigbee, исполнитель реле).
+ *
+ * DLOGI/DLOGW/... вместо форматирования и вывода в UART записывают в
+ * кольцевой буфер фиксированного размера только адрес строки формата,
+ * тег, уровень, метку времени и до DEFERRED_LOG_MAX_ARGS аргументов
+ * как 32-битные слова - O(1), без блокировки на UART. Низкоприоритетная
+ * задача вычитывает буфер и выводит строки через esp_log_write в том же
+ * виде, что и ESP_LOGx, с исходной меткой времени.
+ *
+ * Адрес строки формата является ее идентификатором: строка лежит в
+ * .rodata образа, поэтому сырые записи (команда консоли "dlog dump")
+ * восстанавливаются в текст на хосте по ELF-файлу прошивки:
+ *   python tools/dlog_decode.py build/RoboSR2CH10A.elf dump.txt
+ *
+ * Ограничения аргументов (проверяются атрибутом format, но не типом):
+ *   - только 32-битные значения: целые, символы, указатели;
+ *     64-битные целые и числа с плавающей точкой не поддерживаются;
+ *   - %s - только строки со статическим временем жизни (литералы,
+ *     константы), так как текст строки читается при выводе.
+ *
+ * При переполнении буфера новые записи отбрасываются, количество
+ * отброшенных выводится отдельной строкой, чтобы пропуск был виден.
+ * При DEFERRED_LOG_ENABLED 0 макросы раскрываются в ESP_LOGx.
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+/* Отложенный вывод (0 - DLOGx выводят сразу через ESP_LOGx) */
+#define DEFERRED_LOG_ENABLED            1
+
+#define DEFERRED_LOG_RING_SIZE          64    // Записей в буфере (степень двойки)
+#define DEFERRED_LOG_MAX_ARGS           6     // Аргументов в записи
+#define DEFERRED_LOG_LINE_MAX           128   // Длина строки при выводе
+
+/* Параметры задачи вывода */
+#define DEFERRED_LOG_TASK_STACK_SIZE    3072
+#define DEFERRED_LOG_TASK_PRIORITY      1     // Ниже всех задач приложения
+#define DEFERRED_LOG_IDLE_FLUSH_MS      100   // Период проверки буфера без уведомлений
+
+/* Запись журнала (формат хранения и выгрузки) */
+typedef struct {
+    uint32_t timestamp_ms;           // esp_log_timestamp() в момент записи
+    const char *tag;                 // Тег (строка в .rodata)
+    const char *format;              // Строка формата (идентификатор сообщения)
+    uint8_t level;                   // esp_log_level_t
+    uint8_t nargs;                   // Количество аргументов
+    uint32_t args[DEFERRED_LOG_MAX_ARGS];
+} deferred_log_record_t;
+
+/* Статистика журнала */
+typedef struct {
+    uint32_t captured;               // Записано в буфер
+    uint32_t rendered;               // Выведено задачей
+    uint32_t dropped;                // Отброшено (буфер переполнен)
+    uint32_t truncated;              // Записей с отброшенными лишними аргументами
+    uint32_t depth;                  // Текущая глубина буфера
+    uint32_t depth_max;              // Максимальная глубина буфера
+} deferred_log_stats_t;
+
+/* Количество аргументов макроса (0..DEFERRED_LOG_MAX_ARGS) */
+#define DLOG_NARGS(...)     DLOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+
+#if DEFERRED_LOG_ENABLED
+#define DLOG_LEVEL(level, tag, format, ...) do {                                          \
+        if (LOG_LOCAL_LEVEL >= (level)) {                                                  \
+            deferred_log_write((level), (tag), DLOG_NARGS(__VA_ARGS__), format, ##__VA_ARGS__); \
+        }                                                                                  \
+    } while (0)
+
+#define DLOGE(tag, format, ...) DLOG_LEVEL(ESP_LOG_ERROR,   tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) DLOG_LEVEL(ESP_LOG_WARN,    tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) DLOG_LEVEL(ESP_LOG_INFO,    tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) DLOG_LEVEL(ESP_LOG_DEBUG,   tag, format, ##__VA_ARGS__)
+#define DLOGV(tag, format, ...) DLOG_LEVEL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+#else
+#define DLOGE(tag, format, ...) ESP_LOGE(tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) ESP_LOGW(tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) ESP_LOGI(tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) ESP_LOGD(tag, format, ##__VA_ARGS__)
+#define DLOGV(tag, format, ...) ESP_LOGV(tag, format, ##__VA_ARGS__)
+#endif
+
+/**
+ * @brief Запуск задачи вывода журнала
+ *
+ * Записи, сделанные до запуска, выводятся после него.
+ *
+ * @return ESP_OK при успехе
+ */
+esp_err_t deferred_log_start(void);
+
+/**
+ * @brief Запись в журнал (используется через DLOGx)
+ *
+ * Может вызываться из любой задачи, не из ISR.
+ *
+ * @param level Уровень (esp_log_level_t)
+ * @param tag Тег со статическим временем жизни
+ * @param nargs Количество аргументов
+ * @param format Строка формата со статическим временем жизни
+ */
+void deferred_log_write(esp_log_level_t level, const char *tag, uint32_t nargs, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief Последние записи буфера (включая уже выведенные)
+ * @param records Буфер (DEFERRED_LOG_RING_SIZE записей)
+ * @return Количество записей, от старых к новым
+ */
+size_t deferred_log_get_recent(deferred_log_record_t *records);
+
+/**
+ * @brief Вывод записи в строку (как при отложенном выводе)
+ * @param record Запись
+ * @param buf Буфер
+ * @param size Размер буфера
+ */
+void deferred_log_format(const deferred_log_record_t *record, char *buf, size_t size);
+
+/**
+ * @brief Получение статистики журнала
+ * @param stats Буфер для статистики
+ */
+void deferred_log_get_stats(deferred_log_stats_t *stats);
+
+#endif // DEFERRED_LOG_H
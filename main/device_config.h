@@ -6,7 +6,7 @@
  * Устройство: ESP32-C6 Zigbee Router
  * Функции: 
  * - Zigbee Router (ретрансляция сигналов)
- * - Управление двумя реле
+ * - Управление реле (каналы - RELAY_CHANNEL_TABLE)
  * - Кнопка для пэйринга
  * - Индикаторы состояния
  */
@@ -15,6 +15,8 @@
  #define DEVICE_CONFIG_H
  
  #include "driver/gpio.h"
+ #include "freertos/FreeRTOS.h"
+ #include "button_fsm.h"
  
  /* GPIO Configuration for ESP32-C6 */
  
@@ -25,13 +27,37 @@
  /* Индикаторы состояния */
  #define STATUS_LED_GPIO              GPIO_NUM_1    // Status LED (GPIO1) - единственный индикатор
  
- /* Реле управления нагрузкой */
- #define RELAY_1_GPIO                 GPIO_NUM_19   // Relay 1 (GPIO19)
- #define RELAY_2_GPIO                 GPIO_NUM_18   // Relay 2 (GPIO18)
+ /* Кластеры канала реле сверх обязательных Basic, Identify и On/Off (сервер) */
+ #define RELAY_CLUSTER_GROUPS         (1u << 0)     // Groups (сервер)
+ #define RELAY_CLUSTER_SCENES         (1u << 1)     // Scenes (сервер), требует Groups
+ #define RELAY_CLUSTER_ON_OFF_CLIENT  (1u << 2)     // On/Off (клиент): кнопка управляет привязанными устройствами
+ #define RELAY_CLUSTERS_DEFAULT       (RELAY_CLUSTER_GROUPS | RELAY_CLUSTER_SCENES | RELAY_CLUSTER_ON_OFF_CLIENT)
+ 
+ /* Каналы реле управления нагрузкой
+  *
+  * X(номер реле, GPIO, endpoint, активный уровень, кластеры)
+  *
+  * Номера реле идут подряд с 1, endpoint - любые различные в 1..RELAY_ENDPOINT_MAX.
+  * Таблица задает инициализацию GPIO, endpoints Zigbee, диспетчеризацию
+  * команд, отчеты и хранение состояния; плата с другим числом каналов
+  * описывается только своей таблицей.
+  */
+ #define RELAY_CHANNEL_TABLE(X) \
+     X(1, GPIO_NUM_19, 1, 1, RELAY_CLUSTERS_DEFAULT) \
+     X(2, GPIO_NUM_18, 2, 1, RELAY_CLUSTERS_DEFAULT)
+ 
+ #define RELAY_CHANNEL_COUNT_ONE(num, gpio, ep, level, clusters)  + 1
+ #define RELAY_COUNT                  (0 RELAY_CHANNEL_TABLE(RELAY_CHANNEL_COUNT_ONE))  // Количество реле
+ #define RELAY_ENDPOINT_MAX           240           // Наибольший endpoint приложения
+ 
+ /* Маски реле (сцены, группы, пакетные команды) - uint8_t */
+ _Static_assert(RELAY_COUNT >= 1 && RELAY_COUNT <= 8, "relay channel table must have 1..8 channels");
  
  /* Настройки кнопки */
  #define BUTTON_DEBOUNCE_TIME_MS      50            // Время подавления дребезга (мс)
  #define BUTTON_LONG_PRESS_TIME_MS    3000          // Время длительного нажатия (мс)
+ #define BUTTON_VERY_LONG_PRESS_TIME_MS 5000        // Время очень длительного нажатия (мс)
+ #define BUTTON_EVENT_QUEUE_LEN       8             // Глубина очереди событий кнопки
  
  /* Настройки индикаторов */
  #define LED_BLINK_FAST_MS           100            // Быстрое мигание (мс)
@@ -40,6 +66,8 @@
  
  /* Zigbee Manufacturer Configuration */
  #define ZIGBEE_MANUFACTURER_CODE    0xA0FF         // Manufacturer code для manufacturer-specific атрибутов
+ #define DEVICE_MANUFACTURER         "Robo"         // ManufacturerName Basic кластера
+ #define DEVICE_MODEL                "SR2CH10A"     // ModelIdentifier Basic кластера
  
  /* Состояния устройства */
  typedef enum {
@@ -58,28 +86,94 @@
      RELAY_ON = 1                     // Реле включено
  } relay_state_t;
  
-/* Состояния индикаторов (устарело - используется новая логика в main.c) */
+ /* Источник изменения состояния реле (у каждого источника своя очередь команд) */
+ typedef enum {
+     RELAY_ORIGIN_ZIGBEE = 0,         // Команда из Zigbee сети (задача Zigbee)
+     RELAY_ORIGIN_BUTTON,             // Локальная кнопка (задача GPIO)
+     RELAY_ORIGIN_CONSOLE,            // Консоль
+     RELAY_ORIGIN_SCHEDULER,          // Локальный планировщик
+     RELAY_ORIGIN_TIMER,              // Истечение OnTime (On With Timed Off, задача Zigbee)
+     RELAY_ORIGIN_RESTORE,            // Восстановление состояния при старте
+     RELAY_ORIGIN_SCENE,              // Вызов сцены (Recall Scene, задача Zigbee)
+     RELAY_ORIGIN_MAX
+ } relay_origin_t;
+ 
+/* Описание канала реле (строка RELAY_CHANNEL_TABLE) */
+typedef struct {
+    gpio_num_t gpio;                 // Выход реле
+    uint8_t endpoint;                // Endpoint Zigbee
+    uint8_t active_level;            // Уровень GPIO включенного реле
+    uint8_t clusters;                // RELAY_CLUSTER_*
+} relay_channel_t;
+
+/* Каналы по номеру реле - 1 и номер реле по endpoint (0 - endpoint без реле), device_gpio.c */
+extern const relay_channel_t g_relay_channels[RELAY_COUNT];
+extern const uint8_t g_relay_by_endpoint[RELAY_ENDPOINT_MAX + 1];
+
+/**
+ * @brief Номер реле по endpoint
+ * @param endpoint Endpoint Zigbee
+ * @return Номер реле (1..RELAY_COUNT) или 0, если endpoint не относится к реле
+ */
+static inline uint8_t relay_channel_by_endpoint(uint8_t endpoint)
+{
+    return (endpoint <= RELAY_ENDPOINT_MAX) ? g_relay_by_endpoint[endpoint] : 0;
+}
+
+/**
+ * @brief Endpoint реле
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ */
+static inline uint8_t relay_channel_endpoint(uint8_t relay_num)
+{
+    return g_relay_channels[relay_num - 1].endpoint;
+}
+
+/**
+ * @brief Наличие кластера у канала реле
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param cluster RELAY_CLUSTER_*
+ */
+static inline bool relay_channel_has_cluster(uint8_t relay_num, uint8_t cluster)
+{
+    return (g_relay_channels[relay_num - 1].clusters & cluster) != 0;
+}
  
-/* Структура состояния устройства */
+/* Структура состояния устройства
+ *
+ * Хранится в device_gpio.c под seqlock: читатели получают согласованную
+ * копию через device_get_status() без блокировок, запись выполняется
+ * только через функции device_set_*().
+ */
 typedef struct {
     device_state_t state;            // Текущее состояние устройства
-    relay_state_t relay1_state;      // Состояние реле 1
-    relay_state_t relay2_state;      // Состояние реле 2
+    relay_state_t relay_state[RELAY_COUNT];  // Состояние реле (индекс - номер реле - 1)
     bool pairing_mode;               // Режим пэйринга
     bool factory_reset;              // Флаг полной очистки памяти
     bool button_pressed;             // Кнопка нажата
     uint32_t button_press_time;      // Время нажатия кнопки
 } device_status_t;
+
+/**
+ * @brief Состояние реле из копии состояния устройства
+ * @param status Состояние, полученное device_get_status()
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ */
+static inline relay_state_t device_relay_state(const device_status_t *status, uint8_t relay_num)
+{
+    return status->relay_state[relay_num - 1];
+}
  
 /* Функции для работы с GPIO */
 void device_gpio_init(void);
 void device_set_relay(uint8_t relay_num, relay_state_t state);
-void device_handle_button(void);
-device_status_t* device_get_status(void);
+bool device_button_wait_event(button_event_t *event, TickType_t timeout);
+void device_handle_button(const button_event_t *event);
+uint32_t device_get_status(device_status_t *status);
 void device_set_state(device_state_t state);
+void device_set_pairing_mode(bool pairing_mode, bool factory_reset);
  
  /* Функции для работы с Zigbee */
- void update_relay_zigbee_attr(uint8_t endpoint, relay_state_t state);
  void clear_zigbee_data(void);
  
  #endif // DEVICE_CONFIG_H
\ No newline at end of file
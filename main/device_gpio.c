@@ -5,33 +5,162 @@
  * 
  * Устройство: ESP32-C6 Zigbee Router
  * Функции: 
- * - Управление двумя реле
+ * - Управление реле (каналы - RELAY_CHANNEL_TABLE)
  * - Обработка кнопки для пэйринга
- * - LED управляется через отдельную задачу в main.c
+ * - LED управляется модулем led_indicator (esp_timer)
  */
 
 #include "device_config.h"
+#include "status_seqlock.h"
+#include "relay_actuator.h"
+#include "deferred_log.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/timers.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 
 static const char *TAG = "DEVICE_GPIO";
 
 /* Глобальное состояние устройства */
 static device_status_t g_device_status = {
     .state = DEVICE_STATE_INIT,
-    .relay1_state = RELAY_OFF,
-    .relay2_state = RELAY_OFF,
     .pairing_mode = false,
     .button_pressed = false,
     .button_press_time = 0
 };
 
-/* Таймер для мигания статусного LED (устарело - используется LED task) */
-static TimerHandle_t status_led_timer = NULL;
+/* Каналы реле */
+#define RELAY_CHANNEL_DESC(num, gpio_num, ep, level, cluster_mask) \
+    [(num) - 1] = { .gpio = (gpio_num), .endpoint = (ep), .active_level = (level), .clusters = (cluster_mask) },
+const relay_channel_t g_relay_channels[RELAY_COUNT] = {
+    RELAY_CHANNEL_TABLE(RELAY_CHANNEL_DESC)
+};
+
+/* Индекс endpoint -> номер реле для диспетчеризации команд за O(1) */
+#define RELAY_CHANNEL_EP_INDEX(num, gpio_num, ep, level, cluster_mask)  [(ep)] = (num),
+const uint8_t g_relay_by_endpoint[RELAY_ENDPOINT_MAX + 1] = {
+    RELAY_CHANNEL_TABLE(RELAY_CHANNEL_EP_INDEX)
+};
+
+/**
+ * @brief Уровень GPIO для состояния реле
+ */
+static inline uint32_t device_relay_level(const relay_channel_t *channel, relay_state_t state)
+{
+    return (state == RELAY_ON) ? channel->active_level : !channel->active_level;
+}
+
+/* Seqlock состояния устройства */
+static status_seqlock_t s_status_seq = STATUS_SEQLOCK_INITIALIZER;
+static portMUX_TYPE s_status_write_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Начало записи состояния устройства
+ *
+ * Писатели сериализуются критической секцией, читатели не блокируются.
+ * Внутри секции записи нельзя логировать и вызывать блокирующие функции.
+ */
+static inline void device_status_write_begin(void)
+{
+    portENTER_CRITICAL(&s_status_write_lock);
+    status_seqlock_write_begin(&s_status_seq);
+}
+
+/**
+ * @brief Завершение записи состояния устройства (публикация новой версии)
+ */
+static inline void device_status_write_end(void)
+{
+    status_seqlock_write_end(&s_status_seq);
+    portEXIT_CRITICAL(&s_status_write_lock);
+}
+
+/* Антидребезг кнопки: ISR по фронтам + one-shot esp_timer окна блокировки */
+static button_fsm_t s_button_fsm;
+static portMUX_TYPE s_button_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_button_debounce_timer = NULL;
+static QueueHandle_t s_button_queue = NULL;
+
+static inline bool button_is_pressed(void)
+{
+    return gpio_get_level(PAIRING_BUTTON_GPIO) == PAIRING_BUTTON_ACTIVE_LEVEL;
+}
+
+/**
+ * @brief Обработчик прерывания по фронту кнопки
+ *
+ * Первый фронт принимается сразу, последующие фронты дребезга
+ * игнорируются до окончания окна блокировки.
+ */
+static void IRAM_ATTR button_isr_handler(void *arg)
+{
+    button_event_t event;
+    BaseType_t higher_prio_woken = pdFALSE;
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&s_button_lock);
+    uint32_t result = button_fsm_edge(&s_button_fsm, button_is_pressed(), now_us, &event);
+    portEXIT_CRITICAL_ISR(&s_button_lock);
+
+    if (result & BUTTON_FSM_ARM_TIMER) {
+        esp_timer_start_once(s_button_debounce_timer, (uint64_t)BUTTON_DEBOUNCE_TIME_MS * 1000);
+    }
+    if (result & BUTTON_FSM_EVENT) {
+        xQueueSendFromISR(s_button_queue, &event, &higher_prio_woken);
+    }
+    portYIELD_FROM_ISR(higher_prio_woken);
+}
+
+/**
+ * @brief Окончание окна блокировки дребезга
+ *
+ * Перечитывает уровень кнопки: если за время окна кнопка сменила
+ * состояние, событие формируется здесь.
+ */
+static void button_debounce_timer_callback(void *arg)
+{
+    button_event_t event;
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_button_lock);
+    uint32_t result = button_fsm_timeout(&s_button_fsm, button_is_pressed(), now_us, &event);
+    portEXIT_CRITICAL(&s_button_lock);
+
+    if (result & BUTTON_FSM_ARM_TIMER) {
+        esp_timer_start_once(s_button_debounce_timer, (uint64_t)BUTTON_DEBOUNCE_TIME_MS * 1000);
+    }
+    if (result & BUTTON_FSM_EVENT) {
+        if (xQueueSend(s_button_queue, &event, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "Button event queue full - event dropped");
+        }
+    }
+}
+
+/**
+ * @brief Инициализация прерываний и таймера антидребезга кнопки
+ */
+static void device_button_init(void)
+{
+    s_button_queue = xQueueCreate(BUTTON_EVENT_QUEUE_LEN, sizeof(button_event_t));
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = button_debounce_timer_callback,
+        .name = "btn_debounce",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_button_debounce_timer));
 
-/* Callback функции для таймеров LED */
-static void status_led_timer_callback(TimerHandle_t xTimer);
+    button_fsm_init(&s_button_fsm, BUTTON_DEBOUNCE_TIME_MS, BUTTON_LONG_PRESS_TIME_MS,
+                    BUTTON_VERY_LONG_PRESS_TIME_MS, button_is_pressed());
+
+    /* Сервис прерываний мог установить другой компонент */
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_ERR_INVALID_STATE) {
+        ESP_ERROR_CHECK(err);
+    }
+    ESP_ERROR_CHECK(gpio_isr_handler_add(PAIRING_BUTTON_GPIO, button_isr_handler, NULL));
+}
 
 /**
  * @brief Инициализация GPIO пинов
@@ -46,103 +175,107 @@ void device_gpio_init(void)
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+        .intr_type = GPIO_INTR_ANYEDGE
     };
     gpio_config(&button_config);
+    device_button_init();
     
-    /* Конфигурация реле 1 */
-    gpio_config_t relay1_config = {
-        .pin_bit_mask = (1ULL << RELAY_1_GPIO),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
-    gpio_config(&relay1_config);
-    
-    /* Конфигурация реле 2 */
-    gpio_config_t relay2_config = {
-        .pin_bit_mask = (1ULL << RELAY_2_GPIO),
+    /* Выходы реле: уровень "выключено" задается до включения выхода,
+       чтобы реле с активным низким уровнем не щелкали при старте */
+    uint64_t relay_pins = 0;
+    for (int i = 0; i < RELAY_COUNT; i++) {
+        relay_pins |= 1ULL << g_relay_channels[i].gpio;
+        gpio_set_level(g_relay_channels[i].gpio, device_relay_level(&g_relay_channels[i], RELAY_OFF));
+    }
+    gpio_config_t relay_config = {
+        .pin_bit_mask = relay_pins,
         .mode = GPIO_MODE_OUTPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
         .intr_type = GPIO_INTR_DISABLE
     };
-    gpio_config(&relay2_config);
-    
-    /* Инициализация состояний */
-    gpio_set_level(RELAY_1_GPIO, 0);
-    gpio_set_level(RELAY_2_GPIO, 0);
-    
-    /* Создание таймера для мигания статусного LED (устарело) */
-    status_led_timer = xTimerCreate("status_led_timer", 
-                                   pdMS_TO_TICKS(100), 
-                                   pdTRUE, 
-                                   (void*)0, 
-                                   status_led_timer_callback);
+    gpio_config(&relay_config);
     
     ESP_LOGI(TAG, "Device GPIO initialized successfully");
 }
 
 /**
  * @brief Управление реле
- * @param relay_num Номер реле (1 или 2)
+ *
+ * Непосредственная запись в GPIO. Вызывается только задачей исполнителя
+ * (relay_actuator), источники команд используют relay_actuator_submit().
+ *
+ * @param relay_num Номер реле (1..RELAY_COUNT)
  * @param state Состояние реле (RELAY_ON или RELAY_OFF)
  */
 void device_set_relay(uint8_t relay_num, relay_state_t state)
 {
-    if (relay_num == 1) {
-        g_device_status.relay1_state = state;
-        gpio_set_level(RELAY_1_GPIO, state);
-        ESP_LOGI(TAG, "Relay 1 set to %s", state == RELAY_ON ? "ON" : "OFF");
-    } else if (relay_num == 2) {
-        g_device_status.relay2_state = state;
-        gpio_set_level(RELAY_2_GPIO, state);
-        ESP_LOGI(TAG, "Relay 2 set to %s", state == RELAY_ON ? "ON" : "OFF");
+    if (relay_num < 1 || relay_num > RELAY_COUNT) {
+        return;
     }
+    
+    const relay_channel_t *channel = &g_relay_channels[relay_num - 1];
+    device_status_write_begin();
+    g_device_status.relay_state[relay_num - 1] = state;
+    device_status_write_end();
+    gpio_set_level(channel->gpio, device_relay_level(channel, state));
+    DLOGI(TAG, "Relay %d set to %s", relay_num, state == RELAY_ON ? "ON" : "OFF");
 }
 
 /**
- * @brief Обработка нажатия кнопки
+ * @brief Ожидание события кнопки
+ * @param event Буфер для события
+ * @param timeout Максимальное время ожидания (тики)
+ * @return true, если событие получено
  */
-void device_handle_button(void)
+bool device_button_wait_event(button_event_t *event, TickType_t timeout)
 {
-    static bool last_button_state = true; // Кнопка активна LOW, поэтому true = не нажата
-    bool current_button_state = gpio_get_level(PAIRING_BUTTON_GPIO);
-    
-    /* Обработка нажатия кнопки */
-    if (last_button_state && !current_button_state) {
+    return xQueueReceive(s_button_queue, event, timeout) == pdTRUE;
+}
+
+/**
+ * @brief Обработка события кнопки
+ * @param event Событие от автомата антидребезга
+ */
+void device_handle_button(const button_event_t *event)
+{
+    if (event->type == BUTTON_EVENT_PRESS) {
         /* Кнопка нажата */
+        TickType_t press_time = xTaskGetTickCount();
+        device_status_write_begin();
         g_device_status.button_pressed = true;
-        g_device_status.button_press_time = xTaskGetTickCount();
+        g_device_status.button_press_time = press_time;
+        device_status_write_end();
         ESP_LOGI(TAG, "Button pressed");
+        return;
     }
-    
-    /* Обработка отпускания кнопки */
-    if (!last_button_state && current_button_state) {
-        /* Кнопка отпущена */
-        g_device_status.button_pressed = false;
-        uint32_t press_duration = xTaskGetTickCount() - g_device_status.button_press_time;
-        
-        if (press_duration < pdMS_TO_TICKS(3000)) {
-            /* Короткое нажатие - переключение реле 1 */
-            ESP_LOGD(TAG, "Short press - toggling Relay 1");
-            relay_state_t new_state = (g_device_status.relay1_state == RELAY_ON) ? RELAY_OFF : RELAY_ON;
-            device_set_relay(1, new_state);
-            /* Обновление состояния реле для LED индикации будет в main.c */
-        } else if (press_duration < pdMS_TO_TICKS(5000)) {
-            /* Длинное нажатие (3-5 сек) - режим пэйринга */
-            ESP_LOGI(TAG, "Long press - entering pairing mode");
-            g_device_status.pairing_mode = true;
-        } else {
-            /* Очень длинное нажатие (5+ сек) - полная очистка и пэйринг */
-            ESP_LOGI(TAG, "Very long press - factory reset and pairing mode");
-            g_device_status.pairing_mode = true;
-            g_device_status.factory_reset = true;
-        }
+
+    /* Кнопка отпущена */
+    device_status_write_begin();
+    g_device_status.button_pressed = false;
+    device_status_write_end();
+    ESP_LOGD(TAG, "Button released after %lu ms", (unsigned long)event->duration_ms);
+
+    switch (event->press_class) {
+    case BUTTON_PRESS_SHORT:
+        /* Короткие нажатия - жесты кнопки (gesture_map) */
+        break;
+
+    case BUTTON_PRESS_LONG:
+        /* Длинное нажатие (3-5 сек) - режим пэйринга */
+        ESP_LOGI(TAG, "Long press - entering pairing mode");
+        device_set_pairing_mode(true, false);
+        break;
+
+    case BUTTON_PRESS_VERY_LONG:
+        /* Очень длинное нажатие (5+ сек) - полная очистка и пэйринг */
+        ESP_LOGI(TAG, "Very long press - factory reset and pairing mode");
+        device_set_pairing_mode(true, true);
+        break;
+
+    default:
+        break;
     }
-    
-    last_button_state = current_button_state;
 }
 
 /**
@@ -151,25 +284,35 @@ void device_handle_button(void)
  */
 void device_set_state(device_state_t new_state)
 {
+    device_status_write_begin();
     g_device_status.state = new_state;
+    device_status_write_end();
     ESP_LOGI(TAG, "Device state changed to: %d", new_state);
 }
 
 /**
- * @brief Callback для таймера LED статуса (устарело)
+ * @brief Установка режима пэйринга
+ * @param pairing_mode Режим пэйринга
+ * @param factory_reset Флаг полной очистки памяти
  */
-static void status_led_timer_callback(TimerHandle_t xTimer)
+void device_set_pairing_mode(bool pairing_mode, bool factory_reset)
 {
-    static bool led_state = false;
-    led_state = !led_state;
-    gpio_set_level(STATUS_LED_GPIO, led_state);
+    device_status_write_begin();
+    g_device_status.pairing_mode = pairing_mode;
+    g_device_status.factory_reset = factory_reset;
+    device_status_write_end();
 }
 
 /**
- * @brief Получение текущего состояния устройства
- * @return Указатель на структуру состояния устройства
+ * @brief Получение согласованного снимка состояния устройства
+ *
+ * Читатель не блокируется: копия перечитывается, если во время
+ * копирования состояние было изменено писателем.
+ *
+ * @param status Буфер для снимка состояния
+ * @return Версия снимка (увеличивается при каждом изменении)
  */
-device_status_t* device_get_status(void)
+uint32_t device_get_status(device_status_t *status)
 {
-    return &g_device_status;
+    return status_seqlock_read(&s_status_seq, status, &g_device_status, sizeof(*status)) / 2;
 }
\ No newline at end of file
@@ -0,0 +1,371 @@
+/*
+ * Gesture Map
+ *
+ * Действия жестов кнопки (см. gesture_map.h).
+ *
+ * Таблицу пишет задача Zigbee (запись атрибутов), читает задача кнопки;
+ * распознаватель принадлежит задаче кнопки и перенастраивается ею по
+ * флагу изменения параметров.
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "relay_actuator.h"
+#include "on_off_client.h"
+#include "gesture_map.h"
+
+static const char *TAG = "GESTURE_MAP";
+
+#define GESTURE_MAP_FORMAT_VERSION  1
+
+/* Запись NVS */
+typedef struct {
+    uint8_t version;                 // Версия формата
+    uint8_t reserved;
+    uint16_t multi_click_ms;
+    uint16_t hold_ms;
+    gesture_map_entry_t map[BUTTON_GESTURE_MAX];
+} gesture_map_record_t;
+
+static const char *const s_gesture_names[BUTTON_GESTURE_MAX] = {
+    [BUTTON_GESTURE_SINGLE] = "single",
+    [BUTTON_GESTURE_DOUBLE] = "double",
+    [BUTTON_GESTURE_TRIPLE] = "triple",
+    [BUTTON_GESTURE_HOLD_START] = "hold",
+    [BUTTON_GESTURE_HOLD_RELEASE] = "release",
+};
+
+static gesture_map_record_t s_config = {
+    .version = GESTURE_MAP_FORMAT_VERSION,
+    .multi_click_ms = GESTURE_MAP_DEFAULT_MULTI_CLICK_MS,
+    .hold_ms = GESTURE_MAP_DEFAULT_HOLD_MS,
+    .map = {
+        [BUTTON_GESTURE_SINGLE] = { GESTURE_ACTION_RELAY_TOGGLE, 1 },
+        [BUTTON_GESTURE_DOUBLE] = { GESTURE_ACTION_RELAY_TOGGLE, 2 },
+    },
+};
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static atomic_bool s_config_changed;
+static button_gesture_fsm_t s_fsm;
+static uint16_t s_attr_values[BUTTON_GESTURE_MAX + 2];
+static gesture_map_stats_t s_stats;
+
+/**
+ * @brief Параметры распознавателя по таблице: ждем только назначенные жесты
+ */
+static void gesture_map_fsm_config(const gesture_map_record_t *record, button_gesture_config_t *config)
+{
+    config->multi_click_ms = record->multi_click_ms;
+    config->hold_ms = record->hold_ms;
+    config->max_clicks = 1;
+    for (int clicks = 3; clicks > 1; clicks--) {
+        if (record->map[BUTTON_GESTURE_SINGLE + clicks - 1].action != GESTURE_ACTION_NONE) {
+            config->max_clicks = (uint8_t)clicks;
+            break;
+        }
+    }
+    config->hold_enabled = record->map[BUTTON_GESTURE_HOLD_START].action != GESTURE_ACTION_NONE ||
+                           record->map[BUTTON_GESTURE_HOLD_RELEASE].action != GESTURE_ACTION_NONE;
+}
+
+/**
+ * @brief Проверка действия
+ */
+static bool gesture_map_entry_valid(const gesture_map_entry_t *entry)
+{
+    if (entry->action >= GESTURE_ACTION_MAX) {
+        return false;
+    }
+    return entry->action == GESTURE_ACTION_NONE || relay_channel_by_endpoint(entry->endpoint) != 0;
+}
+
+/**
+ * @brief Проверка записи NVS
+ */
+static bool gesture_map_record_valid(const gesture_map_record_t *record)
+{
+    if (record->version != GESTURE_MAP_FORMAT_VERSION ||
+        record->multi_click_ms < GESTURE_MAP_MIN_MS || record->multi_click_ms > GESTURE_MAP_MAX_MULTI_CLICK_MS ||
+        record->hold_ms < GESTURE_MAP_MIN_MS || record->hold_ms > GESTURE_MAP_MAX_HOLD_MS) {
+        return false;
+    }
+    for (int i = 0; i < BUTTON_GESTURE_MAX; i++) {
+        if (!gesture_map_entry_valid(&record->map[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Значения атрибутов кластера по записи
+ */
+static void gesture_map_encode(const gesture_map_record_t *record, uint16_t *values)
+{
+    for (int i = 0; i < BUTTON_GESTURE_MAX; i++) {
+        values[i] = (uint16_t)((record->map[i].action << 8) | record->map[i].endpoint);
+    }
+    values[BUTTON_GESTURE_MAX] = record->multi_click_ms;
+    values[BUTTON_GESTURE_MAX + 1] = record->hold_ms;
+}
+
+/**
+ * @brief Сохранение таблицы в NVS
+ */
+static void gesture_map_save(const gesture_map_record_t *record)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(GESTURE_MAP_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, GESTURE_MAP_NVS_KEY, record, sizeof(*record));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save gesture map: %s", esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief Загрузка таблицы из NVS
+ */
+static void gesture_map_load(void)
+{
+    gesture_map_record_t record;
+    nvs_handle_t nvs_handle;
+
+    if (nvs_open(GESTURE_MAP_NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;  // Таблица еще не сохранялась - действуют значения по умолчанию
+    }
+
+    size_t size = sizeof(record);
+    esp_err_t err = nvs_get_blob(nvs_handle, GESTURE_MAP_NVS_KEY, &record, &size);
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK || size != sizeof(record) || !gesture_map_record_valid(&record)) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Discarding saved gesture map: %s",
+                     err != ESP_OK ? esp_err_to_name(err) : "format mismatch");
+        }
+        return;
+    }
+
+    s_config = record;
+}
+
+/**
+ * @brief Новое состояние реле для действия
+ */
+static relay_state_t gesture_map_relay_state(gesture_action_t action, uint8_t relay_num)
+{
+    if (action == GESTURE_ACTION_RELAY_ON) {
+        return RELAY_ON;
+    }
+    if (action == GESTURE_ACTION_RELAY_OFF) {
+        return RELAY_OFF;
+    }
+
+    device_status_t status;
+    device_get_status(&status);
+    relay_state_t current = device_relay_state(&status, relay_num);
+    return (current == RELAY_ON) ? RELAY_OFF : RELAY_ON;
+}
+
+/**
+ * @brief Выполнение действия жеста
+ */
+static void gesture_map_execute(button_gesture_t gesture)
+{
+    portENTER_CRITICAL(&s_lock);
+    gesture_map_entry_t entry = s_config.map[gesture];
+    portEXIT_CRITICAL(&s_lock);
+
+    s_stats.gestures[gesture]++;
+    ESP_LOGD(TAG, "Gesture %s -> action %d EP%d", s_gesture_names[gesture], entry.action, entry.endpoint);
+
+    switch (entry.action) {
+    case GESTURE_ACTION_RELAY_TOGGLE:
+    case GESTURE_ACTION_RELAY_ON:
+    case GESTURE_ACTION_RELAY_OFF: {
+        uint8_t relay_num = relay_channel_by_endpoint(entry.endpoint);
+        relay_state_t state = gesture_map_relay_state(entry.action, relay_num);
+        relay_actuator_submit(RELAY_ORIGIN_BUTTON, relay_num, state);
+        /* Привязанные устройства получают то же состояние, а не Toggle,
+           чтобы не разойтись с реле после потерянного кадра */
+        on_off_client_send(entry.endpoint,
+                           state == RELAY_ON ? ESP_ZB_ZCL_CMD_ON_OFF_ON_ID : ESP_ZB_ZCL_CMD_ON_OFF_OFF_ID);
+        break;
+    }
+
+    case GESTURE_ACTION_BIND_TOGGLE:
+        on_off_client_send(entry.endpoint, ESP_ZB_ZCL_CMD_ON_OFF_TOGGLE_ID);
+        break;
+
+    case GESTURE_ACTION_BIND_ON:
+        on_off_client_send(entry.endpoint, ESP_ZB_ZCL_CMD_ON_OFF_ON_ID);
+        break;
+
+    case GESTURE_ACTION_BIND_OFF:
+        on_off_client_send(entry.endpoint, ESP_ZB_ZCL_CMD_ON_OFF_OFF_ID);
+        break;
+
+    default:
+        s_stats.unmapped++;
+        break;
+    }
+}
+
+/**
+ * @brief Применение измененных параметров к распознавателю
+ */
+static void gesture_map_apply_config(void)
+{
+    if (!atomic_exchange(&s_config_changed, false)) {
+        return;
+    }
+
+    button_gesture_config_t config;
+    portENTER_CRITICAL(&s_lock);
+    gesture_map_fsm_config(&s_config, &config);
+    portEXIT_CRITICAL(&s_lock);
+    button_gesture_configure(&s_fsm, &config);
+}
+
+esp_err_t gesture_map_init(void)
+{
+    gesture_map_load();
+
+    button_gesture_config_t config;
+    gesture_map_fsm_config(&s_config, &config);
+    button_gesture_init(&s_fsm, &config);
+
+    ESP_LOGI(TAG, "Gestures: max %d clicks%s, window %u ms", config.max_clicks,
+             config.hold_enabled ? ", hold" : "", (unsigned)config.multi_click_ms);
+    return ESP_OK;
+}
+
+void gesture_map_add_cluster(esp_zb_cluster_list_t *cluster_list)
+{
+    esp_zb_attribute_list_t *gesture_cluster = esp_zb_zcl_attr_list_create(GESTURE_MAP_CLUSTER_ID);
+
+    gesture_map_encode(&s_config, s_attr_values);
+    for (int i = 0; i < BUTTON_GESTURE_MAX; i++) {
+        esp_zb_custom_cluster_add_custom_attr(gesture_cluster, GESTURE_MAP_ATTR_ACTION_BASE + i,
+                                              ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                              &s_attr_values[i]);
+    }
+    esp_zb_custom_cluster_add_custom_attr(gesture_cluster, GESTURE_MAP_ATTR_MULTI_CLICK_MS,
+                                          ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                          &s_attr_values[BUTTON_GESTURE_MAX]);
+    esp_zb_custom_cluster_add_custom_attr(gesture_cluster, GESTURE_MAP_ATTR_HOLD_MS,
+                                          ESP_ZB_ZCL_ATTR_TYPE_U16, ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                          &s_attr_values[BUTTON_GESTURE_MAX + 1]);
+
+    esp_zb_cluster_list_add_custom_cluster(cluster_list, gesture_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE);
+}
+
+esp_err_t gesture_map_write_attr(uint16_t attr_id, uint16_t value)
+{
+    /* Индекс значения атрибута (порядок gesture_map_encode) */
+    int index;
+    if (attr_id < GESTURE_MAP_ATTR_ACTION_BASE + BUTTON_GESTURE_MAX) {
+        index = attr_id - GESTURE_MAP_ATTR_ACTION_BASE;
+    } else if (attr_id == GESTURE_MAP_ATTR_MULTI_CLICK_MS) {
+        index = BUTTON_GESTURE_MAX;
+    } else if (attr_id == GESTURE_MAP_ATTR_HOLD_MS) {
+        index = BUTTON_GESTURE_MAX + 1;
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    gesture_map_record_t record;
+    portENTER_CRITICAL(&s_lock);
+    record = s_config;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (index < BUTTON_GESTURE_MAX) {
+        record.map[index] = (gesture_map_entry_t){
+            .action = (uint8_t)(value >> 8),
+            .endpoint = (uint8_t)value,
+        };
+    } else if (index == BUTTON_GESTURE_MAX) {
+        record.multi_click_ms = value;
+    } else {
+        record.hold_ms = value;
+    }
+
+    if (!gesture_map_record_valid(&record)) {
+        /* Стек уже записал значение - возвращаем действующее */
+        uint16_t values[BUTTON_GESTURE_MAX + 2];
+        gesture_map_encode(&s_config, values);
+        esp_zb_zcl_set_attribute_val(GESTURE_MAP_ENDPOINT, GESTURE_MAP_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     attr_id, &values[index], false);
+        ESP_LOGW(TAG, "Rejected gesture map attribute 0x%04x = 0x%04x", attr_id, value);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_config = record;
+    portEXIT_CRITICAL(&s_lock);
+    atomic_store(&s_config_changed, true);
+
+    /* Настройка меняется редко - запись сразу */
+    gesture_map_save(&record);
+    ESP_LOGI(TAG, "Gesture map attribute 0x%04x = 0x%04x", attr_id, value);
+    return ESP_OK;
+}
+
+void gesture_map_handle_event(const button_event_t *event)
+{
+    gesture_map_apply_config();
+
+    button_gesture_t gesture = button_gesture_event(&s_fsm, event);
+    if (gesture != BUTTON_GESTURE_NONE) {
+        gesture_map_execute(gesture);
+    }
+}
+
+void gesture_map_poll(void)
+{
+    gesture_map_apply_config();
+
+    button_gesture_t gesture = button_gesture_timeout(&s_fsm, esp_timer_get_time());
+    if (gesture != BUTTON_GESTURE_NONE) {
+        gesture_map_execute(gesture);
+    }
+}
+
+TickType_t gesture_map_next_wait(void)
+{
+    int64_t deadline_us = button_gesture_deadline(&s_fsm);
+    if (deadline_us == BUTTON_GESTURE_NO_DEADLINE) {
+        return portMAX_DELAY;
+    }
+
+    int64_t remaining_us = deadline_us - esp_timer_get_time();
+    if (remaining_us <= 0) {
+        return 0;
+    }
+    /* Округление вверх: проснуться раньше срока бесполезно */
+    return (TickType_t)((remaining_us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000));
+}
+
+void gesture_map_get(gesture_map_entry_t *map, button_gesture_config_t *config)
+{
+    portENTER_CRITICAL(&s_lock);
+    memcpy(map, s_config.map, sizeof(s_config.map));
+    gesture_map_fsm_config(&s_config, config);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void gesture_map_get_stats(gesture_map_stats_t *stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,131 @@
+/*
+ * Gesture Map
+ *
+ * Действия жестов кнопки: таблица "жест -> действие" индексируется
+ * номером жеста, действие выполняется в задаче кнопки.
+ *
+ * Действие - переключение, включение или выключение реле (новое
+ * состояние реле отправляется и привязанным устройствам его endpoint,
+ * см. on_off_client) либо только команда привязанным устройствам
+ * endpoint без локального реле.
+ *
+ * Таблица и параметры распознавания настраиваются manufacturer-specific
+ * кластером GESTURE_MAP_CLUSTER_ID на endpoint GESTURE_MAP_ENDPOINT
+ * (атрибут на каждый жест: старший байт - действие, младший - endpoint)
+ * и сохраняются в NVS при записи атрибута. Распознаватель ждет только те
+ * жесты, для которых задано действие: без двойного и тройного клика
+ * одиночный выполняется сразу при отпускании.
+ *
+ * По умолчанию: одиночный клик переключает реле 1, двойной - реле 2.
+ */
+
+#ifndef GESTURE_MAP_H
+#define GESTURE_MAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_zigbee_core.h"
+#include "button_gesture.h"
+#include "device_config.h"
+
+#define GESTURE_MAP_NVS_NAMESPACE   "gesture_map"
+#define GESTURE_MAP_NVS_KEY         "config"
+
+#define GESTURE_MAP_ENDPOINT        relay_channel_endpoint(1)
+#define GESTURE_MAP_CLUSTER_ID      0xFC00      // Manufacturer-specific кластер настройки жестов
+
+/* Атрибуты кластера */
+#define GESTURE_MAP_ATTR_ACTION_BASE    0x0000  // + button_gesture_t: uint16 (действие << 8 | endpoint)
+#define GESTURE_MAP_ATTR_MULTI_CLICK_MS 0x0010  // uint16: окно следующего клика (мс)
+#define GESTURE_MAP_ATTR_HOLD_MS        0x0011  // uint16: порог удержания (мс)
+
+/* Параметры распознавания по умолчанию и допустимые пределы */
+#define GESTURE_MAP_DEFAULT_MULTI_CLICK_MS  350
+#define GESTURE_MAP_DEFAULT_HOLD_MS         800
+#define GESTURE_MAP_MIN_MS                  100
+#define GESTURE_MAP_MAX_MULTI_CLICK_MS      1000
+#define GESTURE_MAP_MAX_HOLD_MS             (BUTTON_LONG_PRESS_TIME_MS - 500)   // Ниже порога пэйринга
+
+/* Действие жеста */
+typedef enum {
+    GESTURE_ACTION_NONE = 0,
+    GESTURE_ACTION_RELAY_TOGGLE,     // Переключить реле (и привязанные устройства)
+    GESTURE_ACTION_RELAY_ON,         // Включить реле (и привязанные устройства)
+    GESTURE_ACTION_RELAY_OFF,        // Выключить реле (и привязанные устройства)
+    GESTURE_ACTION_BIND_TOGGLE,      // Toggle только привязанным устройствам
+    GESTURE_ACTION_BIND_ON,          // On только привязанным устройствам
+    GESTURE_ACTION_BIND_OFF,         // Off только привязанным устройствам
+    GESTURE_ACTION_MAX
+} gesture_action_t;
+
+/* Действие в таблице */
+typedef struct {
+    uint8_t action;                  // gesture_action_t
+    uint8_t endpoint;                // Endpoint реле (RELAY_CHANNEL_TABLE)
+} gesture_map_entry_t;
+
+/* Статистика */
+typedef struct {
+    uint32_t gestures[BUTTON_GESTURE_MAX];  // Распознано жестов по типам
+    uint32_t unmapped;               // Жестов без действия
+} gesture_map_stats_t;
+
+/**
+ * @brief Загрузка таблицы из NVS и инициализация распознавателя
+ *
+ * Вызывается после nvs_flash_init() и до запуска задачи кнопки.
+ *
+ * @return ESP_OK при успехе
+ */
+esp_err_t gesture_map_init(void);
+
+/**
+ * @brief Добавление кластера настройки жестов в список кластеров endpoint
+ * @param cluster_list Список кластеров endpoint GESTURE_MAP_ENDPOINT
+ */
+void gesture_map_add_cluster(esp_zb_cluster_list_t *cluster_list);
+
+/**
+ * @brief Обработка записи атрибута кластера настройки (контекст задачи Zigbee)
+ *
+ * Недопустимое значение не применяется, атрибуту возвращается текущее.
+ *
+ * @param attr_id Атрибут
+ * @param value Новое значение (uint16)
+ * @return ESP_OK или ESP_ERR_INVALID_ARG
+ */
+esp_err_t gesture_map_write_attr(uint16_t attr_id, uint16_t value);
+
+/**
+ * @brief Обработка события кнопки (задача кнопки)
+ * @param event Событие автомата антидребезга
+ */
+void gesture_map_handle_event(const button_event_t *event);
+
+/**
+ * @brief Обработка истечения срока распознавателя (задача кнопки)
+ */
+void gesture_map_poll(void);
+
+/**
+ * @brief Время до ближайшего срока распознавателя
+ * @return Тики FreeRTOS (portMAX_DELAY - срока нет)
+ */
+TickType_t gesture_map_next_wait(void);
+
+/**
+ * @brief Действия жестов и параметры распознавания (для консоли)
+ * @param map Буфер на BUTTON_GESTURE_MAX действий
+ * @param config Параметры распознавания
+ */
+void gesture_map_get(gesture_map_entry_t *map, button_gesture_config_t *config);
+
+/**
+ * @brief Получение статистики
+ * @param stats Буфер для статистики
+ */
+void gesture_map_get_stats(gesture_map_stats_t *stats);
+
+#endif // GESTURE_MAP_H
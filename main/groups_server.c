@@ -0,0 +1,599 @@
+/*
+ * Groups Server
+ *
+ * Кластер Groups и групповые On/Off на устройстве (см. groups_server.h).
+ *
+ * Таблицу меняет только задача Zigbee; снимок для записи в NVS (задача
+ * таймеров FreeRTOS) и для консоли берется в критической секции.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "zboss_api.h"
+#include "esp_zigbee_core.h"
+#include "relay_actuator.h"
+#include "on_off_server.h"
+#include "scenes_server.h"
+#include "latency_trace.h"
+#include "groups_server.h"
+
+static const char *TAG = "GROUPS";
+
+#define GROUPS_FORMAT_VERSION       1
+#define GROUPS_MERGE_US             1000000     // Окно объединения группового кадра по endpoint
+
+/* Режим доставки APS (биты 2-3 поля управления кадра APS) */
+#define GROUPS_APS_DELIVERY_MODE(fc)    (((fc) >> 2) & 0x03)
+#define GROUPS_APS_DELIVERY_GROUP       0x03
+
+/* Блоб NVS: заголовок и count записей в порядке номера группы */
+typedef struct {
+    uint8_t version;                 // Версия формата
+    uint8_t count;                   // Количество записей
+    uint8_t reserved[2];
+    groups_entry_t entries[GROUPS_TABLE_SIZE];
+} groups_record_t;
+
+/* Последний групповой On/Off (объединение повторов по endpoint) */
+typedef struct {
+    uint16_t src_addr;
+    uint8_t tsn;
+    uint16_t group_id;
+    int64_t time_us;
+} groups_last_frame_t;
+
+static groups_entry_t s_table[GROUPS_TABLE_SIZE];
+static size_t s_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TimerHandle_t s_commit_timer = NULL;
+static groups_last_frame_t s_last_frame;
+static groups_server_stats_t s_stats;
+
+/**
+ * @brief Двоичный поиск группы
+ * @param pos Позиция вставки, если группы нет (может быть NULL)
+ * @return Индекс записи или -1
+ */
+static int groups_find(uint16_t group_id, size_t *pos)
+{
+    size_t lo = 0;
+    size_t hi = s_count;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (s_table[mid].group_id == group_id) {
+            return (int)mid;
+        }
+        if (s_table[mid].group_id < group_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (pos != NULL) {
+        *pos = lo;
+    }
+    return -1;
+}
+
+/**
+ * @brief Маска реле-членов группы
+ */
+static uint8_t groups_members(uint16_t group_id)
+{
+    int index = groups_find(group_id, NULL);
+    return (index >= 0) ? s_table[index].member_mask : 0;
+}
+
+/**
+ * @brief Отложенная запись таблицы в NVS (задача таймеров FreeRTOS)
+ */
+static void groups_commit(TimerHandle_t timer)
+{
+    static groups_record_t record;
+
+    portENTER_CRITICAL(&s_lock);
+    record.version = GROUPS_FORMAT_VERSION;
+    record.count = (uint8_t)s_count;
+    memcpy(record.entries, s_table, s_count * sizeof(s_table[0]));
+    portEXIT_CRITICAL(&s_lock);
+
+    size_t size = offsetof(groups_record_t, entries) + record.count * sizeof(record.entries[0]);
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(GROUPS_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, GROUPS_NVS_KEY, &record, size);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (err != ESP_OK) {
+        s_stats.nvs_errors++;
+        ESP_LOGW(TAG, "Failed to save group table: %s", esp_err_to_name(err));
+        return;
+    }
+    s_stats.nvs_writes++;
+}
+
+/**
+ * @brief Загрузка таблицы из NVS
+ */
+static void groups_load(void)
+{
+    static groups_record_t record;
+    nvs_handle_t nvs_handle;
+
+    if (nvs_open(GROUPS_NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;  // Таблица еще не сохранялась
+    }
+
+    size_t size = sizeof(record);
+    esp_err_t err = nvs_get_blob(nvs_handle, GROUPS_NVS_KEY, &record, &size);
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK || size < offsetof(groups_record_t, entries) ||
+        record.version != GROUPS_FORMAT_VERSION || record.count > GROUPS_TABLE_SIZE ||
+        size != offsetof(groups_record_t, entries) + record.count * sizeof(record.entries[0])) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Discarding saved group table: %s",
+                     err != ESP_OK ? esp_err_to_name(err) : "format mismatch");
+        }
+        return;
+    }
+
+    /* Порядок групп проверяется - на нем держится двоичный поиск */
+    uint8_t valid_mask = (1u << RELAY_COUNT) - 1;
+    for (size_t i = 0; i < record.count; i++) {
+        const groups_entry_t *entry = &record.entries[i];
+        if (entry->member_mask == 0 || (entry->member_mask & ~valid_mask) != 0 ||
+            (i > 0 && entry->group_id <= record.entries[i - 1].group_id)) {
+            ESP_LOGW(TAG, "Discarding saved group table: invalid entries");
+            return;
+        }
+    }
+
+    memcpy(s_table, record.entries, record.count * sizeof(record.entries[0]));
+    s_count = record.count;
+    ESP_LOGI(TAG, "Loaded %d groups", (int)s_count);
+}
+
+/**
+ * @brief Подтверждение изменения таблицы групп APS
+ */
+static void groups_aps_confirm(zb_uint8_t bufid)
+{
+    zb_apsme_add_group_conf_t *conf = ZB_BUF_GET_PARAM(bufid, zb_apsme_add_group_conf_t);
+    if (conf->status != RET_OK) {
+        s_stats.aps_errors++;
+        ESP_LOGW(TAG, "APS group 0x%04x EP%d update failed: %d", conf->group_address, conf->endpoint,
+                 (int)conf->status);
+    }
+    zb_buf_free(bufid);
+}
+
+/**
+ * @brief Добавление (удаление) endpoint в таблице групп APS стека
+ */
+static void groups_aps_update(uint16_t group_id, uint8_t endpoint, bool add)
+{
+    zb_bufid_t bufid = zb_buf_get_out();
+    if (bufid == ZB_BUF_INVALID) {
+        s_stats.aps_errors++;
+        ESP_LOGW(TAG, "No buffer for APS group 0x%04x EP%d", group_id, endpoint);
+        return;
+    }
+
+    zb_apsme_add_group_req_t *req = ZB_BUF_GET_PARAM(bufid, zb_apsme_add_group_req_t);
+    req->group_address = group_id;
+    req->endpoint = endpoint;
+    req->confirm_cb = groups_aps_confirm;
+
+    if (add) {
+        zb_zdo_add_group_req(bufid);
+    } else {
+        zb_zdo_remove_group_req(bufid);
+    }
+}
+
+/**
+ * @brief Назначение отложенной записи таблицы
+ */
+static void groups_schedule_commit(void)
+{
+    xTimerReset(s_commit_timer, 0);
+}
+
+/**
+ * @brief Добавление endpoint реле в группу
+ * @return Статус команды
+ */
+static zb_zcl_status_t groups_add(uint16_t group_id, uint8_t relay_num)
+{
+    uint8_t endpoint = relay_channel_endpoint(relay_num);
+    uint8_t bit = 1u << (relay_num - 1);
+    size_t pos = 0;
+    int index = groups_find(group_id, &pos);
+
+    if (index >= 0 && (s_table[index].member_mask & bit)) {
+        return ZB_ZCL_STATUS_DUPE_EXISTS;
+    }
+
+    if (index >= 0) {
+        portENTER_CRITICAL(&s_lock);
+        s_table[index].member_mask |= bit;
+        portEXIT_CRITICAL(&s_lock);
+    } else {
+        if (s_count >= GROUPS_TABLE_SIZE) {
+            s_stats.table_full++;
+            return ZB_ZCL_STATUS_INSUFF_SPACE;
+        }
+        portENTER_CRITICAL(&s_lock);
+        memmove(&s_table[pos + 1], &s_table[pos], (s_count - pos) * sizeof(s_table[0]));
+        s_table[pos] = (groups_entry_t){ .group_id = group_id, .member_mask = bit };
+        s_count++;
+        portEXIT_CRITICAL(&s_lock);
+    }
+
+    groups_aps_update(group_id, endpoint, true);
+    groups_schedule_commit();
+    s_stats.added++;
+    ESP_LOGI(TAG, "EP%d added to group 0x%04x", endpoint, group_id);
+    return ZB_ZCL_STATUS_SUCCESS;
+}
+
+/**
+ * @brief Удаление endpoints из группы по индексу записи (со сценами группы)
+ * @return true - запись удалена из таблицы
+ */
+static bool groups_remove_at(size_t index, uint8_t relay_mask)
+{
+    uint16_t group_id = s_table[index].group_id;
+    uint8_t removed = s_table[index].member_mask & relay_mask;
+    bool dropped = false;
+
+    portENTER_CRITICAL(&s_lock);
+    s_table[index].member_mask &= ~relay_mask;
+    if (s_table[index].member_mask == 0) {
+        memmove(&s_table[index], &s_table[index + 1], (s_count - index - 1) * sizeof(s_table[0]));
+        s_count--;
+        dropped = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        if (removed & (1u << (relay_num - 1))) {
+            groups_aps_update(group_id, relay_channel_endpoint(relay_num), false);
+            s_stats.removed++;
+        }
+    }
+    scenes_server_remove_group(group_id, removed);
+    groups_schedule_commit();
+    return dropped;
+}
+
+/**
+ * @brief Групповые On/Off/Toggle: все реле-члены группы одной пачкой
+ * @return true - кадр обработан (или это повтор уже выполненного)
+ */
+static bool groups_on_off(uint8_t bufid, const zb_zcl_parsed_hdr_t *cmd_info)
+{
+    uint16_t group_id = ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).dst_addr;
+    uint8_t members = groups_members(group_id);
+    if (members == 0) {
+        return false;  // Группа известна только стеку - обычная обработка
+    }
+
+    uint16_t src_addr = ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).source.u.short_addr;
+    int64_t now_us = esp_timer_get_time();
+    if (s_last_frame.src_addr == src_addr && s_last_frame.tsn == cmd_info->seq_number &&
+        s_last_frame.group_id == group_id && now_us - s_last_frame.time_us < GROUPS_MERGE_US) {
+        /* Тот же кадр на следующем endpoint - реле уже переключены */
+        s_stats.groupcast_merged++;
+        zb_buf_free(bufid);
+        return true;
+    }
+
+    uint8_t state_mask = 0;
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        uint8_t bit = 1u << (relay_num - 1);
+        if ((members & bit) == 0) {
+            continue;
+        }
+
+        bool on = (cmd_info->cmd_id == ESP_ZB_ZCL_CMD_ON_OFF_ON_ID);
+        if (cmd_info->cmd_id == ESP_ZB_ZCL_CMD_ON_OFF_TOGGLE_ID) {
+            esp_zb_zcl_attr_t *attr = esp_zb_zcl_get_attribute(relay_channel_endpoint(relay_num),
+                                                               ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+                                                               ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                                               ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID);
+            on = !(attr != NULL && attr->data_p != NULL && *(bool *)attr->data_p);
+        }
+        if (on) {
+            state_mask |= bit;
+        }
+        latency_trace_rx(relay_num, now_us);
+    }
+
+    /* Источник ZIGBEE, как у одиночной команды: атрибут меняется здесь, отчет не нужен */
+    relay_actuator_submit_batch(RELAY_ORIGIN_ZIGBEE, members, state_mask);
+
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        uint8_t bit = 1u << (relay_num - 1);
+        if (members & bit) {
+            bool on = (state_mask & bit) != 0;
+            esp_zb_zcl_set_attribute_val(relay_channel_endpoint(relay_num), ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+                                         ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &on, false);
+            on_off_server_state_changed(relay_num, on);
+        }
+    }
+
+    s_last_frame = (groups_last_frame_t){
+        .src_addr = src_addr,
+        .tsn = cmd_info->seq_number,
+        .group_id = group_id,
+        .time_us = now_us,
+    };
+    s_stats.groupcast++;
+    ESP_LOGD(TAG, "Group 0x%04x command 0x%02x: relays 0x%02x -> 0x%02x", group_id, cmd_info->cmd_id,
+             members, state_mask);
+
+    /* Ответы на групповые команды не отправляются */
+    zb_buf_free(bufid);
+    return true;
+}
+
+/**
+ * @brief Отправка ответа кластера Groups отправителю команды (буфер команды переиспользуется)
+ */
+static void groups_send_response(uint8_t bufid, const zb_zcl_parsed_hdr_t *cmd_info,
+                                 const uint8_t *payload, size_t length)
+{
+    zb_uint16_t dst_addr = ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).source.u.short_addr;
+    zb_uint8_t *ptr = ZB_ZCL_START_PACKET(bufid);
+
+    ZB_ZCL_CONSTRUCT_SPECIFIC_COMMAND_RES_FRAME_CONTROL(ptr);
+    ZB_ZCL_CONSTRUCT_COMMAND_HEADER(ptr, cmd_info->seq_number, cmd_info->cmd_id);
+    memcpy(ptr, payload, length);
+    ptr += length;
+
+    ZB_ZCL_FINISH_N_SEND_PACKET(bufid, ptr, dst_addr, ZB_APS_ADDR_MODE_16_ENDP_PRESENT,
+                                ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).src_endpoint,
+                                ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).dst_endpoint,
+                                cmd_info->profile_id, ZB_ZCL_CLUSTER_ID_GROUPS, NULL);
+}
+
+/**
+ * @brief Endpoint в режиме идентификации (IdentifyTime > 0)
+ */
+static bool groups_identifying(uint8_t endpoint)
+{
+    esp_zb_zcl_attr_t *attr = esp_zb_zcl_get_attribute(endpoint, ESP_ZB_ZCL_CLUSTER_ID_IDENTIFY,
+                                                       ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                                       ESP_ZB_ZCL_ATTR_IDENTIFY_IDENTIFY_TIME_ID);
+    return attr != NULL && attr->data_p != NULL && *(uint16_t *)attr->data_p != 0;
+}
+
+esp_err_t groups_server_init(void)
+{
+    if (s_commit_timer != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    groups_load();
+
+    s_commit_timer = xTimerCreate("groups", pdMS_TO_TICKS(GROUPS_COMMIT_MS), pdFALSE, NULL, groups_commit);
+    if (s_commit_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create commit timer");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void groups_server_sync_aps(void)
+{
+    if (esp_zb_bdb_is_factory_new()) {
+        /* Новая сеть - группы прежней сети (и их сцены) больше не действуют */
+        if (s_count > 0) {
+            ESP_LOGI(TAG, "Factory new stack - dropping %d groups", (int)s_count);
+            while (s_count > 0) {
+                groups_remove_at(s_count - 1, s_table[s_count - 1].member_mask);
+            }
+        }
+        return;
+    }
+
+    int added = 0;
+    for (size_t i = 0; i < s_count; i++) {
+        for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+            uint8_t endpoint = relay_channel_endpoint(relay_num);
+            if ((s_table[i].member_mask & (1u << (relay_num - 1))) &&
+                !zb_aps_is_endpoint_in_group(s_table[i].group_id, endpoint)) {
+                groups_aps_update(s_table[i].group_id, endpoint, true);
+                added++;
+            }
+        }
+    }
+    ESP_LOGI(TAG, "%d groups, %d memberships restored to APS table", (int)s_count, added);
+}
+
+bool groups_server_raw_command_handler(uint8_t bufid)
+{
+    zb_zcl_parsed_hdr_t cmd_info;
+    ZB_ZCL_COPY_PARSED_HEADER(bufid, &cmd_info);
+
+    uint8_t endpoint = ZB_ZCL_PARSED_HDR_SHORT_DATA(&cmd_info).dst_endpoint;
+    uint8_t relay_num = relay_channel_by_endpoint(endpoint);
+    if (relay_num == 0 || cmd_info.is_common_command || cmd_info.is_manuf_specific ||
+        cmd_info.cmd_direction != ZB_ZCL_FRAME_DIRECTION_TO_SRV) {
+        return false;
+    }
+
+    bool groupcast = GROUPS_APS_DELIVERY_MODE(ZB_ZCL_PARSED_HDR_SHORT_DATA(&cmd_info).fc) == GROUPS_APS_DELIVERY_GROUP;
+    if (cmd_info.cluster_id == ESP_ZB_ZCL_CLUSTER_ID_ON_OFF) {
+        if (!groupcast || cmd_info.cmd_id > ESP_ZB_ZCL_CMD_ON_OFF_TOGGLE_ID) {
+            return false;
+        }
+        return groups_on_off(bufid, &cmd_info);
+    }
+    if (cmd_info.cluster_id != ESP_ZB_ZCL_CLUSTER_ID_GROUPS ||
+        !relay_channel_has_cluster(relay_num, RELAY_CLUSTER_GROUPS)) {
+        return false;
+    }
+
+    const uint8_t *payload = (const uint8_t *)zb_buf_begin(bufid);
+    size_t length = zb_buf_len(bufid);
+    uint16_t group_id = (length >= 2) ? (uint16_t)(payload[0] | (payload[1] << 8)) : 0;
+    uint8_t bit = 1u << (relay_num - 1);
+    uint8_t status = ZB_ZCL_STATUS_SUCCESS;
+
+    /* Ответ: status, group(2)[, пустое имя]; Get Group Membership - свой формат */
+    uint8_t response[3 + GROUPS_TABLE_SIZE * 2];
+    size_t response_length = 3;
+
+    switch (cmd_info.cmd_id) {
+    case ESP_ZB_ZCL_CMD_GROUPS_ADD_GROUP:
+    case ESP_ZB_ZCL_CMD_GROUPS_ADD_GROUP_IF_IDENTIFYING:
+        /* group(2) name(1 + n), имя не хранится */
+        if (length < 3) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+        if (group_id == 0 || group_id > 0xfff7) {
+            status = ZB_ZCL_STATUS_INVALID_VALUE;
+        } else if (cmd_info.cmd_id == ESP_ZB_ZCL_CMD_GROUPS_ADD_GROUP_IF_IDENTIFYING) {
+            if (groups_identifying(endpoint)) {
+                status = groups_add(group_id, relay_num);
+            }
+            /* Add Group If Identifying - без ответа кластера */
+            zb_zcl_send_default_handler(bufid, &cmd_info,
+                                        status == ZB_ZCL_STATUS_DUPE_EXISTS ? ZB_ZCL_STATUS_SUCCESS : status);
+            return true;
+        } else {
+            status = groups_add(group_id, relay_num);
+        }
+        break;
+
+    case ESP_ZB_ZCL_CMD_GROUPS_VIEW_GROUP:
+        if (length < 2) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+        if (group_id == 0 || group_id > 0xfff7) {
+            status = ZB_ZCL_STATUS_INVALID_VALUE;
+        } else if ((groups_members(group_id) & bit) == 0) {
+            status = ZB_ZCL_STATUS_NOT_FOUND;
+        } else {
+            response[response_length++] = 0;  // Пустое имя
+        }
+        break;
+
+    case ESP_ZB_ZCL_CMD_GROUPS_GET_GROUP_MEMBERSHIP: {
+        /* count(1) {group(2)}* */
+        if (length < 1 || length < 1u + payload[0] * 2u) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+
+        /* capacity(1), count(1), {group(2)}* */
+        uint8_t requested = payload[0];
+        uint8_t count = 0;
+        response_length = 2;
+        for (size_t i = 0; i < s_count; i++) {
+            if ((s_table[i].member_mask & bit) == 0) {
+                continue;
+            }
+            bool match = (requested == 0);
+            for (uint8_t j = 0; j < requested && !match; j++) {
+                match = (payload[1 + j * 2] | (payload[2 + j * 2] << 8)) == s_table[i].group_id;
+            }
+            if (match) {
+                response[response_length++] = (uint8_t)s_table[i].group_id;
+                response[response_length++] = (uint8_t)(s_table[i].group_id >> 8);
+                count++;
+            }
+        }
+
+        /* Без совпадений на запрос со списком групп ответ не отправляется */
+        if (groupcast || (requested != 0 && count == 0)) {
+            zb_buf_free(bufid);
+            return true;
+        }
+        response[0] = (uint8_t)(GROUPS_TABLE_SIZE - s_count);
+        response[1] = count;
+        groups_send_response(bufid, &cmd_info, response, response_length);
+        return true;
+    }
+
+    case ESP_ZB_ZCL_CMD_GROUPS_REMOVE_GROUP: {
+        if (length < 2) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+        int index = groups_find(group_id, NULL);
+        if (group_id == 0 || group_id > 0xfff7) {
+            status = ZB_ZCL_STATUS_INVALID_VALUE;
+        } else if (index < 0 || (s_table[index].member_mask & bit) == 0) {
+            status = ZB_ZCL_STATUS_NOT_FOUND;
+        } else {
+            groups_remove_at((size_t)index, bit);
+            ESP_LOGI(TAG, "EP%d removed from group 0x%04x", endpoint, group_id);
+        }
+        break;
+    }
+
+    case ESP_ZB_ZCL_CMD_GROUPS_REMOVE_ALL_GROUPS:
+        for (size_t i = s_count; i > 0; i--) {
+            if (s_table[i - 1].member_mask & bit) {
+                groups_remove_at(i - 1, bit);
+            }
+        }
+        ESP_LOGI(TAG, "EP%d removed from all groups", endpoint);
+        zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_SUCCESS);
+        return true;
+
+    default:
+        zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_UNSUP_CLUST_CMD);
+        return true;
+    }
+
+    /* Ответы кластера Groups отправляются только на одиночные запросы */
+    if (groupcast) {
+        zb_buf_free(bufid);
+        return true;
+    }
+    response[0] = status;
+    response[1] = (uint8_t)group_id;
+    response[2] = (uint8_t)(group_id >> 8);
+    groups_send_response(bufid, &cmd_info, response, response_length);
+    return true;
+}
+
+bool groups_server_is_member(uint16_t group_id, uint8_t relay_num)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool member = (groups_members(group_id) & (1u << (relay_num - 1))) != 0;
+    portEXIT_CRITICAL(&s_lock);
+    return member;
+}
+
+size_t groups_server_get_table(groups_entry_t *entries)
+{
+    portENTER_CRITICAL(&s_lock);
+    size_t count = s_count;
+    memcpy(entries, s_table, count * sizeof(s_table[0]));
+    portEXIT_CRITICAL(&s_lock);
+    return count;
+}
+
+void groups_server_get_stats(groups_server_stats_t *stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,107 @@
+/*
+ * Groups Server
+ *
+ * Кластер Groups (0x0004) на endpoint реле: Add, View, Get Group
+ * Membership, Remove, Remove All и Add Group If Identifying выполняются
+ * по собственной таблице членства.
+ *
+ * Таблица общая для всех endpoint: запись на группу хранит маску
+ * endpoint-членов, записи отсортированы по номеру группы, поиск -
+ * двоичный. Таблица сохраняется в NVS одним блобом через GROUPS_COMMIT_MS
+ * после последнего изменения и переносится в таблицу групп APS стека
+ * (по которой стек принимает групповые кадры) после подключения к сети.
+ * Если стек стартует без сети (factory new), таблица прежней сети
+ * очищается.
+ *
+ * Групповые On/Off, On и Toggle приходят на каждый endpoint группы
+ * отдельно. Первый из них по маске группы переключает все реле-члены
+ * одной пачкой команд исполнителю (один проход задачи исполнителя),
+ * повтор того же кадра (адрес и TSN отправителя) на следующем endpoint
+ * отбрасывается. Toggle берет состояние каждого реле из атрибута OnOff.
+ *
+ * Удаление endpoint из группы удаляет и его сцены этой группы.
+ * Ответы отправляются только на одиночные (unicast) запросы; имена групп
+ * не поддерживаются (NameSupport = 0).
+ *
+ * Все функции, кроме groups_server_get_table/get_stats/is_member,
+ * вызываются только из контекста задачи Zigbee.
+ */
+
+#ifndef GROUPS_SERVER_H
+#define GROUPS_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "device_config.h"
+
+#define GROUPS_NVS_NAMESPACE        "groups"
+#define GROUPS_NVS_KEY              "table"
+
+#define GROUPS_TABLE_SIZE           16      // Емкость таблицы групп (на все endpoint)
+#define GROUPS_COMMIT_MS            1000    // Задержка записи таблицы после последнего изменения
+
+/* Запись таблицы групп (формат хранения в NVS) */
+typedef struct {
+    uint16_t group_id;               // Группа
+    uint8_t member_mask;             // Endpoint-члены группы (бит 0 - реле 1)
+    uint8_t reserved;
+} groups_entry_t;
+
+/* Статистика */
+typedef struct {
+    uint32_t added;                  // Добавлено endpoint в группы
+    uint32_t removed;                // Удалено endpoint из групп
+    uint32_t table_full;             // Отказов из-за заполненной таблицы
+    uint32_t groupcast;              // Групповых On/Off/Toggle, выполненных одной пачкой
+    uint32_t groupcast_merged;       // Повторов группового кадра на следующем endpoint
+    uint32_t aps_errors;             // Ошибок обновления таблицы групп APS
+    uint32_t nvs_writes;             // Записей таблицы в NVS
+    uint32_t nvs_errors;             // Ошибок записи
+} groups_server_stats_t;
+
+/**
+ * @brief Загрузка таблицы из NVS
+ *
+ * Вызывается после nvs_flash_init().
+ *
+ * @return ESP_OK при успехе
+ */
+esp_err_t groups_server_init(void);
+
+/**
+ * @brief Перенос таблицы в таблицу групп APS стека
+ *
+ * Вызывается при старте стека и после подключения к сети.
+ * Для factory new стека таблица очищается (группы прежней сети).
+ */
+void groups_server_sync_aps(void);
+
+/**
+ * @brief Обработчик raw-команд ZCL: кластер Groups и групповые On/Off/Toggle
+ * @param bufid Буфер команды
+ * @return true - команда обработана
+ */
+bool groups_server_raw_command_handler(uint8_t bufid);
+
+/**
+ * @brief Endpoint - член группы (двоичный поиск)
+ * @param group_id Группа
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ */
+bool groups_server_is_member(uint16_t group_id, uint8_t relay_num);
+
+/**
+ * @brief Копия таблицы групп (для консоли)
+ * @param entries Буфер на GROUPS_TABLE_SIZE записей
+ * @return Количество записей
+ */
+size_t groups_server_get_table(groups_entry_t *entries);
+
+/**
+ * @brief Получение статистики
+ * @param stats Буфер для статистики
+ */
+void groups_server_get_stats(groups_server_stats_t *stats);
+
+#endif // GROUPS_SERVER_H
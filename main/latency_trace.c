@@ -0,0 +1,363 @@
+/*
+ * Latency Trace
+ *
+ * Сквозная трассировка команд реле (см. latency_trace.h).
+ *
+ * Этапы отмечаются из разных задач (Zigbee, исполнитель реле, задача
+ * отчетов), поэтому состояние трасс защищено короткой критической секцией.
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "latency_trace.h"
+
+static const char *TAG = "LATENCY";
+
+/* Открытая трасса реле */
+typedef struct {
+    bool active;
+    latency_trace_record_t record;
+} latency_trace_slot_t;
+
+static latency_trace_slot_t s_slots[RELAY_COUNT];
+static latency_trace_stats_t s_stats;
+static latency_trace_record_t s_history[LATENCY_TRACE_HISTORY];
+static size_t s_history_head = 0;        // Позиция следующей записи
+static size_t s_history_count = 0;
+static portMUX_TYPE s_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Значения атрибутов диагностики (octet string, хранятся в атрибутах ZCL) */
+static uint8_t s_attr_values[LATENCY_SPAN_MAX][LATENCY_TRACE_ATTR_SIZE];
+
+/**
+ * @brief Номер корзины для интервала (floor(log2))
+ */
+static int latency_trace_bucket(uint32_t us)
+{
+    int bucket = 0;
+
+    while (us > 1 && bucket < LATENCY_TRACE_HIST_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Слот трассы реле (NULL для неверного номера)
+ */
+static latency_trace_slot_t *latency_trace_slot(uint8_t relay_num)
+{
+    if (relay_num < 1 || relay_num > RELAY_COUNT) {
+        return NULL;
+    }
+    return &s_slots[relay_num - 1];
+}
+
+/**
+ * @brief Учет интервала между двумя этапами (вызывается под s_trace_lock)
+ */
+static void latency_trace_account(latency_span_t span, int64_t from_us, int64_t to_us)
+{
+    if (from_us == 0 || to_us == 0 || to_us < from_us) {
+        return;
+    }
+
+    uint32_t us = (uint32_t)(to_us - from_us);
+    s_stats.hist[span][latency_trace_bucket(us)]++;
+    if (us > s_stats.max_us[span]) {
+        s_stats.max_us[span] = us;
+    }
+}
+
+/**
+ * @brief Открытие трассы (вызывается под s_trace_lock)
+ */
+static void latency_trace_open(latency_trace_slot_t *slot, uint8_t relay_num, relay_origin_t origin)
+{
+    if (slot->active) {
+        s_stats.abandoned++;
+    }
+
+    memset(&slot->record, 0, sizeof(slot->record));
+    slot->record.relay_num = relay_num;
+    slot->record.origin = origin;
+    slot->active = true;
+    s_stats.started++;
+}
+
+/**
+ * @brief Перенос трассы в историю и закрытие слота (вызывается под s_trace_lock)
+ */
+static void latency_trace_close(latency_trace_slot_t *slot)
+{
+    s_history[s_history_head] = slot->record;
+    s_history_head = (s_history_head + 1) % LATENCY_TRACE_HISTORY;
+    if (s_history_count < LATENCY_TRACE_HISTORY) {
+        s_history_count++;
+    }
+    slot->active = false;
+}
+
+/**
+ * @brief Завершение трассы (вызывается под s_trace_lock)
+ */
+static void latency_trace_complete(latency_trace_slot_t *slot)
+{
+    const int64_t *stage_us = slot->record.stage_us;
+    int64_t first_us = 0;
+    int64_t last_us = 0;
+
+    latency_trace_account(LATENCY_SPAN_RX_TO_GPIO, stage_us[LATENCY_STAGE_RX], stage_us[LATENCY_STAGE_GPIO]);
+    latency_trace_account(LATENCY_SPAN_GPIO_TO_REPORT, stage_us[LATENCY_STAGE_GPIO], stage_us[LATENCY_STAGE_REPORT]);
+    latency_trace_account(LATENCY_SPAN_REPORT_TO_CONFIRM, stage_us[LATENCY_STAGE_REPORT],
+                          stage_us[LATENCY_STAGE_CONFIRM]);
+
+    for (int i = 0; i < LATENCY_STAGE_MAX; i++) {
+        if (stage_us[i] != 0) {
+            if (first_us == 0) {
+                first_us = stage_us[i];
+            }
+            last_us = stage_us[i];
+        }
+    }
+    if (last_us != first_us) {
+        latency_trace_account(LATENCY_SPAN_TOTAL, first_us, last_us);
+    }
+
+    s_stats.completed++;
+    latency_trace_close(slot);
+}
+
+void latency_trace_rx(uint8_t relay_num, int64_t timestamp_us)
+{
+    latency_trace_slot_t *slot = latency_trace_slot(relay_num);
+
+    if (slot == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_trace_lock);
+    latency_trace_open(slot, relay_num, RELAY_ORIGIN_ZIGBEE);
+    slot->record.stage_us[LATENCY_STAGE_RX] = timestamp_us;
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+void latency_trace_gpio(uint8_t relay_num, relay_origin_t origin, int64_t timestamp_us)
+{
+    latency_trace_slot_t *slot = latency_trace_slot(relay_num);
+
+    if (slot == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_trace_lock);
+    if (origin == RELAY_ORIGIN_ZIGBEE) {
+        /* Команда из сети: отчет обратно не отправляется - трасса завершена */
+        if (slot->active && slot->record.stage_us[LATENCY_STAGE_RX] != 0 &&
+            slot->record.stage_us[LATENCY_STAGE_GPIO] == 0) {
+            slot->record.stage_us[LATENCY_STAGE_GPIO] = timestamp_us;
+            latency_trace_complete(slot);
+        }
+    } else {
+        latency_trace_open(slot, relay_num, origin);
+        slot->record.stage_us[LATENCY_STAGE_GPIO] = timestamp_us;
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+void latency_trace_noop(uint8_t relay_num, relay_origin_t origin, int64_t timestamp_us)
+{
+    latency_trace_slot_t *slot = latency_trace_slot(relay_num);
+
+    /* Трассы других источников открываются только событием шины */
+    if (slot == NULL || origin != RELAY_ORIGIN_ZIGBEE) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_trace_lock);
+    if (slot->active && slot->record.stage_us[LATENCY_STAGE_RX] != 0 &&
+        slot->record.stage_us[LATENCY_STAGE_GPIO] == 0) {
+        slot->record.stage_us[LATENCY_STAGE_GPIO] = timestamp_us;
+        slot->record.noop = true;
+        s_stats.noop++;
+        latency_trace_close(slot);
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+void latency_trace_report(uint8_t relay_num, bool ok, uint8_t tsn)
+{
+    latency_trace_slot_t *slot = latency_trace_slot(relay_num);
+    int64_t now_us = esp_timer_get_time();
+
+    if (slot == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_trace_lock);
+    if (slot->active && slot->record.stage_us[LATENCY_STAGE_GPIO] != 0 &&
+        slot->record.stage_us[LATENCY_STAGE_REPORT] == 0) {
+        slot->record.stage_us[LATENCY_STAGE_REPORT] = now_us;
+        slot->record.tsn = tsn;
+        if (!ok) {
+            slot->record.failed = true;
+            s_stats.failed++;
+            latency_trace_complete(slot);
+        }
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+void latency_trace_report_delegated(uint8_t relay_num)
+{
+    latency_trace_slot_t *slot = latency_trace_slot(relay_num);
+
+    if (slot == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_trace_lock);
+    if (slot->active && slot->record.stage_us[LATENCY_STAGE_GPIO] != 0 &&
+        slot->record.stage_us[LATENCY_STAGE_REPORT] == 0) {
+        latency_trace_complete(slot);
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+void latency_trace_send_status_cb(esp_zb_zcl_command_send_status_message_t message)
+{
+    /* Реле по endpoint-источнику отчета, сам отчет - по TSN */
+    latency_trace_slot_t *slot = latency_trace_slot(relay_channel_by_endpoint(message.src_endpoint));
+    int64_t now_us = esp_timer_get_time();
+
+    if (slot == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_trace_lock);
+    if (slot->active && slot->record.stage_us[LATENCY_STAGE_REPORT] != 0 && slot->record.tsn == message.tsn) {
+        slot->record.stage_us[LATENCY_STAGE_CONFIRM] = now_us;
+        if (message.status != ESP_OK) {
+            slot->record.failed = true;
+            s_stats.failed++;
+        }
+        latency_trace_complete(slot);
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+void latency_trace_get_stats(latency_trace_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_trace_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+size_t latency_trace_get_history(latency_trace_record_t *records)
+{
+    size_t count;
+
+    portENTER_CRITICAL(&s_trace_lock);
+    count = s_history_count;
+    for (size_t i = 0; i < count; i++) {
+        size_t index = (s_history_head + LATENCY_TRACE_HISTORY - 1 - i) % LATENCY_TRACE_HISTORY;
+        records[i] = s_history[index];
+    }
+    portEXIT_CRITICAL(&s_trace_lock);
+    return count;
+}
+
+void latency_trace_reset(void)
+{
+    portENTER_CRITICAL(&s_trace_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    memset(s_slots, 0, sizeof(s_slots));
+    s_history_head = 0;
+    s_history_count = 0;
+    portEXIT_CRITICAL(&s_trace_lock);
+}
+
+const char *latency_trace_span_to_string(latency_span_t span)
+{
+    switch (span) {
+    case LATENCY_SPAN_RX_TO_GPIO:
+        return "rx->gpio";
+    case LATENCY_SPAN_GPIO_TO_REPORT:
+        return "gpio->report";
+    case LATENCY_SPAN_REPORT_TO_CONFIRM:
+        return "report->confirm";
+    case LATENCY_SPAN_TOTAL:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * @brief Сборка значений атрибутов из гистограмм (один снимок статистики)
+ */
+static void latency_trace_encode(void)
+{
+    latency_trace_stats_t stats;
+    latency_trace_get_stats(&stats);
+
+    for (int span = 0; span < LATENCY_SPAN_MAX; span++) {
+        uint8_t *value = s_attr_values[span];
+
+        value[0] = LATENCY_TRACE_ATTR_SIZE - 1;  // Длина octet string
+        value[1] = LATENCY_TRACE_FORMAT_VERSION;
+        value[2] = span;
+        value[3] = LATENCY_TRACE_HIST_BUCKETS;
+
+        uint8_t *p = &value[4];
+        for (int i = 0; i < LATENCY_TRACE_HIST_BUCKETS; i++) {
+            uint32_t count = stats.hist[span][i];
+            uint16_t saturated = count > UINT16_MAX ? UINT16_MAX : (uint16_t)count;
+            *p++ = saturated & 0xFF;
+            *p++ = saturated >> 8;
+        }
+    }
+}
+
+esp_err_t latency_trace_add_attr(esp_zb_attribute_list_t *basic_cluster)
+{
+    latency_trace_encode();
+    for (int span = 0; span < LATENCY_SPAN_MAX; span++) {
+        esp_err_t err = esp_zb_cluster_add_manufacturer_attr(
+            basic_cluster, ESP_ZB_ZCL_CLUSTER_ID_BASIC, LATENCY_TRACE_ATTR_ID_BASE + span, ZIGBEE_MANUFACTURER_CODE,
+            ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING, ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, s_attr_values[span]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Alarm планировщика: обновление атрибутов диагностики
+ */
+static void latency_trace_publish_cb(uint8_t param)
+{
+    latency_trace_encode();
+
+    for (int span = 0; span < LATENCY_SPAN_MAX; span++) {
+        esp_zb_zcl_status_t status = esp_zb_zcl_set_manufacturer_attribute_val(
+            LATENCY_TRACE_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_BASIC, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+            ZIGBEE_MANUFACTURER_CODE, LATENCY_TRACE_ATTR_ID_BASE + span, s_attr_values[span], false);
+        if (status != ESP_ZB_ZCL_STATUS_SUCCESS) {
+            ESP_LOGW(TAG, "Failed to update latency attribute 0x%04x: 0x%02x", LATENCY_TRACE_ATTR_ID_BASE + span,
+                     status);
+        }
+    }
+
+    esp_zb_scheduler_alarm(latency_trace_publish_cb, 0, LATENCY_TRACE_PUBLISH_MS);
+}
+
+void latency_trace_start_publishing(void)
+{
+    esp_zb_scheduler_alarm_cancel(latency_trace_publish_cb, 0);
+    esp_zb_scheduler_alarm(latency_trace_publish_cb, 0, LATENCY_TRACE_PUBLISH_MS);
+}
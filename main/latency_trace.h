@@ -0,0 +1,181 @@
+/*
+ * Latency Trace
+ *
+ * Сквозная трассировка команд реле по этапам:
+ *   RX      - вход в zb_attribute_handler (команда из сети)
+ *   GPIO    - запись в GPIO исполнителем (событие шины реле)
+ *   REPORT  - запрос отчета об атрибуте задачей отчетов
+ *   CONFIRM - подтверждение отправки отчета стеком (send status)
+ *
+ * На каждое реле открыта не более чем одна трасса. Команда из сети
+ * открывает трассу на этапе RX; изменения из других источников (кнопка,
+ * консоль) - на этапе GPIO. Изменения из сети приложение не отправляет
+ * обратно отчетом (защита от зацикливания), поэтому их трасса
+ * завершается на этапе GPIO; так же завершается трасса атрибута, отчеты
+ * о котором по Configure Reporting отправляет стек. Команда из сети, не
+ * изменившая состояние реле, события шины не порождает - ее трассу
+ * закрывает исполнитель и учитывает отдельно (noop), без гистограмм.
+ * Подтверждение отправки сопоставляется с отчетом по TSN. Трасса, не
+ * дождавшаяся следующего этапа до новой команды того же реле, считается
+ * брошенной.
+ *
+ * Для каждого интервала между этапами и для полного времени ведется
+ * гистограмма в логарифмической шкале: корзина i содержит интервалы
+ * [2^i, 2^(i+1)) мкс. Последние LATENCY_TRACE_HISTORY завершенных трасс
+ * хранятся в кольцевом буфере фиксированного размера.
+ *
+ * Гистограммы публикуются как manufacturer-specific атрибуты Basic
+ * кластера endpoint реле 1, по атрибуту на интервал
+ * (LATENCY_TRACE_ATTR_ID_BASE + интервал), чтобы каждое значение
+ * помещалось в ответ Read Attributes без фрагментации. Octet string:
+ *   [0] версия формата, [1] интервал (latency_span_t), [2] количество
+ *   корзин, далее счетчики корзин (uint16 little-endian, с насыщением).
+ */
+
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+#include "device_config.h"
+
+/* Атрибуты диагностики в Basic кластере endpoint реле 1 */
+#define LATENCY_TRACE_ENDPOINT          relay_channel_endpoint(1)
+#define LATENCY_TRACE_ATTR_ID_BASE      0xF001  // 0xF001..0xF004 - интервалы по порядку latency_span_t
+#define LATENCY_TRACE_FORMAT_VERSION    2
+#define LATENCY_TRACE_PUBLISH_MS        30000   // Период обновления атрибутов
+
+#define LATENCY_TRACE_HIST_BUCKETS      20      // Последняя корзина: от 2^19 мкс (~0.5 с)
+#define LATENCY_TRACE_HISTORY           16      // Завершенных трасс в кольцевом буфере
+
+/* Этапы трассы */
+typedef enum {
+    LATENCY_STAGE_RX = 0,
+    LATENCY_STAGE_GPIO,
+    LATENCY_STAGE_REPORT,
+    LATENCY_STAGE_CONFIRM,
+    LATENCY_STAGE_MAX
+} latency_stage_t;
+
+/* Интервалы с гистограммами */
+typedef enum {
+    LATENCY_SPAN_RX_TO_GPIO = 0,     // Команда -> реле переключено
+    LATENCY_SPAN_GPIO_TO_REPORT,     // Реле переключено -> запрос отчета
+    LATENCY_SPAN_REPORT_TO_CONFIRM,  // Запрос отчета -> подтверждение отправки
+    LATENCY_SPAN_TOTAL,              // Первый этап -> последний этап
+    LATENCY_SPAN_MAX
+} latency_span_t;
+
+/* Размер значения атрибута интервала: длина + заголовок + счетчики (44 байта) */
+#define LATENCY_TRACE_ATTR_SIZE  (4 + LATENCY_TRACE_HIST_BUCKETS * sizeof(uint16_t))
+
+/* Завершенная трасса */
+typedef struct {
+    uint8_t relay_num;               // Номер реле
+    relay_origin_t origin;           // Источник изменения
+    bool failed;                     // Отправка отчета завершилась ошибкой
+    bool noop;                       // Команда не изменила состояние реле
+    uint8_t tsn;                     // TSN отчета (этап REPORT)
+    int64_t stage_us[LATENCY_STAGE_MAX];  // Время этапов (0 - этап не пройден)
+} latency_trace_record_t;
+
+/* Статистика трассировки */
+typedef struct {
+    uint32_t started;                // Открыто трасс
+    uint32_t completed;              // Завершено трасс
+    uint32_t abandoned;              // Брошено (новая команда до завершения)
+    uint32_t noop;                   // Закрыто без изменения состояния реле
+    uint32_t failed;                 // Отчетов с ошибкой отправки
+    uint32_t hist[LATENCY_SPAN_MAX][LATENCY_TRACE_HIST_BUCKETS];
+    uint32_t max_us[LATENCY_SPAN_MAX];
+} latency_trace_stats_t;
+
+/**
+ * @brief Команда из сети получена (контекст задачи Zigbee)
+ * @param relay_num Номер реле
+ * @param timestamp_us Время входа в обработчик атрибутов
+ */
+void latency_trace_rx(uint8_t relay_num, int64_t timestamp_us);
+
+/**
+ * @brief Реле переключено (подписчик шины реле)
+ * @param relay_num Номер реле
+ * @param origin Источник изменения
+ * @param timestamp_us Время записи в GPIO
+ */
+void latency_trace_gpio(uint8_t relay_num, relay_origin_t origin, int64_t timestamp_us);
+
+/**
+ * @brief Команда применена, состояние реле не изменилось (исполнитель реле)
+ *
+ * События шины нет, поэтому трасса команды из сети закрывается здесь.
+ *
+ * @param relay_num Номер реле
+ * @param origin Источник команды
+ * @param timestamp_us Время записи в GPIO
+ */
+void latency_trace_noop(uint8_t relay_num, relay_origin_t origin, int64_t timestamp_us);
+
+/**
+ * @brief Запрос отчета об атрибуте реле отправлен в стек (задача отчетов)
+ * @param relay_num Номер реле
+ * @param ok Результат esp_zb_zcl_report_attr_cmd_req
+ * @param tsn TSN отчета для сопоставления с подтверждением отправки
+ */
+void latency_trace_report(uint8_t relay_num, bool ok, uint8_t tsn);
+
+/**
+ * @brief Отчет об атрибуте реле отправит стек (Configure Reporting)
+ *
+ * Приложение отчет не запрашивает - трасса завершается на этапе GPIO.
+ *
+ * @param relay_num Номер реле
+ */
+void latency_trace_report_delegated(uint8_t relay_num);
+
+/**
+ * @brief Обработчик подтверждения отправки ZCL команды
+ *
+ * Регистрируется в стеке (esp_zb_zcl_command_send_status_handler_register).
+ */
+void latency_trace_send_status_cb(esp_zb_zcl_command_send_status_message_t message);
+
+/**
+ * @brief Получение статистики
+ * @param stats Буфер для статистики
+ */
+void latency_trace_get_stats(latency_trace_stats_t *stats);
+
+/**
+ * @brief Последние завершенные трассы
+ * @param records Буфер (LATENCY_TRACE_HISTORY записей)
+ * @return Количество записей, от новых к старым
+ */
+size_t latency_trace_get_history(latency_trace_record_t *records);
+
+/**
+ * @brief Сброс статистики и истории
+ */
+void latency_trace_reset(void);
+
+/**
+ * @brief Название интервала
+ */
+const char *latency_trace_span_to_string(latency_span_t span);
+
+/**
+ * @brief Добавление атрибутов диагностики в Basic кластер
+ * @param basic_cluster Список атрибутов Basic кластера
+ * @return ESP_OK при успехе
+ */
+esp_err_t latency_trace_add_attr(esp_zb_attribute_list_t *basic_cluster);
+
+/**
+ * @brief Запуск периодического обновления атрибутов (контекст задачи Zigbee)
+ */
+void latency_trace_start_publishing(void);
+
+#endif // LATENCY_TRACE_H
@@ -0,0 +1,110 @@
+/*
+ * Status LED Indicator
+ *
+ * Драйвер статусного LED на esp_timer (см. led_indicator.h).
+ *
+ * Все переходы секвенсора выполняются в callback таймера. Задачи,
+ * меняющие состояние, только записывают запрос и перезапускают таймер
+ * с минимальной задержкой - так секвенсор не требует блокировок между
+ * несколькими исполнителями.
+ */
+
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "device_config.h"
+#include "led_indicator.h"
+
+static const char *TAG = "LED";
+
+/* Задержка применения нового состояния (мкс) */
+#define LED_APPLY_DELAY_US      10
+
+static led_sequencer_t s_sequencer;
+static portMUX_TYPE s_sequencer_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_led_timer = NULL;
+
+/**
+ * @brief Фронт паттерна: установка уровня и взвод таймера до следующего фронта
+ */
+static void led_timer_callback(void *arg)
+{
+    uint8_t level;
+
+    portENTER_CRITICAL(&s_sequencer_lock);
+    uint32_t duration_ms = led_sequencer_next(&s_sequencer, &level);
+    portEXIT_CRITICAL(&s_sequencer_lock);
+
+    gpio_set_level(STATUS_LED_GPIO, level);
+
+    if (duration_ms > 0) {
+        esp_timer_start_once(s_led_timer, (uint64_t)duration_ms * 1000);
+    }
+}
+
+/**
+ * @brief Немедленное применение запроса (на фронте, сгенерированном сейчас)
+ */
+static void led_indicator_apply(bool changed)
+{
+    if (changed && s_led_timer != NULL) {
+        esp_timer_stop(s_led_timer);
+        esp_timer_start_once(s_led_timer, LED_APPLY_DELAY_US);
+    }
+}
+
+esp_err_t led_indicator_init(void)
+{
+    gpio_config_t led_config = {
+        .pin_bit_mask = (1ULL << STATUS_LED_GPIO),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_RETURN_ON_ERROR(gpio_config(&led_config), TAG, "Failed to configure LED GPIO");
+    gpio_set_level(STATUS_LED_GPIO, 0);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = led_timer_callback,
+        .name = "status_led",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_led_timer), TAG, "Failed to create LED timer");
+
+    led_sequencer_init(&s_sequencer, LED_STATE_OFF);
+    led_indicator_set_state(LED_STATE_INIT_GPIO);
+
+    ESP_LOGI(TAG, "Status LED initialized");
+    return ESP_OK;
+}
+
+void led_indicator_set_state(led_state_t state)
+{
+    portENTER_CRITICAL(&s_sequencer_lock);
+    led_state_t previous = s_sequencer.requested_state;
+    bool changed = led_sequencer_request(&s_sequencer, state, s_sequencer.requested_relay_active);
+    portEXIT_CRITICAL(&s_sequencer_lock);
+
+    ESP_LOGD(TAG, "LED state changed: %d -> %d", previous, state);
+    led_indicator_apply(changed);
+}
+
+led_state_t led_indicator_get_state(void)
+{
+    portENTER_CRITICAL(&s_sequencer_lock);
+    led_state_t state = s_sequencer.requested_state;
+    portEXIT_CRITICAL(&s_sequencer_lock);
+
+    return state;
+}
+
+void led_indicator_set_relay_active(bool relay_active)
+{
+    portENTER_CRITICAL(&s_sequencer_lock);
+    bool changed = led_sequencer_request(&s_sequencer, s_sequencer.requested_state, relay_active);
+    portEXIT_CRITICAL(&s_sequencer_lock);
+
+    led_indicator_apply(changed);
+}
@@ -0,0 +1,47 @@
+/*
+ * Status LED Indicator
+ *
+ * Драйвер статусного LED на esp_timer.
+ *
+ * Паттерны берутся из константной таблицы led_pattern.c. Таймер взводится
+ * только на время до следующего фронта: в состояниях с постоянным
+ * уровнем (например, "подключен") таймер не работает и CPU не
+ * просыпается. Смена состояния применяется сразу, без ожидания
+ * окончания текущего шага паттерна.
+ */
+
+#ifndef LED_INDICATOR_H
+#define LED_INDICATOR_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "led_pattern.h"
+
+/**
+ * @brief Инициализация LED и запуск стартовой индикации
+ *
+ * Стартовая индикация: "GPIO инициализирован" -> "Zigbee инициализирован"
+ * -> "поиск сети" (если за это время не запрошено другое состояние).
+ *
+ * @return ESP_OK при успехе
+ */
+esp_err_t led_indicator_init(void);
+
+/**
+ * @brief Установка состояния LED
+ * @param state Новое состояние
+ */
+void led_indicator_set_state(led_state_t state);
+
+/**
+ * @brief Текущее запрошенное состояние LED
+ */
+led_state_t led_indicator_get_state(void);
+
+/**
+ * @brief Признак включенного реле (влияет на индикацию в состоянии "подключен")
+ * @param relay_active Включено ли хотя бы одно реле
+ */
+void led_indicator_set_relay_active(bool relay_active);
+
+#endif // LED_INDICATOR_H
@@ -0,0 +1,114 @@
+/*
+ * LED Pattern Sequencer
+ *
+ * Таблица паттернов индикации и секвенсор шагов (см. led_pattern.h).
+ * Модуль не использует ESP-IDF и может собираться на хосте.
+ */
+
+#include <stddef.h>
+#include "led_pattern.h"
+
+#define LED_STEPS(...)   (const led_step_t[]){ __VA_ARGS__ }
+#define LED_STEP_COUNT(...) (sizeof((const led_step_t[]){ __VA_ARGS__ }) / sizeof(led_step_t))
+
+#define LED_PATTERN(_repeat, _next, ...)                                        \
+    {                                                                           \
+        .steps = LED_STEPS(__VA_ARGS__),                                        \
+        .step_count = LED_STEP_COUNT(__VA_ARGS__),                              \
+        .repeat = _repeat,                                                      \
+        .next_state = _next,                                                    \
+    }
+
+/* Паттерны по состояниям (тайминги соответствуют README) */
+static const led_pattern_t s_led_patterns[LED_STATE_MAX] = {
+    [LED_STATE_OFF]           = LED_PATTERN(false, LED_STATE_OFF, {0, 0}),
+    [LED_STATE_INIT_GPIO]     = LED_PATTERN(false, LED_STATE_INIT_ZIGBEE, {1, 200}, {0, 500}),
+    [LED_STATE_INIT_ZIGBEE]   = LED_PATTERN(false, LED_STATE_SEARCHING, {1, 200}, {0, 200}, {1, 200}, {0, 500}),
+    [LED_STATE_SEARCHING]     = LED_PATTERN(true, LED_STATE_SEARCHING, {1, 2000}, {0, 2000}),
+    [LED_STATE_CONNECTING]    = LED_PATTERN(true, LED_STATE_CONNECTING, {1, 500}, {0, 500}),
+    [LED_STATE_CONNECTED]     = LED_PATTERN(false, LED_STATE_CONNECTED, {1, 0}),
+    [LED_STATE_ERROR]         = LED_PATTERN(true, LED_STATE_ERROR, {1, 100}, {0, 100}),
+    [LED_STATE_PAIRING]       = LED_PATTERN(true, LED_STATE_PAIRING, {1, 5000}, {0, 1000}),
+    [LED_STATE_RELAY_ACTIVE]  = LED_PATTERN(true, LED_STATE_RELAY_ACTIVE, {1, 300}, {0, 300}),
+    [LED_STATE_FACTORY_RESET] = LED_PATTERN(true, LED_STATE_FACTORY_RESET,
+                                            {1, 150}, {0, 150}, {1, 150}, {0, 150}, {1, 150}, {0, 3050}),
+    [LED_STATE_NETWORK_LOST]  = LED_PATTERN(true, LED_STATE_NETWORK_LOST, {1, 1000}, {0, 500}, {1, 1000}, {0, 2000}),
+    [LED_STATE_REBOOTING]     = LED_PATTERN(true, LED_STATE_REBOOTING,
+                                            {1, 200}, {0, 200}, {1, 200}, {0, 200}, {1, 200}, {0, 200},
+                                            {1, 200}, {0, 200}, {1, 200}, {0, 2000}),
+};
+
+/* Подключен и хотя бы одно реле включено */
+static const led_pattern_t s_led_pattern_connected_relay_active =
+    LED_PATTERN(true, LED_STATE_CONNECTED, {1, 300}, {0, 300});
+
+const led_pattern_t *led_pattern_get(led_state_t state, bool relay_active)
+{
+    if (state >= LED_STATE_MAX) {
+        return &s_led_patterns[LED_STATE_OFF];
+    }
+    if (state == LED_STATE_CONNECTED && relay_active) {
+        return &s_led_pattern_connected_relay_active;
+    }
+    return &s_led_patterns[state];
+}
+
+void led_sequencer_init(led_sequencer_t *seq, led_state_t state)
+{
+    seq->state = LED_STATE_OFF;
+    seq->relay_active = false;
+    seq->requested_state = state;
+    seq->requested_relay_active = false;
+    seq->pattern = NULL;
+    seq->step = 0;
+}
+
+bool led_sequencer_request(led_sequencer_t *seq, led_state_t state, bool relay_active)
+{
+    seq->requested_state = state;
+    seq->requested_relay_active = relay_active;
+
+    return seq->pattern == NULL ||
+           state != seq->state ||
+           led_pattern_get(state, relay_active) != seq->pattern;
+}
+
+static void led_sequencer_enter(led_sequencer_t *seq, led_state_t state, bool relay_active)
+{
+    seq->state = state;
+    seq->relay_active = relay_active;
+    seq->requested_state = state;
+    seq->requested_relay_active = relay_active;
+    seq->pattern = led_pattern_get(state, relay_active);
+    seq->step = 0;
+}
+
+uint32_t led_sequencer_next(led_sequencer_t *seq, uint8_t *level)
+{
+    bool pattern_changed = seq->pattern == NULL ||
+                           seq->requested_state != seq->state ||
+                           led_pattern_get(seq->requested_state, seq->requested_relay_active) != seq->pattern;
+
+    /* Смена признака реле без смены паттерна не перезапускает паттерн */
+    seq->relay_active = seq->requested_relay_active;
+
+    if (pattern_changed) {
+        /* Применяем запрошенное состояние на этом фронте */
+        led_sequencer_enter(seq, seq->requested_state, seq->requested_relay_active);
+    } else if (seq->step + 1 < seq->pattern->step_count) {
+        seq->step++;
+    } else if (seq->pattern->repeat) {
+        seq->step = 0;
+    } else if (seq->pattern->next_state != seq->state) {
+        /* Однократный паттерн завершен - переход к следующему состоянию */
+        led_sequencer_enter(seq, seq->pattern->next_state, seq->relay_active);
+    } else {
+        /* Однократный паттерн без продолжения - держим последний уровень */
+        *level = seq->pattern->steps[seq->step].level;
+        return 0;
+    }
+
+    const led_step_t *step = &seq->pattern->steps[seq->step];
+    *level = step->level;
+    return step->duration_ms;
+}
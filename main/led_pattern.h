@@ -0,0 +1,97 @@
+/*
+ * LED Pattern Sequencer
+ *
+ * Табличные паттерны индикации статусного LED.
+ *
+ * Каждый паттерн - константный массив шагов (уровень + длительность).
+ * Секвенсор выдает следующий шаг на каждом фронте; шаг с нулевой
+ * длительностью означает "держать уровень" - следующего фронта нет,
+ * и CPU не просыпается, пока не изменится состояние.
+ *
+ * Модуль не зависит от ESP-IDF и FreeRTOS, поэтому тайминг любого
+ * состояния led_state_t можно проверить на хосте.
+ */
+
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Состояния LED индикатора - Комбинированная логика */
+typedef enum {
+    LED_STATE_OFF = 0,           // Выключен - устройство не инициализировано
+    LED_STATE_INIT_GPIO,         // 1 короткое мигание - GPIO инициализирован
+    LED_STATE_INIT_ZIGBEE,       // 2 коротких мигания - Zigbee инициализирован
+    LED_STATE_SEARCHING,         // Медленное мигание (2 сек) - поиск сети
+    LED_STATE_CONNECTING,        // Быстрое мигание (0.5 сек) - сеть открыта для подключения
+    LED_STATE_CONNECTED,         // Постоянно горит - подключен к сети (мигает, если реле включено)
+    LED_STATE_ERROR,             // Очень быстрое мигание (0.1 сек) - ошибка
+    LED_STATE_PAIRING,           // Длинное мигание (5 сек) - режим пэйринга
+    LED_STATE_RELAY_ACTIVE,      // Мигание при работе реле (0.3 сек)
+    LED_STATE_FACTORY_RESET,     // 3 быстрых мигания - factory reset
+    LED_STATE_NETWORK_LOST,      // 2 длинных мигания - потеря сети
+    LED_STATE_REBOOTING,         // 5 коротких миганий - перезагрузка
+    LED_STATE_MAX
+} led_state_t;
+
+/* Шаг паттерна */
+typedef struct {
+    uint8_t level;               // Уровень LED (1 = включен)
+    uint16_t duration_ms;        // Длительность шага, 0 = держать уровень бесконечно
+} led_step_t;
+
+/* Паттерн индикации */
+typedef struct {
+    const led_step_t *steps;     // Шаги паттерна
+    uint8_t step_count;          // Количество шагов
+    bool repeat;                 // Повторять паттерн по кругу
+    led_state_t next_state;      // Состояние после однократного паттерна (если != собственного)
+} led_pattern_t;
+
+/* Секвенсор */
+typedef struct {
+    led_state_t state;           // Текущее состояние
+    bool relay_active;           // Текущий признак активного реле
+    led_state_t requested_state; // Запрошенное состояние
+    bool requested_relay_active; // Запрошенный признак активного реле
+    const led_pattern_t *pattern; // Текущий паттерн
+    uint8_t step;                // Текущий шаг паттерна
+} led_sequencer_t;
+
+/**
+ * @brief Паттерн для состояния
+ * @param state Состояние LED
+ * @param relay_active Включено ли хотя бы одно реле
+ * @return Паттерн (никогда не NULL)
+ */
+const led_pattern_t *led_pattern_get(led_state_t state, bool relay_active);
+
+/**
+ * @brief Инициализация секвенсора
+ * @param seq Секвенсор
+ * @param state Начальное состояние (применяется при первом вызове led_sequencer_next)
+ */
+void led_sequencer_init(led_sequencer_t *seq, led_state_t state);
+
+/**
+ * @brief Запрос смены состояния
+ * @param seq Секвенсор
+ * @param state Новое состояние
+ * @param relay_active Включено ли хотя бы одно реле
+ * @return true, если запрос меняет отображаемый паттерн
+ */
+bool led_sequencer_request(led_sequencer_t *seq, led_state_t state, bool relay_active);
+
+/**
+ * @brief Переход к следующему шагу (вызывается на каждом фронте)
+ *
+ * Запрошенное состояние применяется на ближайшем фронте.
+ *
+ * @param seq Секвенсор
+ * @param level Уровень LED для нового шага
+ * @return Длительность шага в мс, 0 - держать уровень до следующего запроса
+ */
+uint32_t led_sequencer_next(led_sequencer_t *seq, uint8_t *level);
+
+#endif // LED_PATTERN_H
@@ -0,0 +1,203 @@
+/*
+ * On/Off Client
+ *
+ * Команды On/Off привязанным устройствам (см. on_off_client.h).
+ *
+ * Таблица отслеживания меняется задачей отправки под Zigbee lock и
+ * обработчиком подтверждений в задаче Zigbee, поэтому отдельной
+ * блокировки не требует.
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "zb_lock_profiler.h"
+#include "on_off_client.h"
+
+static const char *TAG = "ON_OFF_CLIENT";
+
+/* Команда в очереди */
+typedef struct {
+    uint8_t endpoint;
+    uint8_t cmd_id;
+    int64_t enqueue_us;
+} on_off_client_cmd_t;
+
+/* Отправленная команда, ожидающая подтверждения */
+typedef struct {
+    bool pending;
+    uint8_t tsn;
+    uint8_t endpoint;
+    int64_t enqueue_us;
+} on_off_client_track_t;
+
+static QueueHandle_t s_queue = NULL;
+static TaskHandle_t s_task = NULL;
+static on_off_client_track_t s_track[ON_OFF_CLIENT_TRACK_SIZE];
+static size_t s_track_next = 0;
+static on_off_client_stats_t s_stats;
+
+ZB_LOCK_SITE_DEFINE(s_lock_site, "on_off_client_send");
+
+/**
+ * @brief Учет команд без подтверждения дольше ON_OFF_CLIENT_CONFIRM_TIMEOUT_MS
+ */
+static void on_off_client_expire(int64_t now_us)
+{
+    for (size_t i = 0; i < ON_OFF_CLIENT_TRACK_SIZE; i++) {
+        if (s_track[i].pending &&
+            now_us - s_track[i].enqueue_us > (int64_t)ON_OFF_CLIENT_CONFIRM_TIMEOUT_MS * 1000) {
+            s_track[i].pending = false;
+            s_stats.lost++;
+        }
+    }
+}
+
+/**
+ * @brief Отправка команды по таблице привязок (под Zigbee lock)
+ */
+static void on_off_client_transmit(const on_off_client_cmd_t *cmd)
+{
+    esp_zb_zcl_on_off_cmd_t req = {
+        .zcl_basic_cmd = {
+            .src_endpoint = cmd->endpoint,
+        },
+        .address_mode = ESP_ZB_APS_ADDR_MODE_DST_ADDR_ENDP_NOT_PRESENT,
+        .on_off_cmd_id = cmd->cmd_id,
+    };
+    uint8_t tsn = esp_zb_zcl_on_off_cmd_req(&req);
+
+    /* Слот самой старой команды; неподтвержденная к этому моменту - потеряна */
+    on_off_client_track_t *track = &s_track[s_track_next];
+    s_track_next = (s_track_next + 1) % ON_OFF_CLIENT_TRACK_SIZE;
+    if (track->pending) {
+        s_stats.lost++;
+    }
+    *track = (on_off_client_track_t){
+        .pending = true,
+        .tsn = tsn,
+        .endpoint = cmd->endpoint,
+        .enqueue_us = cmd->enqueue_us,
+    };
+    s_stats.sent++;
+}
+
+/**
+ * @brief Задача отправки
+ *
+ * Спит до появления команды, затем за один захват Zigbee lock
+ * отправляет всю очередь.
+ */
+static void on_off_client_task(void *pvParameters)
+{
+    on_off_client_cmd_t cmd;
+
+    while (1) {
+        if (xQueueReceive(s_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        zb_lock_acquire(&s_lock_site, portMAX_DELAY);
+        on_off_client_expire(esp_timer_get_time());
+        bool joined = esp_zb_bdb_dev_joined();
+        int count = 0;
+        do {
+            if (!joined) {
+                s_stats.offline++;
+                continue;
+            }
+            on_off_client_transmit(&cmd);
+            count++;
+        } while (xQueueReceive(s_queue, &cmd, 0) == pdTRUE);
+        zb_lock_release(&s_lock_site);
+
+        ESP_LOGD(TAG, "Sent %d commands to bound devices%s", count, joined ? "" : " (not joined)");
+    }
+}
+
+void on_off_client_add_cluster(esp_zb_cluster_list_t *cluster_list)
+{
+    esp_zb_attribute_list_t *on_off_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF);
+    esp_zb_cluster_list_add_on_off_cluster(cluster_list, on_off_cluster, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE);
+}
+
+esp_err_t on_off_client_start(void)
+{
+    if (s_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_queue = xQueueCreate(ON_OFF_CLIENT_QUEUE_LEN, sizeof(on_off_client_cmd_t));
+    if (s_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create command queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(on_off_client_task, "OnOff_client", ON_OFF_CLIENT_TASK_STACK_SIZE,
+                    NULL, ON_OFF_CLIENT_TASK_PRIORITY, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create On/Off client task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t on_off_client_send(uint8_t endpoint, uint8_t cmd_id)
+{
+    uint8_t relay_num = relay_channel_by_endpoint(endpoint);
+    if (relay_num == 0 || !relay_channel_has_cluster(relay_num, RELAY_CLUSTER_ON_OFF_CLIENT) ||
+        cmd_id > ESP_ZB_ZCL_CMD_ON_OFF_TOGGLE_ID) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    on_off_client_cmd_t cmd = {
+        .endpoint = endpoint,
+        .cmd_id = cmd_id,
+        .enqueue_us = esp_timer_get_time(),
+    };
+    if (xQueueSend(s_queue, &cmd, 0) != pdTRUE) {
+        s_stats.dropped++;
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_stats.queued++;
+    return ESP_OK;
+}
+
+bool on_off_client_send_status_handler(const esp_zb_zcl_command_send_status_message_t *message)
+{
+    for (size_t i = 0; i < ON_OFF_CLIENT_TRACK_SIZE; i++) {
+        on_off_client_track_t *track = &s_track[i];
+        if (!track->pending || track->tsn != message->tsn || track->endpoint != message->src_endpoint) {
+            continue;
+        }
+
+        track->pending = false;
+        if (message->status != ESP_OK) {
+            s_stats.failed++;
+            ESP_LOGW(TAG, "EP%d command to bound devices failed: %s", track->endpoint,
+                     esp_err_to_name(message->status));
+            return true;
+        }
+
+        uint32_t confirm_us = (uint32_t)(esp_timer_get_time() - track->enqueue_us);
+        s_stats.confirmed++;
+        s_stats.last_confirm_us = confirm_us;
+        if (confirm_us > s_stats.max_confirm_us) {
+            s_stats.max_confirm_us = confirm_us;
+        }
+        return true;
+    }
+    return false;
+}
+
+void on_off_client_get_stats(on_off_client_stats_t *stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,87 @@
+/*
+ * On/Off Client
+ *
+ * Прямое управление привязанными устройствами: на endpoint реле
+ * добавляется клиентская роль кластера On/Off, и события кнопки
+ * отправляются командами On/Off по таблице привязок стека (режим адреса
+ * APS "без адреса" - стек сам рассылает кадр всем привязкам endpoint).
+ * Координатор в цепочке не участвует, задержка - один переход по сети.
+ *
+ * Команды ставятся в небольшую очередь из любой задачи без блокировки;
+ * задача отправки забирает всю очередь за один захват Zigbee lock.
+ * Отправленные команды отслеживаются по TSN до подтверждения отправки
+ * (esp_zb_zcl_command_send_status): фиксируются подтвержденные, ошибки,
+ * потерянные без подтверждения и время до подтверждения. Повторы
+ * выполняет APS (кадры с подтверждением), приложение команды не повторяет.
+ */
+
+#ifndef ON_OFF_CLIENT_H
+#define ON_OFF_CLIENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+#include "device_config.h"
+
+/* Параметры задачи отправки */
+#define ON_OFF_CLIENT_TASK_STACK_SIZE   2560
+#define ON_OFF_CLIENT_TASK_PRIORITY     5     // Как Zigbee: кнопка не ждет отчетов
+#define ON_OFF_CLIENT_QUEUE_LEN         8     // Очередь команд к привязанным устройствам
+#define ON_OFF_CLIENT_TRACK_SIZE        8     // Отслеживаемых команд до подтверждения
+#define ON_OFF_CLIENT_CONFIRM_TIMEOUT_MS 5000 // Команда без подтверждения считается потерянной
+
+/* Статистика */
+typedef struct {
+    uint32_t queued;                 // Поставлено в очередь
+    uint32_t dropped;                // Отброшено (очередь заполнена)
+    uint32_t offline;                // Отброшено вне сети
+    uint32_t sent;                   // Передано стеку
+    uint32_t confirmed;              // Подтверждено
+    uint32_t failed;                 // Подтверждено с ошибкой (нет привязок, нет ACK)
+    uint32_t lost;                   // Без подтверждения за ON_OFF_CLIENT_CONFIRM_TIMEOUT_MS
+    uint32_t last_confirm_us;        // От постановки в очередь до подтверждения (последняя)
+    uint32_t max_confirm_us;         // То же, максимум
+} on_off_client_stats_t;
+
+/**
+ * @brief Добавление клиентского кластера On/Off в список кластеров endpoint
+ * @param cluster_list Список кластеров endpoint реле
+ */
+void on_off_client_add_cluster(esp_zb_cluster_list_t *cluster_list);
+
+/**
+ * @brief Запуск задачи отправки
+ * @return ESP_OK при успехе
+ */
+esp_err_t on_off_client_start(void);
+
+/**
+ * @brief Постановка команды привязанным устройствам в очередь
+ *
+ * Не блокируется, может вызываться из любой задачи.
+ *
+ * @param endpoint Endpoint-источник с клиентом On/Off (его привязки получат команду)
+ * @param cmd_id Команда кластера On/Off (Off, On, Toggle)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG или ESP_ERR_NO_MEM (очередь заполнена)
+ */
+esp_err_t on_off_client_send(uint8_t endpoint, uint8_t cmd_id);
+
+/**
+ * @brief Обработка подтверждения отправки команды ZCL
+ *
+ * Вызывается из обработчика esp_zb_zcl_command_send_status (контекст
+ * задачи Zigbee).
+ *
+ * @param message Подтверждение
+ * @return true - подтверждение относится к команде клиента
+ */
+bool on_off_client_send_status_handler(const esp_zb_zcl_command_send_status_message_t *message);
+
+/**
+ * @brief Получение статистики
+ * @param stats Буфер для статистики
+ */
+void on_off_client_get_stats(on_off_client_stats_t *stats);
+
+#endif // ON_OFF_CLIENT_H
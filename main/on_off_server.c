@@ -0,0 +1,475 @@
+/*
+ * On/Off Server
+ *
+ * Расширенные команды кластера On/Off (см. on_off_server.h).
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_zigbee_core.h"
+#include "zboss_api.h"
+#include "relay_actuator.h"
+#include "latency_trace.h"
+#include "timer_wheel.h"
+#include "on_off_server.h"
+
+static const char *TAG = "ON_OFF";
+
+#define ON_OFF_SERVER_TICK_US   ((int64_t)ON_OFF_SERVER_TICK_MS * 1000)
+
+/* Варианты управления On With Timed Off */
+#define ON_OFF_CONTROL_ACCEPT_ONLY_WHEN_ON  0x01
+
+/* Состояние реле */
+typedef struct {
+    uint8_t relay_num;               // Номер реле
+    uint8_t endpoint;                // Endpoint реле
+    bool global_scene_control;       // GlobalSceneControl
+    bool global_scene_on;            // Глобальная сцена: реле включено
+    uint16_t on_time;                // OnTime без отсчета (0, ON_OFF_TIME_INFINITE или записанное при выключенном реле)
+    uint16_t off_wait_time;          // OffWaitTime без отсчета (значение на будущую паузу)
+    timer_wheel_entry_t on_timer;    // Отсчет OnTime
+    timer_wheel_entry_t off_wait_timer; // Отсчет OffWaitTime
+} on_off_channel_t;
+
+static on_off_channel_t s_channels[RELAY_COUNT];
+static timer_wheel_t s_wheel;
+static bool s_ticking = false;           // Alarm продвижения колеса назначен
+static int64_t s_next_tick_us = 0;       // Плановое время следующего тика
+static on_off_server_stats_t s_stats;
+
+/**
+ * @brief Канал по номеру реле (NULL - нет такого реле)
+ */
+static on_off_channel_t *on_off_channel(uint8_t relay_num)
+{
+    return (relay_num >= 1 && relay_num <= RELAY_COUNT) ? &s_channels[relay_num - 1] : NULL;
+}
+
+/**
+ * @brief Текущее состояние реле
+ */
+static bool on_off_relay_is_on(const on_off_channel_t *ch)
+{
+    device_status_t status;
+    device_get_status(&status);
+    return device_relay_state(&status, ch->relay_num) == RELAY_ON;
+}
+
+/**
+ * @brief Остаток OnTime
+ */
+static uint16_t on_off_on_time(const on_off_channel_t *ch)
+{
+    uint32_t remaining = timer_wheel_remaining(&s_wheel, &ch->on_timer);
+    if (remaining == 0) {
+        return ch->on_time;
+    }
+    return remaining < ON_OFF_TIME_INFINITE ? (uint16_t)remaining : ON_OFF_TIME_INFINITE - 1;
+}
+
+/**
+ * @brief Остаток защитной паузы или значение OffWaitTime
+ */
+static uint16_t on_off_off_wait_time(const on_off_channel_t *ch)
+{
+    uint32_t remaining = timer_wheel_remaining(&s_wheel, &ch->off_wait_timer);
+    if (remaining == 0) {
+        return ch->off_wait_time;
+    }
+    return remaining < ON_OFF_TIME_INFINITE ? (uint16_t)remaining : ON_OFF_TIME_INFINITE - 1;
+}
+
+/**
+ * @brief Запись атрибутов OnTime, OffWaitTime (текущий остаток отсчета)
+ */
+static void on_off_update_time_attrs(const on_off_channel_t *ch)
+{
+    uint16_t on_time = on_off_on_time(ch);
+    uint16_t off_wait_time = on_off_off_wait_time(ch);
+
+    esp_zb_zcl_set_attribute_val(ch->endpoint, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_TIME, &on_time, false);
+    esp_zb_zcl_set_attribute_val(ch->endpoint, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_ON_OFF_OFF_WAIT_TIME, &off_wait_time, false);
+}
+
+/**
+ * @brief Запись атрибутов GlobalSceneControl, OnTime, OffWaitTime
+ */
+static void on_off_update_attrs(const on_off_channel_t *ch)
+{
+    bool global_scene_control = ch->global_scene_control;
+
+    esp_zb_zcl_set_attribute_val(ch->endpoint, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_ON_OFF_GLOBAL_SCENE_CONTROL, &global_scene_control, false);
+    on_off_update_time_attrs(ch);
+}
+
+/**
+ * @brief Alarm планировщика: продвижение колеса таймеров
+ *
+ * Выполняет все тики, плановое время которых уже наступило, обновляет
+ * OnTime/OffWaitTime идущих отсчетов и назначает следующий alarm на
+ * плановое время следующего тика.
+ */
+static void on_off_tick_cb(uint8_t param)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint32_t ticks = 0;
+
+    while (s_wheel.active != 0 && now_us >= s_next_tick_us) {
+        timer_wheel_tick(&s_wheel);
+        s_next_tick_us += ON_OFF_SERVER_TICK_US;
+        ticks++;
+    }
+    if (ticks > 1) {
+        s_stats.late_ticks += ticks - 1;
+    }
+
+    /* Истекшие таймеры атрибуты уже обновили - остаток пишется для идущих */
+    for (int i = 0; ticks != 0 && i < RELAY_COUNT; i++) {
+        const on_off_channel_t *ch = &s_channels[i];
+        if (ch->on_timer.active || ch->off_wait_timer.active) {
+            on_off_update_time_attrs(ch);
+        }
+    }
+
+    if (s_wheel.active == 0) {
+        s_ticking = false;
+        return;
+    }
+
+    uint32_t delay_ms = (uint32_t)((s_next_tick_us - now_us + 999) / 1000);
+    esp_zb_scheduler_alarm(on_off_tick_cb, 0, delay_ms != 0 ? delay_ms : 1);
+}
+
+/**
+ * @brief Запуск продвижения колеса после постановки таймера
+ */
+static void on_off_ensure_ticking(void)
+{
+    if (s_ticking || s_wheel.active == 0) {
+        return;
+    }
+    s_ticking = true;
+    s_next_tick_us = esp_timer_get_time() + ON_OFF_SERVER_TICK_US;
+    esp_zb_scheduler_alarm(on_off_tick_cb, 0, ON_OFF_SERVER_TICK_MS);
+}
+
+/**
+ * @brief Установка OnTime (отсчет идет для значений 1..0xFFFE)
+ */
+static void on_off_set_on_time(on_off_channel_t *ch, uint16_t value)
+{
+    if (value == 0 || value == ON_OFF_TIME_INFINITE) {
+        timer_wheel_cancel(&s_wheel, &ch->on_timer);
+        ch->on_time = value;
+    } else {
+        ch->on_time = 0;
+        timer_wheel_schedule(&s_wheel, &ch->on_timer, value);
+        on_off_ensure_ticking();
+    }
+}
+
+/**
+ * @brief Установка OffWaitTime
+ * @param running true - реле выключено, защитная пауза идет сразу
+ */
+static void on_off_set_off_wait_time(on_off_channel_t *ch, uint16_t value, bool running)
+{
+    if (running && value != 0 && value != ON_OFF_TIME_INFINITE) {
+        ch->off_wait_time = 0;
+        timer_wheel_schedule(&s_wheel, &ch->off_wait_timer, value);
+        on_off_ensure_ticking();
+    } else {
+        timer_wheel_cancel(&s_wheel, &ch->off_wait_timer);
+        ch->off_wait_time = value;
+    }
+}
+
+/**
+ * @brief Запуск отсчета OnTime после включения (OnTime идет, пока реле включено)
+ */
+static void on_off_start_on_time(on_off_channel_t *ch)
+{
+    if (!ch->on_timer.active) {
+        on_off_set_on_time(ch, ch->on_time);
+    }
+}
+
+/**
+ * @brief Запуск защитной паузы после выключения (OffWaitTime идет, пока реле выключено)
+ */
+static void on_off_start_off_wait(on_off_channel_t *ch)
+{
+    if (!ch->off_wait_timer.active) {
+        on_off_set_off_wait_time(ch, ch->off_wait_time, true);
+    }
+}
+
+/**
+ * @brief Переключение реле и запись атрибута OnOff
+ */
+static void on_off_apply(on_off_channel_t *ch, bool on, relay_origin_t origin)
+{
+    bool value = on;
+
+    relay_actuator_submit(origin, ch->relay_num, on ? RELAY_ON : RELAY_OFF);
+    esp_zb_zcl_set_attribute_val(ch->endpoint, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &value, false);
+}
+
+/**
+ * @brief Истечение OnTime: выключение и запуск защитной паузы
+ */
+static void on_off_on_timer_expired(timer_wheel_entry_t *entry, void *arg)
+{
+    on_off_channel_t *ch = (on_off_channel_t *)arg;
+
+    s_stats.expirations++;
+    ch->on_time = 0;
+    on_off_apply(ch, false, RELAY_ORIGIN_TIMER);
+    on_off_start_off_wait(ch);
+    on_off_update_attrs(ch);
+
+    ESP_LOGI(TAG, "Relay %d timed off", ch->relay_num);
+}
+
+/**
+ * @brief Истечение защитной паузы
+ */
+static void on_off_off_wait_expired(timer_wheel_entry_t *entry, void *arg)
+{
+    on_off_channel_t *ch = (on_off_channel_t *)arg;
+
+    ch->off_wait_time = 0;
+    on_off_update_attrs(ch);
+}
+
+/**
+ * @brief Off With Effect: сохранение глобальной сцены и выключение
+ *
+ * Реле не поддерживает эффекты затухания - любой эффект выключает сразу.
+ */
+static void on_off_off_with_effect(on_off_channel_t *ch)
+{
+    s_stats.off_with_effect++;
+
+    if (ch->global_scene_control) {
+        ch->global_scene_on = on_off_relay_is_on(ch);
+        ch->global_scene_control = false;
+    }
+    on_off_set_on_time(ch, 0);
+    on_off_apply(ch, false, RELAY_ORIGIN_ZIGBEE);
+    on_off_start_off_wait(ch);
+    on_off_update_attrs(ch);
+}
+
+/**
+ * @brief On With Recall Global Scene
+ */
+static void on_off_recall_global_scene(on_off_channel_t *ch)
+{
+    s_stats.recall_global_scene++;
+
+    if (ch->global_scene_control) {
+        s_stats.recall_ignored++;
+        return;
+    }
+
+    ch->global_scene_control = true;
+    if (!ch->global_scene_on) {
+        on_off_start_off_wait(ch);
+    } else if (on_off_on_time(ch) == 0) {
+        on_off_set_off_wait_time(ch, 0, false);
+    }
+    on_off_apply(ch, ch->global_scene_on, RELAY_ORIGIN_ZIGBEE);
+    if (ch->global_scene_on) {
+        on_off_start_on_time(ch);
+    }
+    on_off_update_attrs(ch);
+}
+
+/**
+ * @brief On With Timed Off
+ */
+static void on_off_timed_off(on_off_channel_t *ch, uint8_t control, uint16_t on_time, uint16_t off_wait_time)
+{
+    bool on = on_off_relay_is_on(ch);
+
+    s_stats.timed_off++;
+
+    if ((control & ON_OFF_CONTROL_ACCEPT_ONLY_WHEN_ON) && !on) {
+        s_stats.timed_off_ignored++;
+        return;
+    }
+
+    uint16_t off_wait_now = on_off_off_wait_time(ch);
+    if (!on && off_wait_now != 0) {
+        /* Защитная пауза: команда может только сократить ее */
+        s_stats.timed_off_guarded++;
+        if (off_wait_time < off_wait_now) {
+            on_off_set_off_wait_time(ch, off_wait_time, true);
+        }
+    } else {
+        uint16_t on_now = on_off_on_time(ch);
+        on_off_set_on_time(ch, on_time > on_now ? on_time : on_now);
+        on_off_set_off_wait_time(ch, off_wait_time, false);
+        on_off_apply(ch, true, RELAY_ORIGIN_ZIGBEE);
+    }
+    on_off_update_attrs(ch);
+}
+
+void on_off_server_init(void)
+{
+    timer_wheel_init(&s_wheel);
+
+    for (int i = 0; i < RELAY_COUNT; i++) {
+        on_off_channel_t *ch = &s_channels[i];
+        memset(ch, 0, sizeof(*ch));
+        ch->relay_num = i + 1;
+        ch->endpoint = g_relay_channels[i].endpoint;
+        ch->global_scene_control = true;
+        timer_wheel_entry_init(&ch->on_timer, on_off_on_timer_expired, ch);
+        timer_wheel_entry_init(&ch->off_wait_timer, on_off_off_wait_expired, ch);
+    }
+}
+
+void on_off_server_add_attrs(esp_zb_attribute_list_t *on_off_cluster)
+{
+    bool global_scene_control = ESP_ZB_ZCL_ON_OFF_GLOBAL_SCENE_CONTROL_DEFAULT_VALUE;
+    uint16_t on_time = ESP_ZB_ZCL_ON_OFF_ON_TIME_DEFAULT_VALUE;
+    uint16_t off_wait_time = ESP_ZB_ZCL_ON_OFF_OFF_WAIT_TIME_DEFAULT_VALUE;
+
+    esp_zb_on_off_cluster_add_attr(on_off_cluster, ESP_ZB_ZCL_ATTR_ON_OFF_GLOBAL_SCENE_CONTROL, &global_scene_control);
+    esp_zb_on_off_cluster_add_attr(on_off_cluster, ESP_ZB_ZCL_ATTR_ON_OFF_ON_TIME, &on_time);
+    esp_zb_on_off_cluster_add_attr(on_off_cluster, ESP_ZB_ZCL_ATTR_ON_OFF_OFF_WAIT_TIME, &off_wait_time);
+}
+
+bool on_off_server_raw_command_handler(uint8_t bufid)
+{
+    zb_zcl_parsed_hdr_t cmd_info;
+    ZB_ZCL_COPY_PARSED_HEADER(bufid, &cmd_info);
+
+    uint8_t relay_num = relay_channel_by_endpoint(ZB_ZCL_PARSED_HDR_SHORT_DATA(&cmd_info).dst_endpoint);
+    on_off_channel_t *ch = on_off_channel(relay_num);
+    if (ch == NULL || cmd_info.cluster_id != ESP_ZB_ZCL_CLUSTER_ID_ON_OFF || cmd_info.is_common_command ||
+        cmd_info.is_manuf_specific || cmd_info.cmd_direction != ZB_ZCL_FRAME_DIRECTION_TO_SRV) {
+        return false;
+    }
+
+    const uint8_t *payload = (const uint8_t *)zb_buf_begin(bufid);
+    zb_uint_t length = zb_buf_len(bufid);
+    zb_zcl_status_t status = ZB_ZCL_STATUS_SUCCESS;
+
+    switch (cmd_info.cmd_id) {
+    case ESP_ZB_ZCL_CMD_ON_OFF_OFF_WITH_EFFECT_ID:
+        if (length < 2) {
+            status = ZB_ZCL_STATUS_MALFORMED_CMD;
+            break;
+        }
+        latency_trace_rx(ch->relay_num, esp_timer_get_time());
+        on_off_off_with_effect(ch);
+        break;
+
+    case ESP_ZB_ZCL_CMD_ON_OFF_ON_WITH_RECALL_GLOBAL_SCENE_ID:
+        latency_trace_rx(ch->relay_num, esp_timer_get_time());
+        on_off_recall_global_scene(ch);
+        break;
+
+    case ESP_ZB_ZCL_CMD_ON_OFF_ON_WITH_TIMED_OFF_ID:
+        if (length < 5) {
+            status = ZB_ZCL_STATUS_MALFORMED_CMD;
+            break;
+        }
+        latency_trace_rx(ch->relay_num, esp_timer_get_time());
+        on_off_timed_off(ch, payload[0], (uint16_t)(payload[1] | (payload[2] << 8)),
+                         (uint16_t)(payload[3] | (payload[4] << 8)));
+        break;
+
+    default:
+        return false;  // On/Off/Toggle обрабатывает стек
+    }
+
+    ESP_LOGD(TAG, "Relay %d command 0x%02x, status 0x%02x", ch->relay_num, cmd_info.cmd_id, status);
+    zb_zcl_send_default_handler(bufid, &cmd_info, status);
+    return true;
+}
+
+void on_off_server_state_changed(uint8_t relay_num, bool on)
+{
+    on_off_channel_t *ch = on_off_channel(relay_num);
+    if (ch == NULL) {
+        return;
+    }
+
+    if (on) {
+        /* On: GlobalSceneControl = TRUE, без отсчета OnTime пауза сбрасывается */
+        ch->global_scene_control = true;
+        if (on_off_on_time(ch) == 0) {
+            on_off_set_off_wait_time(ch, 0, false);
+        }
+        on_off_start_on_time(ch);
+    } else {
+        /* Off: OnTime = 0, начинается защитная пауза */
+        on_off_set_on_time(ch, 0);
+        on_off_start_off_wait(ch);
+    }
+    on_off_update_attrs(ch);
+}
+
+esp_err_t on_off_server_write_attr(uint8_t relay_num, uint16_t attr_id, uint16_t value)
+{
+    on_off_channel_t *ch = on_off_channel(relay_num);
+    if (ch == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    bool on = on_off_relay_is_on(ch);
+
+    switch (attr_id) {
+    case ESP_ZB_ZCL_ATTR_ON_OFF_ON_TIME:
+        /* Отсчет идет только при включенном реле, иначе значение ждет включения */
+        if (on) {
+            on_off_set_on_time(ch, value);
+        } else {
+            timer_wheel_cancel(&s_wheel, &ch->on_timer);
+            ch->on_time = value;
+        }
+        break;
+    case ESP_ZB_ZCL_ATTR_ON_OFF_OFF_WAIT_TIME:
+        /* Защитная пауза идет только при выключенном реле */
+        on_off_set_off_wait_time(ch, value, !on);
+        break;
+    default:
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_LOGI(TAG, "Relay %d attr 0x%04x written: %u", relay_num, attr_id, value);
+    on_off_update_attrs(ch);
+    return ESP_OK;
+}
+
+void on_off_server_get_status(uint8_t relay_num, on_off_server_status_t *status)
+{
+    memset(status, 0, sizeof(*status));
+
+    const on_off_channel_t *ch = on_off_channel(relay_num);
+    if (ch == NULL) {
+        return;
+    }
+
+    /* Чтение из другой задачи без блокировки - только для отображения */
+    status->global_scene_control = ch->global_scene_control;
+    status->global_scene_on = ch->global_scene_on;
+    status->on_time = on_off_on_time(ch);
+    status->off_wait_time = on_off_off_wait_time(ch);
+    status->off_wait_running = ch->off_wait_timer.active;
+}
+
+void on_off_server_get_stats(on_off_server_stats_t *stats)
+{
+    *stats = s_stats;
+}
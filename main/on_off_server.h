@@ -0,0 +1,118 @@
+/*
+ * On/Off Server
+ *
+ * Расширенные команды кластера On/Off на устройстве (ZCL 3.8.2.3):
+ *   Off With Effect (0x40)         - выключение с сохранением "глобальной
+ *                                    сцены" (состояния реле) и сбросом
+ *                                    GlobalSceneControl;
+ *   On With Recall Global Scene    - восстановление глобальной сцены, если
+ *   (0x41)                           GlobalSceneControl сброшен;
+ *   On With Timed Off (0x42)       - включение на OnTime с последующей
+ *                                    защитной паузой OffWaitTime
+ *                                    ("лестничный свет").
+ *
+ * Команды перехватываются обработчиком raw-команд до обработки стеком,
+ * реле переключается через исполнителя, атрибуты OnOff,
+ * GlobalSceneControl, OnTime и OffWaitTime обновляются здесь же.
+ * Простые On/Off/Toggle по-прежнему обрабатывает стек, а их влияние на
+ * OnTime/OffWaitTime применяется в on_off_server_state_changed().
+ *
+ * Отсчет OnTime и OffWaitTime (единица - 1/10 с) ведет колесо таймеров
+ * с тиком ON_OFF_SERVER_TICK_MS: постановка и отмена O(1), отдельного
+ * таймера на каждое реле нет. Колесо продвигается alarm планировщика
+ * Zigbee только пока есть активные таймеры; опоздавшие тики (занятая
+ * задача Zigbee) догоняются по esp_timer, поэтому задержка срабатывания
+ * не накапливается. Выключение по истечении OnTime выполняется с
+ * источником RELAY_ORIGIN_TIMER и отправляется в сеть отчетом.
+ *
+ * Атрибуты OnTime/OffWaitTime обновляются при каждом изменении таймеров
+ * и на каждом тике колеса, пока идет отсчет, поэтому Read Attributes
+ * возвращает текущий остаток. Запись OnTime/OffWaitTime (Write
+ * Attributes) перезапускает отсчет: OnTime идет при включенном реле,
+ * OffWaitTime - при выключенном; OnTime, записанный при выключенном
+ * реле, начинает отсчет при включении.
+ *
+ * Все функции, кроме on_off_server_get_status/get_stats, вызываются
+ * только из контекста задачи Zigbee.
+ */
+
+#ifndef ON_OFF_SERVER_H
+#define ON_OFF_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_zigbee_core.h"
+#include "device_config.h"
+
+#define ON_OFF_SERVER_TICK_MS       100     // Единица OnTime/OffWaitTime (1/10 с)
+#define ON_OFF_TIME_INFINITE        0xFFFF  // OnTime/OffWaitTime без отсчета
+
+/* Состояние реле для консоли */
+typedef struct {
+    bool global_scene_control;       // Атрибут GlobalSceneControl
+    bool global_scene_on;            // Состояние реле в глобальной сцене
+    uint16_t on_time;                // Остаток OnTime (1/10 с)
+    uint16_t off_wait_time;          // Остаток (пауза идет) или значение OffWaitTime (1/10 с)
+    bool off_wait_running;           // Идет защитная пауза
+} on_off_server_status_t;
+
+/* Статистика команд */
+typedef struct {
+    uint32_t off_with_effect;        // Принято Off With Effect
+    uint32_t recall_global_scene;    // Принято On With Recall Global Scene
+    uint32_t recall_ignored;         // Recall при установленном GlobalSceneControl (без действия)
+    uint32_t timed_off;              // Принято On With Timed Off
+    uint32_t timed_off_ignored;      // Отброшено (реле выключено и "accept only when on")
+    uint32_t timed_off_guarded;      // Пришло во время защитной паузы
+    uint32_t expirations;            // Выключений по истечении OnTime
+    uint32_t late_ticks;             // Тиков колеса, обработанных с опозданием
+} on_off_server_stats_t;
+
+/**
+ * @brief Инициализация (колесо таймеров, состояние реле)
+ */
+void on_off_server_init(void);
+
+/**
+ * @brief Добавление атрибутов GlobalSceneControl, OnTime, OffWaitTime
+ * @param on_off_cluster Список атрибутов кластера On/Off
+ */
+void on_off_server_add_attrs(esp_zb_attribute_list_t *on_off_cluster);
+
+/**
+ * @brief Обработчик raw-команд ZCL (esp_zb_raw_command_handler_register)
+ * @param bufid Буфер команды
+ * @return true - команда обработана, ответ отправлен
+ */
+bool on_off_server_raw_command_handler(uint8_t bufid);
+
+/**
+ * @brief Реле переключено стеком командой On/Off/Toggle
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param on Новое значение атрибута OnOff
+ */
+void on_off_server_state_changed(uint8_t relay_num, bool on);
+
+/**
+ * @brief Атрибут OnTime/OffWaitTime записан командой Write Attributes
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param attr_id ESP_ZB_ZCL_ATTR_ON_OFF_ON_TIME или ESP_ZB_ZCL_ATTR_ON_OFF_OFF_WAIT_TIME
+ * @param value Новое значение (1/10 с)
+ * @return ESP_OK или ESP_ERR_NOT_FOUND (не тот атрибут или реле)
+ */
+esp_err_t on_off_server_write_attr(uint8_t relay_num, uint16_t attr_id, uint16_t value);
+
+/**
+ * @brief Состояние таймеров и глобальной сцены реле
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param status Буфер для состояния
+ */
+void on_off_server_get_status(uint8_t relay_num, on_off_server_status_t *status);
+
+/**
+ * @brief Получение статистики команд
+ * @param stats Буфер для статистики
+ */
+void on_off_server_get_stats(on_off_server_stats_t *stats);
+
+#endif // ON_OFF_SERVER_H
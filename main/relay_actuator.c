@@ -0,0 +1,259 @@
+/*
+ * Relay Actuator
+ *
+ * Исполнитель команд управления реле (см. relay_actuator.h).
+ *
+ * У каждого источника команд свой кольцевой буфер SPSC: производитель
+ * пишет только tail, потребитель (задача исполнителя) - только head.
+ * Синхронизация - через атомарные индексы с семантикой acquire/release,
+ * без мьютексов и критических секций на пути Zigbee callback.
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "relay_actuator.h"
+#include "relay_event_bus.h"
+#include "latency_trace.h"
+
+static const char *TAG = "RELAY_ACT";
+
+/* Команда управления реле */
+typedef struct {
+    uint8_t relay_num;               // Номер реле (1..RELAY_COUNT)
+    relay_state_t state;             // Требуемое состояние
+    relay_origin_t origin;           // Источник команды
+    int64_t enqueue_us;              // Время постановки в очередь
+} relay_cmd_t;
+
+/* Кольцевой буфер одного источника (single-producer / single-consumer) */
+typedef struct {
+    relay_cmd_t slots[RELAY_CMD_RING_SIZE];
+    atomic_uint head;                // Пишет только потребитель
+    atomic_uint tail;                // Пишет только производитель
+    uint32_t submitted;              // Счетчики производителя
+    uint32_t dropped;
+    uint32_t depth_max;
+} relay_cmd_ring_t;
+
+static relay_cmd_ring_t s_rings[RELAY_ORIGIN_MAX];
+static TaskHandle_t s_actuator_task = NULL;
+
+/* Последнее записанное в GPIO состояние реле (пишет только задача исполнителя) */
+static relay_state_t s_relay_state[RELAY_COUNT];
+
+/* Статистика потребителя (пишет только задача исполнителя) */
+static uint32_t s_coalesced = 0;
+static uint32_t s_gpio_writes = 0;
+static uint32_t s_latency_last_us = 0;
+static uint32_t s_latency_min_us = UINT32_MAX;
+static uint32_t s_latency_max_us = 0;
+static uint64_t s_latency_sum_us = 0;
+
+_Static_assert((RELAY_CMD_RING_SIZE & (RELAY_CMD_RING_SIZE - 1)) == 0,
+               "RELAY_CMD_RING_SIZE must be a power of two");
+
+static bool relay_cmd_ring_push(relay_cmd_ring_t *ring, const relay_cmd_t *cmd)
+{
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned depth = tail - head;
+
+    if (depth >= RELAY_CMD_RING_SIZE) {
+        ring->dropped++;
+        return false;
+    }
+
+    ring->slots[tail & (RELAY_CMD_RING_SIZE - 1)] = *cmd;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    ring->submitted++;
+    if (depth + 1 > ring->depth_max) {
+        ring->depth_max = depth + 1;
+    }
+    return true;
+}
+
+static bool relay_cmd_ring_pop(relay_cmd_ring_t *ring, relay_cmd_t *cmd)
+{
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return false;
+    }
+
+    *cmd = ring->slots[head & (RELAY_CMD_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+static void relay_actuator_account_latency(int64_t enqueue_us, int64_t now_us)
+{
+    uint32_t latency_us = (uint32_t)(now_us - enqueue_us);
+
+    s_latency_last_us = latency_us;
+    s_latency_sum_us += latency_us;
+    if (latency_us < s_latency_min_us) {
+        s_latency_min_us = latency_us;
+    }
+    if (latency_us > s_latency_max_us) {
+        s_latency_max_us = latency_us;
+    }
+}
+
+/**
+ * @brief Задача исполнителя команд реле
+ *
+ * Просыпается по уведомлению от производителей, вычитывает все буферы
+ * и для каждого реле применяет только самую позднюю команду. Если
+ * состояние реле изменилось, публикует событие в шину relay_event_bus,
+ * иначе закрывает трассу задержки команды (latency_trace_noop).
+ */
+static void relay_actuator_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Starting relay actuator task...");
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        relay_cmd_t pending[RELAY_COUNT];
+        bool has_pending[RELAY_COUNT] = {0};
+        relay_cmd_t cmd;
+
+        for (int origin = 0; origin < RELAY_ORIGIN_MAX; origin++) {
+            while (relay_cmd_ring_pop(&s_rings[origin], &cmd)) {
+                uint8_t idx = cmd.relay_num - 1;
+                if (has_pending[idx]) {
+                    s_coalesced++;
+                    /* Latest-wins: между источниками побеждает более поздняя команда */
+                    if (cmd.enqueue_us < pending[idx].enqueue_us) {
+                        continue;
+                    }
+                }
+                pending[idx] = cmd;
+                has_pending[idx] = true;
+            }
+        }
+
+        for (int idx = 0; idx < RELAY_COUNT; idx++) {
+            if (!has_pending[idx]) {
+                continue;
+            }
+            device_set_relay(pending[idx].relay_num, pending[idx].state);
+            int64_t now_us = esp_timer_get_time();
+            s_gpio_writes++;
+            relay_actuator_account_latency(pending[idx].enqueue_us, now_us);
+
+            if (s_relay_state[idx] != pending[idx].state) {
+                s_relay_state[idx] = pending[idx].state;
+                relay_event_t event = {
+                    .relay_num = pending[idx].relay_num,
+                    .state = pending[idx].state,
+                    .origin = pending[idx].origin,
+                    .timestamp_us = now_us,
+                };
+                relay_event_bus_publish(&event);
+            } else {
+                /* Состояние не изменилось - события шины нет, трассу закрываем здесь */
+                latency_trace_noop(pending[idx].relay_num, pending[idx].origin, now_us);
+            }
+        }
+    }
+}
+
+esp_err_t relay_actuator_start(void)
+{
+    if (s_actuator_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (xTaskCreate(relay_actuator_task, "Relay_task", RELAY_ACTUATOR_TASK_STACK_SIZE,
+                    NULL, RELAY_ACTUATOR_TASK_PRIORITY, &s_actuator_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create relay actuator task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t relay_actuator_submit(relay_origin_t origin, uint8_t relay_num, relay_state_t state)
+{
+    if (origin >= RELAY_ORIGIN_MAX || relay_num < 1 || relay_num > RELAY_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    relay_cmd_t cmd = {
+        .relay_num = relay_num,
+        .state = state,
+        .origin = origin,
+        .enqueue_us = esp_timer_get_time(),
+    };
+
+    if (!relay_cmd_ring_push(&s_rings[origin], &cmd)) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (s_actuator_task != NULL) {
+        xTaskNotifyGive(s_actuator_task);
+    }
+    return ESP_OK;
+}
+
+esp_err_t relay_actuator_submit_batch(relay_origin_t origin, uint8_t relay_mask, uint8_t state_mask)
+{
+    if (origin >= RELAY_ORIGIN_MAX || relay_mask == 0 || (relay_mask >> RELAY_COUNT) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    int64_t enqueue_us = esp_timer_get_time();
+    for (uint8_t idx = 0; idx < RELAY_COUNT; idx++) {
+        if ((relay_mask & (1u << idx)) == 0) {
+            continue;
+        }
+        relay_cmd_t cmd = {
+            .relay_num = idx + 1,
+            .state = (state_mask & (1u << idx)) ? RELAY_ON : RELAY_OFF,
+            .origin = origin,
+            .enqueue_us = enqueue_us,
+        };
+        if (!relay_cmd_ring_push(&s_rings[origin], &cmd)) {
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+
+    /* Одно уведомление после всех команд: исполнитель (приоритет выше
+       производителей) не проснется между ними */
+    if (s_actuator_task != NULL) {
+        xTaskNotifyGive(s_actuator_task);
+    }
+    return ret;
+}
+
+void relay_actuator_get_stats(relay_actuator_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    for (int origin = 0; origin < RELAY_ORIGIN_MAX; origin++) {
+        relay_cmd_ring_t *ring = &s_rings[origin];
+        stats->submitted += ring->submitted;
+        stats->dropped += ring->dropped;
+        stats->depth += atomic_load(&ring->tail) - atomic_load(&ring->head);
+        if (ring->depth_max > stats->depth_max) {
+            stats->depth_max = ring->depth_max;
+        }
+    }
+
+    stats->coalesced = s_coalesced;
+    stats->gpio_writes = s_gpio_writes;
+    stats->latency_last_us = s_latency_last_us;
+    stats->latency_max_us = s_latency_max_us;
+    if (s_gpio_writes > 0) {
+        stats->latency_min_us = s_latency_min_us;
+        stats->latency_avg_us = (uint32_t)(s_latency_sum_us / s_gpio_writes);
+    }
+}
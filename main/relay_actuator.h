@@ -0,0 +1,78 @@
+/*
+ * Relay Actuator
+ *
+ * Задача-исполнитель команд управления реле.
+ *
+ * Источники команд (Zigbee, кнопка, консоль) не трогают GPIO напрямую,
+ * а кладут команды в собственные lock-free кольцевые буферы
+ * (один производитель / один потребитель). Высокоприоритетная задача
+ * исполнителя вычитывает все буферы, оставляет для каждого реле только
+ * последнюю команду и выполняет одну запись в GPIO на реле.
+ */
+
+#ifndef RELAY_ACTUATOR_H
+#define RELAY_ACTUATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "device_config.h"
+
+/* Параметры задачи исполнителя */
+#define RELAY_ACTUATOR_TASK_STACK_SIZE  3072
+#define RELAY_ACTUATOR_TASK_PRIORITY    6     // Выше задачи Zigbee (5)
+#define RELAY_CMD_RING_SIZE             16    // Емкость буфера одного источника (степень двойки)
+
+/* Статистика исполнителя */
+typedef struct {
+    uint32_t submitted;              // Принято команд (все источники)
+    uint32_t dropped;                // Отброшено команд (буфер переполнен)
+    uint32_t coalesced;              // Команд поглощено более поздними (latest-wins)
+    uint32_t gpio_writes;            // Выполнено записей в GPIO
+    uint32_t depth;                  // Текущая суммарная глубина буферов
+    uint32_t depth_max;              // Максимальная глубина буфера одного источника
+    uint32_t latency_last_us;        // Задержка постановка -> GPIO последней команды
+    uint32_t latency_min_us;         // Минимальная задержка
+    uint32_t latency_max_us;         // Максимальная задержка
+    uint32_t latency_avg_us;         // Средняя задержка
+} relay_actuator_stats_t;
+
+/**
+ * @brief Запуск задачи исполнителя команд реле
+ * @return ESP_OK при успехе
+ */
+esp_err_t relay_actuator_start(void);
+
+/**
+ * @brief Постановка команды управления реле в очередь
+ *
+ * Каждый источник должен вызываться только из одной задачи
+ * (буфер источника - single-producer).
+ *
+ * @param origin Источник команды
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param state Требуемое состояние реле
+ * @return ESP_OK, ESP_ERR_INVALID_ARG или ESP_ERR_NO_MEM (буфер переполнен)
+ */
+esp_err_t relay_actuator_submit(relay_origin_t origin, uint8_t relay_num, relay_state_t state);
+
+/**
+ * @brief Постановка команд для нескольких реле с одним пробуждением исполнителя
+ *
+ * Все команды получают одно время постановки и применяются исполнителем
+ * за один проход (например, вызов сцены для обоих реле).
+ *
+ * @param origin Источник команд (те же требования, что у relay_actuator_submit)
+ * @param relay_mask Маска реле (бит 0 - реле 1)
+ * @param state_mask Требуемые состояния (бит установлен - RELAY_ON)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG или ESP_ERR_NO_MEM (буфер переполнен)
+ */
+esp_err_t relay_actuator_submit_batch(relay_origin_t origin, uint8_t relay_mask, uint8_t state_mask);
+
+/**
+ * @brief Получение статистики исполнителя
+ * @param stats Буфер для статистики
+ */
+void relay_actuator_get_stats(relay_actuator_stats_t *stats);
+
+#endif // RELAY_ACTUATOR_H
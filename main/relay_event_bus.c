@@ -0,0 +1,65 @@
+/*
+ * Relay Event Bus
+ *
+ * Шина событий изменения состояния реле (см. relay_event_bus.h).
+ */
+
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "relay_event_bus.h"
+
+typedef struct {
+    relay_event_handler_t handler;
+    void *ctx;
+} relay_event_subscriber_t;
+
+static relay_event_subscriber_t s_subscribers[RELAY_EVENT_BUS_MAX_SUBSCRIBERS];
+static atomic_uint s_subscriber_count = 0;
+static portMUX_TYPE s_subscribe_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t relay_event_bus_subscribe(relay_event_handler_t handler, void *ctx)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_subscribe_lock);
+    unsigned count = atomic_load_explicit(&s_subscriber_count, memory_order_relaxed);
+    if (count < RELAY_EVENT_BUS_MAX_SUBSCRIBERS) {
+        s_subscribers[count].handler = handler;
+        s_subscribers[count].ctx = ctx;
+        /* Слот публикуется только после заполнения */
+        atomic_store_explicit(&s_subscriber_count, count + 1, memory_order_release);
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+    portEXIT_CRITICAL(&s_subscribe_lock);
+
+    return ret;
+}
+
+void relay_event_bus_publish(const relay_event_t *event)
+{
+    unsigned count = atomic_load_explicit(&s_subscriber_count, memory_order_acquire);
+
+    for (unsigned i = 0; i < count; i++) {
+        s_subscribers[i].handler(event, s_subscribers[i].ctx);
+    }
+}
+
+const char *relay_origin_to_string(relay_origin_t origin)
+{
+    static const char *const names[RELAY_ORIGIN_MAX] = {
+        [RELAY_ORIGIN_ZIGBEE]    = "zigbee",
+        [RELAY_ORIGIN_BUTTON]    = "button",
+        [RELAY_ORIGIN_CONSOLE]   = "console",
+        [RELAY_ORIGIN_SCHEDULER] = "scheduler",
+        [RELAY_ORIGIN_TIMER]     = "timer",
+        [RELAY_ORIGIN_RESTORE]   = "restore",
+        [RELAY_ORIGIN_SCENE]     = "scene",
+    };
+
+    return (origin < RELAY_ORIGIN_MAX) ? names[origin] : "unknown";
+}
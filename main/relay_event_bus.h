@@ -0,0 +1,55 @@
+/*
+ * Relay Event Bus
+ *
+ * Шина событий изменения состояния реле (publish/subscribe).
+ *
+ * Событие публикует задача исполнителя (relay_actuator) сразу после
+ * записи в GPIO. Каждое событие несет источник изменения, поэтому
+ * подписчики (отчеты в Zigbee, LED, сохранение состояния) сами решают,
+ * как на него реагировать - например, отчет не отправляется обратно в
+ * сеть для изменений, пришедших из Zigbee.
+ *
+ * Подписчики вызываются синхронно в контексте публикующей задачи и не
+ * должны блокироваться надолго.
+ */
+
+#ifndef RELAY_EVENT_BUS_H
+#define RELAY_EVENT_BUS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "device_config.h"
+
+#define RELAY_EVENT_BUS_MAX_SUBSCRIBERS  8
+
+/* Событие изменения состояния реле */
+typedef struct {
+    uint8_t relay_num;               // Номер реле (1..RELAY_COUNT)
+    relay_state_t state;             // Новое состояние
+    relay_origin_t origin;           // Источник изменения
+    int64_t timestamp_us;            // Время записи в GPIO
+} relay_event_t;
+
+/* Обработчик события */
+typedef void (*relay_event_handler_t)(const relay_event_t *event, void *ctx);
+
+/**
+ * @brief Подписка на события изменения состояния реле
+ * @param handler Обработчик
+ * @param ctx Пользовательский контекст обработчика
+ * @return ESP_OK или ESP_ERR_NO_MEM (нет свободных слотов)
+ */
+esp_err_t relay_event_bus_subscribe(relay_event_handler_t handler, void *ctx);
+
+/**
+ * @brief Публикация события всем подписчикам
+ * @param event Событие
+ */
+void relay_event_bus_publish(const relay_event_t *event);
+
+/**
+ * @brief Название источника изменения (для логов)
+ */
+const char *relay_origin_to_string(relay_origin_t origin);
+
+#endif // RELAY_EVENT_BUS_H
@@ -0,0 +1,563 @@
+/*
+ * Relay Scheduler
+ *
+ * Локальный планировщик действий над реле (см. relay_scheduler.h).
+ *
+ * Массив записей защищен мьютексом: его меняют консоль, подписчик шины
+ * (задача исполнителя) и диспетчер (задача esp_timer). Под мьютексом же
+ * перевзводится таймер диспетчера, поэтому он всегда соответствует
+ * первой записи массива. Запись в NVS и отправка команд исполнителю
+ * выполняются вне мьютекса.
+ */
+
+#include <string.h>
+#include <stddef.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "relay_actuator.h"
+#include "relay_event_bus.h"
+#include "relay_scheduler.h"
+
+static const char *TAG = "RELAY_SCHED";
+
+#define RELAY_SCHED_FORMAT_VERSION  1
+#define RELAY_SCHED_NOT_ARMED       INT64_MAX
+#define RELAY_SCHED_REARM_GUARD_US  1000000     // Минимальная задержка повторного weekly-срабатывания
+
+/* Запись массива с моментом срабатывания */
+typedef struct {
+    relay_sched_entry_t entry;
+    int64_t due_us;                  // Момент срабатывания (esp_timer) или RELAY_SCHED_NOT_ARMED
+} relay_sched_slot_t;
+
+/* Блоб NVS: заголовок и count записей, отсортированных по id */
+typedef struct {
+    uint8_t version;                 // Версия формата
+    uint8_t count;                   // Количество записей
+    uint8_t reserved[2];
+    relay_sched_entry_t entries[RELAY_SCHED_MAX_ENTRIES];
+} relay_sched_record_t;
+
+/* Действие, выполняемое диспетчером вне мьютекса */
+typedef struct {
+    uint8_t relay_num;
+    relay_state_t state;
+} relay_sched_action_t;
+
+static relay_sched_slot_t s_slots[RELAY_SCHED_MAX_ENTRIES];
+static size_t s_count = 0;
+static SemaphoreHandle_t s_mutex = NULL;
+static esp_timer_handle_t s_dispatch_timer = NULL;
+static relay_scheduler_stats_t s_stats;
+
+/**
+ * @brief Проверка записи
+ */
+static bool relay_sched_entry_valid(const relay_sched_entry_t *entry)
+{
+    if (entry->id == 0 || entry->relay_num < 1 || entry->relay_num > RELAY_COUNT ||
+        entry->state > RELAY_ON) {
+        return false;
+    }
+
+    switch (entry->type) {
+    case RELAY_SCHED_COUNTDOWN:
+    case RELAY_SCHED_INCHING:
+        return entry->duration_ms >= 1 && entry->duration_ms <= RELAY_SCHED_MAX_DURATION_MS;
+    case RELAY_SCHED_WEEKLY:
+        return entry->days != 0 && (entry->days & ~RELAY_SCHED_DAYS_ALL) == 0 && entry->minute < 24 * 60;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Следующее срабатывание weekly-записи
+ * @param now_us Текущее время esp_timer
+ * @param min_delta_us Минимальная задержка от текущего момента
+ * @return Момент срабатывания или RELAY_SCHED_NOT_ARMED (часы не установлены)
+ */
+static int64_t relay_sched_weekly_due(const relay_sched_entry_t *entry, int64_t now_us, int64_t min_delta_us)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec < RELAY_SCHED_TIME_VALID_MIN) {
+        return RELAY_SCHED_NOT_ARMED;
+    }
+
+    /* Часы хранят локальное время, поэтому gmtime_r не применяет пояс */
+    struct tm tm;
+    gmtime_r(&tv.tv_sec, &tm);
+    int64_t day_us = ((int64_t)tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec) * 1000000 + tv.tv_usec;
+
+    /* d = 7 - тот же день недели через неделю */
+    for (int d = 0; d <= 7; d++) {
+        if ((entry->days & (1 << ((tm.tm_wday + d) % 7))) == 0) {
+            continue;
+        }
+        int64_t delta_us = ((int64_t)d * 86400 + (int64_t)entry->minute * 60) * 1000000 - day_us;
+        if (delta_us >= min_delta_us) {
+            return now_us + delta_us;
+        }
+    }
+    return RELAY_SCHED_NOT_ARMED;
+}
+
+/**
+ * @brief Извлечение записи из массива (под мьютексом)
+ */
+static relay_sched_slot_t relay_sched_take(size_t index)
+{
+    relay_sched_slot_t slot = s_slots[index];
+    memmove(&s_slots[index], &s_slots[index + 1], (s_count - index - 1) * sizeof(s_slots[0]));
+    s_count--;
+    return slot;
+}
+
+/**
+ * @brief Вставка записи с сохранением порядка по due_us (под мьютексом)
+ *
+ * Запись встает после записей с тем же моментом срабатывания, поэтому
+ * одновременные действия выполняются в порядке добавления.
+ */
+static bool relay_sched_insert(const relay_sched_slot_t *slot)
+{
+    if (s_count >= RELAY_SCHED_MAX_ENTRIES) {
+        return false;
+    }
+
+    size_t lo = 0;
+    size_t hi = s_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (s_slots[mid].due_us <= slot->due_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    memmove(&s_slots[lo + 1], &s_slots[lo], (s_count - lo) * sizeof(s_slots[0]));
+    s_slots[lo] = *slot;
+    s_count++;
+    return true;
+}
+
+/**
+ * @brief Поиск записи по id (под мьютексом)
+ * @return Индекс или -1
+ */
+static int relay_sched_find(uint8_t id)
+{
+    for (size_t i = 0; i < s_count; i++) {
+        if (s_slots[i].entry.id == id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Свободный id (под мьютексом, 0 - нет свободных)
+ */
+static uint8_t relay_sched_alloc_id(void)
+{
+    for (unsigned id = 1; id <= UINT8_MAX; id++) {
+        if (relay_sched_find((uint8_t)id) < 0) {
+            return (uint8_t)id;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Перевзвод диспетчера на первую запись массива (под мьютексом)
+ */
+static void relay_sched_rearm(void)
+{
+    esp_timer_stop(s_dispatch_timer);
+
+    if (s_count == 0 || s_slots[0].due_us == RELAY_SCHED_NOT_ARMED) {
+        return;
+    }
+
+    int64_t delay_us = s_slots[0].due_us - esp_timer_get_time();
+    esp_timer_start_once(s_dispatch_timer, delay_us > 0 ? (uint64_t)delay_us : 1);
+}
+
+/**
+ * @brief Сохранение inching- и weekly-записей в NVS
+ */
+static esp_err_t relay_sched_save(void)
+{
+    relay_sched_record_t record = {
+        .version = RELAY_SCHED_FORMAT_VERSION,
+    };
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_count; i++) {
+        const relay_sched_entry_t *entry = &s_slots[i].entry;
+        if (entry->type == RELAY_SCHED_COUNTDOWN) {
+            continue;
+        }
+
+        /* Сортировка вставкой по id - содержимое блоба не зависит от
+           текущего порядка срабатываний */
+        size_t pos = record.count;
+        while (pos > 0 && record.entries[pos - 1].id > entry->id) {
+            record.entries[pos] = record.entries[pos - 1];
+            pos--;
+        }
+        record.entries[pos] = *entry;
+        record.count++;
+    }
+    xSemaphoreGive(s_mutex);
+
+    size_t size = offsetof(relay_sched_record_t, entries) + record.count * sizeof(record.entries[0]);
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(RELAY_SCHED_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, RELAY_SCHED_NVS_KEY, &record, size);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (err != ESP_OK) {
+        s_stats.nvs_errors++;
+        ESP_LOGW(TAG, "Failed to save schedule: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    s_stats.nvs_writes++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Загрузка записей из NVS
+ */
+static void relay_sched_load(void)
+{
+    relay_sched_record_t record;
+    nvs_handle_t nvs_handle;
+
+    if (nvs_open(RELAY_SCHED_NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;  // Расписание еще не сохранялось
+    }
+
+    size_t size = sizeof(record);
+    esp_err_t err = nvs_get_blob(nvs_handle, RELAY_SCHED_NVS_KEY, &record, &size);
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK || size < offsetof(relay_sched_record_t, entries) ||
+        record.version != RELAY_SCHED_FORMAT_VERSION || record.count > RELAY_SCHED_MAX_ENTRIES ||
+        size != offsetof(relay_sched_record_t, entries) + record.count * sizeof(record.entries[0])) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Discarding saved schedule: %s",
+                     err != ESP_OK ? esp_err_to_name(err) : "format mismatch");
+        }
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    for (size_t i = 0; i < record.count; i++) {
+        const relay_sched_entry_t *entry = &record.entries[i];
+        if (!relay_sched_entry_valid(entry) || entry->type == RELAY_SCHED_COUNTDOWN) {
+            ESP_LOGW(TAG, "Skipping invalid schedule entry %d", entry->id);
+            continue;
+        }
+
+        relay_sched_slot_t slot = {
+            .entry = *entry,
+            .due_us = (entry->type == RELAY_SCHED_WEEKLY) ?
+                      relay_sched_weekly_due(entry, now_us, 1) : RELAY_SCHED_NOT_ARMED,
+        };
+        relay_sched_insert(&slot);
+    }
+
+    ESP_LOGI(TAG, "Loaded %d schedule entries", (int)s_count);
+}
+
+/**
+ * @brief Диспетчер (задача esp_timer): выполнение наступивших записей
+ */
+static void relay_sched_dispatch(void *arg)
+{
+    relay_sched_action_t actions[RELAY_SCHED_MAX_ENTRIES];
+    size_t action_count = 0;
+    int64_t now_us = esp_timer_get_time();
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    while (s_count > 0 && s_slots[0].due_us <= now_us && action_count < RELAY_SCHED_MAX_ENTRIES) {
+        relay_sched_slot_t slot = relay_sched_take(0);
+
+        uint32_t late_us = (uint32_t)(now_us - slot.due_us);
+        if (late_us > s_stats.max_late_us) {
+            s_stats.max_late_us = late_us;
+        }
+
+        actions[action_count].relay_num = slot.entry.relay_num;
+        actions[action_count].state = (relay_state_t)slot.entry.state;
+        action_count++;
+
+        switch (slot.entry.type) {
+        case RELAY_SCHED_INCHING:
+            slot.due_us = RELAY_SCHED_NOT_ARMED;  // До следующего включения
+            relay_sched_insert(&slot);
+            break;
+        case RELAY_SCHED_WEEKLY:
+            slot.due_us = relay_sched_weekly_due(&slot.entry, now_us, RELAY_SCHED_REARM_GUARD_US);
+            relay_sched_insert(&slot);
+            break;
+        default:
+            break;  // Countdown однократный
+        }
+    }
+    relay_sched_rearm();
+    xSemaphoreGive(s_mutex);
+
+    for (size_t i = 0; i < action_count; i++) {
+        s_stats.fired++;
+        if (relay_actuator_submit(RELAY_ORIGIN_SCHEDULER, actions[i].relay_num, actions[i].state) != ESP_OK) {
+            s_stats.submit_errors++;
+            ESP_LOGW(TAG, "Relay %d: scheduled action dropped", actions[i].relay_num);
+        }
+    }
+}
+
+/**
+ * @brief Подписчик шины реле: запуск и отмена импульса inching
+ */
+static void relay_sched_event_handler(const relay_event_t *event, void *ctx)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_count; i++) {
+        if (s_slots[i].entry.type != RELAY_SCHED_INCHING || s_slots[i].entry.relay_num != event->relay_num) {
+            continue;
+        }
+
+        relay_sched_slot_t slot = relay_sched_take(i);
+        slot.due_us = (event->state == RELAY_ON) ?
+                      event->timestamp_us + (int64_t)slot.entry.duration_ms * 1000 : RELAY_SCHED_NOT_ARMED;
+        relay_sched_insert(&slot);
+        relay_sched_rearm();
+        break;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+/**
+ * @brief Добавление записи с назначенным моментом срабатывания
+ */
+static esp_err_t relay_sched_add(relay_sched_entry_t *entry, int64_t due_us, uint8_t *id)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    entry->id = relay_sched_alloc_id();
+
+    relay_sched_slot_t slot = {
+        .entry = *entry,
+        .due_us = due_us,
+    };
+    bool added = entry->id != 0 && relay_sched_insert(&slot);
+    if (added) {
+        relay_sched_rearm();
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (!added) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (id != NULL) {
+        *id = entry->id;
+    }
+    return (entry->type != RELAY_SCHED_COUNTDOWN) ? relay_sched_save() : ESP_OK;
+}
+
+esp_err_t relay_scheduler_init(void)
+{
+    if (s_mutex != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = relay_sched_dispatch,
+        .name = "relay_sched",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_dispatch_timer), TAG, "Failed to create dispatch timer");
+
+    relay_sched_load();
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    relay_sched_rearm();
+    xSemaphoreGive(s_mutex);
+
+    return relay_event_bus_subscribe(relay_sched_event_handler, NULL);
+}
+
+esp_err_t relay_scheduler_add_countdown(uint8_t relay_num, relay_state_t state, uint32_t delay_ms, uint8_t *id)
+{
+    relay_sched_entry_t entry = {
+        .id = 1,
+        .type = RELAY_SCHED_COUNTDOWN,
+        .relay_num = relay_num,
+        .state = (uint8_t)state,
+        .duration_ms = delay_ms,
+    };
+    if (!relay_sched_entry_valid(&entry)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return relay_sched_add(&entry, esp_timer_get_time() + (int64_t)delay_ms * 1000, id);
+}
+
+esp_err_t relay_scheduler_set_inching(uint8_t relay_num, uint32_t pulse_ms)
+{
+    relay_sched_entry_t entry = {
+        .id = 1,
+        .type = RELAY_SCHED_INCHING,
+        .relay_num = relay_num,
+        .state = RELAY_OFF,
+        .duration_ms = pulse_ms,
+    };
+    if (relay_num < 1 || relay_num > RELAY_COUNT || (pulse_ms != 0 && !relay_sched_entry_valid(&entry))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Существующая запись реле меняется на месте (момент уже начатого
+       импульса сохраняется) или удаляется */
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int index = -1;
+    for (size_t i = 0; i < s_count; i++) {
+        if (s_slots[i].entry.type == RELAY_SCHED_INCHING && s_slots[i].entry.relay_num == relay_num) {
+            index = (int)i;
+            break;
+        }
+    }
+    if (index >= 0) {
+        if (pulse_ms != 0) {
+            s_slots[index].entry.duration_ms = pulse_ms;
+        } else {
+            relay_sched_take(index);
+            relay_sched_rearm();
+        }
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (index >= 0) {
+        return relay_sched_save();
+    }
+    if (pulse_ms == 0) {
+        return ESP_OK;
+    }
+    return relay_sched_add(&entry, RELAY_SCHED_NOT_ARMED, NULL);
+}
+
+esp_err_t relay_scheduler_add_weekly(uint8_t relay_num, relay_state_t state, uint8_t days,
+                                     uint16_t minute, uint8_t *id)
+{
+    relay_sched_entry_t entry = {
+        .id = 1,
+        .type = RELAY_SCHED_WEEKLY,
+        .relay_num = relay_num,
+        .state = (uint8_t)state,
+        .days = days,
+        .minute = minute,
+    };
+    if (!relay_sched_entry_valid(&entry)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return relay_sched_add(&entry, relay_sched_weekly_due(&entry, esp_timer_get_time(), 1), id);
+}
+
+esp_err_t relay_scheduler_remove(uint8_t id)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int index = relay_sched_find(id);
+    relay_sched_type_t type = RELAY_SCHED_COUNTDOWN;
+    if (index >= 0) {
+        type = (relay_sched_type_t)relay_sched_take(index).entry.type;
+        relay_sched_rearm();
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return (type != RELAY_SCHED_COUNTDOWN) ? relay_sched_save() : ESP_OK;
+}
+
+esp_err_t relay_scheduler_set_time(time_t local_time)
+{
+    if (local_time < RELAY_SCHED_TIME_VALID_MIN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct timeval tv = {
+        .tv_sec = local_time,
+    };
+    settimeofday(&tv, NULL);
+
+    /* Пересчет weekly-записей: массив перестраивается вставками */
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    relay_sched_slot_t slots[RELAY_SCHED_MAX_ENTRIES];
+    size_t count = s_count;
+    memcpy(slots, s_slots, count * sizeof(slots[0]));
+    s_count = 0;
+
+    int64_t now_us = esp_timer_get_time();
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].entry.type == RELAY_SCHED_WEEKLY) {
+            slots[i].due_us = relay_sched_weekly_due(&slots[i].entry, now_us, 1);
+        }
+        relay_sched_insert(&slots[i]);
+    }
+    relay_sched_rearm();
+    xSemaphoreGive(s_mutex);
+
+    if (!s_stats.time_valid) {
+        ESP_LOGI(TAG, "Clock set, weekly schedules armed");
+    }
+    s_stats.time_valid = true;
+    return ESP_OK;
+}
+
+bool relay_scheduler_time_valid(void)
+{
+    return s_stats.time_valid;
+}
+
+size_t relay_scheduler_list(relay_sched_info_t *info, size_t max_count)
+{
+    int64_t now_us = esp_timer_get_time();
+    size_t count = 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < s_count && count < max_count; i++, count++) {
+        info[count].entry = s_slots[i].entry;
+        info[count].armed = s_slots[i].due_us != RELAY_SCHED_NOT_ARMED;
+        info[count].remaining_ms = 0;
+        if (info[count].armed && s_slots[i].due_us > now_us) {
+            info[count].remaining_ms = (uint32_t)((s_slots[i].due_us - now_us) / 1000);
+        }
+    }
+    xSemaphoreGive(s_mutex);
+
+    return count;
+}
+
+void relay_scheduler_get_stats(relay_scheduler_stats_t *stats)
+{
+    *stats = s_stats;
+    stats->entries = (uint8_t)s_count;
+}
@@ -0,0 +1,170 @@
+/*
+ * Relay Scheduler
+ *
+ * Локальный планировщик действий над реле, работающий без координатора:
+ *   countdown - однократное включение/выключение через заданное время
+ *               (мс); живет только в RAM и после перезагрузки не
+ *               восстанавливается;
+ *   inching   - "импульсный" режим: при каждом включении реле (из любого
+ *               источника) оно выключается через заданное время (мс);
+ *               выключение раньше срока отменяет импульс. Одна запись
+ *               на реле, новая длительность действует со следующего
+ *               включения;
+ *   weekly    - включение/выключение по дням недели в заданное время
+ *               (минута суток, локальное время).
+ *
+ * Записи хранятся в одном компактном массиве, отсортированном по моменту
+ * следующего срабатывания; запись без назначенного срабатывания (inching
+ * без включенного реле, weekly без часов) стоит в конце массива.
+ * Диспетчер один - однократный esp_timer (аппаратный системный таймер),
+ * взведенный на первую запись массива, поэтому точность импульсов
+ * ограничена только задержкой задачи esp_timer, а не тиком FreeRTOS.
+ * Команды исполнителю отправляются из задачи esp_timer с источником
+ * RELAY_ORIGIN_SCHEDULER (единственный производитель этого источника).
+ *
+ * Inching и weekly сохраняются в NVS одним блобом при добавлении или
+ * удалении записи. Срабатывания flash не пишут.
+ *
+ * Weekly требует часов: время задается relay_scheduler_set_time() (синхро-
+ * низация с координатором или консоль) и дальше идет по системному
+ * таймеру, в том числе без связи с координатором. До первой установки
+ * времени после загрузки weekly-записи не срабатывают.
+ */
+
+#ifndef RELAY_SCHEDULER_H
+#define RELAY_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "esp_err.h"
+#include "device_config.h"
+
+#define RELAY_SCHED_NVS_NAMESPACE   "relay_sched"
+#define RELAY_SCHED_NVS_KEY         "entries"
+
+#define RELAY_SCHED_MAX_ENTRIES     16          // Емкость массива записей
+#define RELAY_SCHED_MAX_DURATION_MS 86400000    // Максимальная задержка countdown/inching (сутки)
+#define RELAY_SCHED_TIME_VALID_MIN  1704067200  // Часы считаются установленными после 2024-01-01
+
+/* Дни недели weekly-записи (бит = tm_wday) */
+#define RELAY_SCHED_DAY_SUN         (1 << 0)
+#define RELAY_SCHED_DAY_MON         (1 << 1)
+#define RELAY_SCHED_DAY_TUE         (1 << 2)
+#define RELAY_SCHED_DAY_WED         (1 << 3)
+#define RELAY_SCHED_DAY_THU         (1 << 4)
+#define RELAY_SCHED_DAY_FRI         (1 << 5)
+#define RELAY_SCHED_DAY_SAT         (1 << 6)
+#define RELAY_SCHED_DAYS_ALL        0x7F
+
+/* Тип записи */
+typedef enum {
+    RELAY_SCHED_COUNTDOWN = 0,
+    RELAY_SCHED_INCHING,
+    RELAY_SCHED_WEEKLY,
+    RELAY_SCHED_TYPE_MAX
+} relay_sched_type_t;
+
+/* Запись расписания (формат хранения в NVS) */
+typedef struct {
+    uint8_t id;                      // Идентификатор (1..255)
+    uint8_t type;                    // relay_sched_type_t
+    uint8_t relay_num;               // Номер реле (1..RELAY_COUNT)
+    uint8_t state;                   // Устанавливаемое состояние (relay_state_t)
+    uint8_t days;                    // Дни недели (weekly)
+    uint8_t reserved;
+    uint16_t minute;                 // Минута суток (weekly)
+    uint32_t duration_ms;            // Задержка (countdown) или длительность импульса (inching)
+} relay_sched_entry_t;
+
+/* Запись с моментом срабатывания (для консоли) */
+typedef struct {
+    relay_sched_entry_t entry;
+    bool armed;                      // Срабатывание назначено
+    uint32_t remaining_ms;           // До срабатывания
+} relay_sched_info_t;
+
+/* Статистика планировщика */
+typedef struct {
+    uint32_t fired;                  // Выполнено действий
+    uint32_t submit_errors;          // Команд, не принятых исполнителем
+    uint32_t max_late_us;            // Максимальное опоздание срабатывания
+    uint32_t nvs_writes;             // Записей в NVS
+    uint32_t nvs_errors;             // Ошибок записи в NVS
+    uint8_t entries;                 // Записей в массиве
+    bool time_valid;                 // Часы установлены
+} relay_scheduler_stats_t;
+
+/**
+ * @brief Загрузка записей из NVS, создание диспетчера, подписка на шину реле
+ *
+ * Вызывается после nvs_flash_init() и до запуска исполнителя реле.
+ *
+ * @return ESP_OK при успехе
+ */
+esp_err_t relay_scheduler_init(void);
+
+/**
+ * @brief Однократное действие через заданное время
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param state Устанавливаемое состояние
+ * @param delay_ms Задержка (1..RELAY_SCHED_MAX_DURATION_MS)
+ * @param id Идентификатор созданной записи (может быть NULL)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG или ESP_ERR_NO_MEM (массив заполнен)
+ */
+esp_err_t relay_scheduler_add_countdown(uint8_t relay_num, relay_state_t state, uint32_t delay_ms, uint8_t *id);
+
+/**
+ * @brief Настройка импульсного режима реле
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param pulse_ms Длительность импульса (0 - режим выключен)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG или ESP_ERR_NO_MEM (массив заполнен)
+ */
+esp_err_t relay_scheduler_set_inching(uint8_t relay_num, uint32_t pulse_ms);
+
+/**
+ * @brief Еженедельное действие
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param state Устанавливаемое состояние
+ * @param days Маска дней недели (RELAY_SCHED_DAY_*)
+ * @param minute Минута суток (0..1439, локальное время)
+ * @param id Идентификатор созданной записи (может быть NULL)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG или ESP_ERR_NO_MEM (массив заполнен)
+ */
+esp_err_t relay_scheduler_add_weekly(uint8_t relay_num, relay_state_t state, uint8_t days,
+                                     uint16_t minute, uint8_t *id);
+
+/**
+ * @brief Удаление записи
+ * @param id Идентификатор записи
+ * @return ESP_OK или ESP_ERR_NOT_FOUND
+ */
+esp_err_t relay_scheduler_remove(uint8_t id);
+
+/**
+ * @brief Установка часов (локальное время) и пересчет weekly-записей
+ * @param local_time Локальное время, секунды с 1970-01-01
+ * @return ESP_OK или ESP_ERR_INVALID_ARG (время раньше RELAY_SCHED_TIME_VALID_MIN)
+ */
+esp_err_t relay_scheduler_set_time(time_t local_time);
+
+/**
+ * @brief Часы установлены
+ */
+bool relay_scheduler_time_valid(void);
+
+/**
+ * @brief Список записей в порядке срабатывания
+ * @param info Буфер для записей
+ * @param max_count Размер буфера
+ * @return Количество записей в буфере
+ */
+size_t relay_scheduler_list(relay_sched_info_t *info, size_t max_count);
+
+/**
+ * @brief Получение статистики планировщика
+ * @param stats Буфер для статистики
+ */
+void relay_scheduler_get_stats(relay_scheduler_stats_t *stats);
+
+#endif // RELAY_SCHEDULER_H
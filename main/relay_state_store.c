@@ -0,0 +1,248 @@
+/*
+ * Relay State Store
+ *
+ * Сохранение состояния реле и StartUpOnOff (см. relay_state_store.h).
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "relay_actuator.h"
+#include "relay_event_bus.h"
+#include "relay_state_store.h"
+
+static const char *TAG = "RELAY_STATE";
+
+#define RELAY_STATE_FORMAT_VERSION  1
+
+/* Запись хранилища (формат хранения в NVS) */
+typedef struct {
+    uint8_t version;                 // Версия формата
+    uint8_t state[RELAY_COUNT];      // Последнее состояние реле (relay_state_t)
+    uint8_t startup[RELAY_COUNT];    // StartUpOnOff реле
+} relay_state_record_t;
+
+static relay_state_record_t s_current;   // Актуальное состояние (RAM)
+static relay_state_record_t s_persisted; // Содержимое NVS
+static int64_t s_pending_since_us = 0;   // Первое несохраненное изменение (0 - нет)
+static TimerHandle_t s_commit_timer = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static relay_state_store_stats_t s_stats;
+
+/**
+ * @brief Назначение отложенной записи
+ *
+ * Таймер перезапускается при каждом изменении, пока с первого
+ * несохраненного изменения не прошло RELAY_STATE_COMMIT_MAX_MS.
+ */
+static void relay_state_store_schedule(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    bool restart;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_pending_since_us == 0) {
+        s_pending_since_us = now_us;
+        restart = true;
+    } else {
+        restart = (now_us - s_pending_since_us) < (int64_t)RELAY_STATE_COMMIT_MAX_MS * 1000;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (restart) {
+        xTimerReset(s_commit_timer, 0);
+    }
+}
+
+/**
+ * @brief Отложенная запись в NVS (задача таймеров FreeRTOS)
+ */
+static void relay_state_store_commit(TimerHandle_t timer)
+{
+    relay_state_record_t record;
+
+    portENTER_CRITICAL(&s_lock);
+    record = s_current;
+    s_pending_since_us = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    s_stats.commits++;
+    if (memcmp(&record, &s_persisted, sizeof(record)) == 0) {
+        s_stats.skipped++;
+        return;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(RELAY_STATE_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, RELAY_STATE_NVS_KEY, &record, sizeof(record));
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (err != ESP_OK) {
+        s_stats.errors++;
+        ESP_LOGW(TAG, "Failed to save relay state: %s", esp_err_to_name(err));
+        return;
+    }
+
+    s_persisted = record;
+    s_stats.nvs_writes++;
+    ESP_LOGD(TAG, "Relay state saved");
+}
+
+/**
+ * @brief Подписчик шины реле: запоминание нового состояния
+ */
+static void relay_state_store_event_handler(const relay_event_t *event, void *ctx)
+{
+    if (event->relay_num < 1 || event->relay_num > RELAY_COUNT) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_current.state[event->relay_num - 1] = (uint8_t)event->state;
+    s_stats.changes++;
+    portEXIT_CRITICAL(&s_lock);
+
+    relay_state_store_schedule();
+}
+
+/**
+ * @brief Проверка значения StartUpOnOff
+ */
+static bool relay_state_store_startup_valid(uint8_t mode)
+{
+    return mode == RELAY_STARTUP_OFF || mode == RELAY_STARTUP_ON ||
+           mode == RELAY_STARTUP_TOGGLE || mode == RELAY_STARTUP_PREVIOUS;
+}
+
+/**
+ * @brief Загрузка записи из NVS
+ * @return true - запись загружена и корректна
+ */
+static bool relay_state_store_load(relay_state_record_t *record)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(RELAY_STATE_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        return false;  // Состояние еще не сохранялось
+    }
+
+    size_t size = sizeof(*record);
+    err = nvs_get_blob(nvs_handle, RELAY_STATE_NVS_KEY, record, &size);
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK || size != sizeof(*record) || record->version != RELAY_STATE_FORMAT_VERSION) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Discarding saved relay state: %s",
+                     err != ESP_OK ? esp_err_to_name(err) : "format mismatch");
+        }
+        return false;
+    }
+
+    for (int i = 0; i < RELAY_COUNT; i++) {
+        if (record->state[i] > RELAY_ON || !relay_state_store_startup_valid(record->startup[i])) {
+            ESP_LOGW(TAG, "Discarding saved relay state: invalid values");
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t relay_state_store_init(void)
+{
+    if (s_commit_timer != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (relay_state_store_load(&s_current)) {
+        s_stats.restored = true;
+    } else {
+        memset(&s_current, 0, sizeof(s_current));
+        s_current.version = RELAY_STATE_FORMAT_VERSION;
+        for (int i = 0; i < RELAY_COUNT; i++) {
+            s_current.state[i] = RELAY_OFF;
+            s_current.startup[i] = RELAY_STARTUP_DEFAULT;
+        }
+    }
+    s_persisted = s_current;
+
+    s_commit_timer = xTimerCreate("relay_state", pdMS_TO_TICKS(RELAY_STATE_COMMIT_MS), pdFALSE,
+                                  NULL, relay_state_store_commit);
+    if (s_commit_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create commit timer");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return relay_event_bus_subscribe(relay_state_store_event_handler, NULL);
+}
+
+relay_state_t relay_state_store_startup_state(uint8_t relay_num)
+{
+    if (relay_num < 1 || relay_num > RELAY_COUNT) {
+        return RELAY_OFF;
+    }
+
+    uint8_t previous = s_current.state[relay_num - 1];
+
+    switch (s_current.startup[relay_num - 1]) {
+    case RELAY_STARTUP_OFF:
+        return RELAY_OFF;
+    case RELAY_STARTUP_ON:
+        return RELAY_ON;
+    case RELAY_STARTUP_TOGGLE:
+        return (previous == RELAY_ON) ? RELAY_OFF : RELAY_ON;
+    default:
+        return (previous == RELAY_ON) ? RELAY_ON : RELAY_OFF;
+    }
+}
+
+void relay_state_store_restore(void)
+{
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        uint8_t previous = s_current.state[relay_num - 1];
+        uint8_t startup = s_current.startup[relay_num - 1];
+        relay_state_t state = relay_state_store_startup_state(relay_num);
+
+        ESP_LOGI(TAG, "Relay %d start-up: %s (StartUpOnOff 0x%02x, previous %s)", relay_num,
+                 state == RELAY_ON ? "ON" : "OFF", startup, previous == RELAY_ON ? "ON" : "OFF");
+        relay_actuator_submit(RELAY_ORIGIN_RESTORE, relay_num, state);
+    }
+}
+
+uint8_t relay_state_store_get_startup(uint8_t relay_num)
+{
+    if (relay_num < 1 || relay_num > RELAY_COUNT) {
+        return RELAY_STARTUP_DEFAULT;
+    }
+    return s_current.startup[relay_num - 1];
+}
+
+esp_err_t relay_state_store_set_startup(uint8_t relay_num, uint8_t mode)
+{
+    if (relay_num < 1 || relay_num > RELAY_COUNT || !relay_state_store_startup_valid(mode)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    bool changed = s_current.startup[relay_num - 1] != mode;
+    s_current.startup[relay_num - 1] = mode;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        ESP_LOGI(TAG, "Relay %d StartUpOnOff set to 0x%02x", relay_num, mode);
+        relay_state_store_schedule();
+    }
+    return ESP_OK;
+}
+
+void relay_state_store_get_stats(relay_state_store_stats_t *stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,104 @@
+/*
+ * Relay State Store
+ *
+ * Сохранение состояния реле и поведение при подаче питания
+ * (атрибут StartUpOnOff кластера On/Off, 0x4003):
+ *   0x00 - выключить, 0x01 - включить, 0x02 - инвертировать последнее
+ *   состояние, 0xFF - восстановить последнее состояние (по умолчанию).
+ *
+ * Хранилище подписано на шину relay_event_bus и запоминает каждое
+ * изменение реле в RAM. Запись в NVS откладывается на
+ * RELAY_STATE_COMMIT_MS после последнего изменения, поэтому серия
+ * быстрых переключений дает одну запись во flash; при непрерывных
+ * переключениях запись выполняется не реже RELAY_STATE_COMMIT_MAX_MS.
+ * Если состояние вернулось к сохраненному, запись не выполняется.
+ * Запись дописывает новую версию ключа в журнал страниц NVS, который
+ * сам распределяет износ по страницам раздела.
+ *
+ * Состояние восстанавливается в app_main до запуска стека Zigbee:
+ * команды уходят исполнителю с источником RELAY_ORIGIN_RESTORE, и
+ * нагрузка включается через миллисекунды после загрузки, не дожидаясь
+ * координатора.
+ */
+
+#ifndef RELAY_STATE_STORE_H
+#define RELAY_STATE_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "device_config.h"
+
+#define RELAY_STATE_NVS_NAMESPACE   "relay_state"
+#define RELAY_STATE_NVS_KEY         "state"
+
+#define RELAY_STATE_COMMIT_MS       2000    // Задержка записи после последнего изменения
+#define RELAY_STATE_COMMIT_MAX_MS   10000   // Максимальная задержка записи при непрерывных изменениях
+
+/* Значения атрибута StartUpOnOff */
+#define RELAY_STARTUP_OFF           0x00
+#define RELAY_STARTUP_ON            0x01
+#define RELAY_STARTUP_TOGGLE        0x02
+#define RELAY_STARTUP_PREVIOUS      0xFF
+#define RELAY_STARTUP_DEFAULT       RELAY_STARTUP_PREVIOUS
+
+/* Статистика хранилища */
+typedef struct {
+    uint32_t changes;                // Изменений реле, принятых с шины
+    uint32_t commits;                // Срабатываний отложенной записи
+    uint32_t nvs_writes;             // Записей в NVS
+    uint32_t skipped;                // Записей, пропущенных без изменения содержимого
+    uint32_t errors;                 // Ошибок записи
+    bool restored;                   // Состояние загружено из NVS при старте
+} relay_state_store_stats_t;
+
+/**
+ * @brief Загрузка состояния из NVS и подписка на шину реле
+ *
+ * Вызывается после nvs_flash_init() и до запуска исполнителя реле.
+ *
+ * @return ESP_OK при успехе
+ */
+esp_err_t relay_state_store_init(void);
+
+/**
+ * @brief Восстановление реле согласно StartUpOnOff
+ *
+ * Вызывается после запуска исполнителя реле и настройки GPIO.
+ */
+void relay_state_store_restore(void);
+
+/**
+ * @brief Состояние реле после восстановления согласно StartUpOnOff
+ *
+ * Вызывается между relay_state_store_init() и relay_state_store_restore():
+ * начальное значение атрибута OnOff при построении endpoints до запуска
+ * исполнителя. После восстановления сохраненное состояние уже новое.
+ *
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @return Состояние, которое применит relay_state_store_restore()
+ */
+relay_state_t relay_state_store_startup_state(uint8_t relay_num);
+
+/**
+ * @brief Значение StartUpOnOff реле
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @return Значение атрибута
+ */
+uint8_t relay_state_store_get_startup(uint8_t relay_num);
+
+/**
+ * @brief Изменение StartUpOnOff реле (запись атрибута из сети)
+ * @param relay_num Номер реле (1..RELAY_COUNT)
+ * @param mode Значение атрибута
+ * @return ESP_OK или ESP_ERR_INVALID_ARG
+ */
+esp_err_t relay_state_store_set_startup(uint8_t relay_num, uint8_t mode);
+
+/**
+ * @brief Получение статистики хранилища
+ * @param stats Буфер для статистики
+ */
+void relay_state_store_get_stats(relay_state_store_stats_t *stats);
+
+#endif // RELAY_STATE_STORE_H
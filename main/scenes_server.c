@@ -0,0 +1,774 @@
+/*
+ * Scenes Server
+ *
+ * Кластер Scenes на устройстве (см. scenes_server.h).
+ *
+ * Таблицу меняет только задача Zigbee; снимок для записи в NVS (задача
+ * таймеров FreeRTOS) и для консоли берется в критической секции.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "zboss_api.h"
+#include "relay_actuator.h"
+#include "relay_event_bus.h"
+#include "on_off_server.h"
+#include "groups_server.h"
+#include "scenes_server.h"
+
+static const char *TAG = "SCENES";
+
+#define SCENES_FORMAT_VERSION       1
+#define SCENES_RECALL_MERGE_US      1000000     // Окно объединения группового Recall по endpoint
+
+/* Режим доставки APS (биты 2-3 поля управления кадра APS) */
+#define SCENES_APS_DELIVERY_MODE(fc)    (((fc) >> 2) & 0x03)
+#define SCENES_APS_DELIVERY_GROUP       0x03
+
+/* Блоб NVS: заголовок и count записей в порядке ключа */
+typedef struct {
+    uint8_t version;                 // Версия формата
+    uint8_t count;                   // Количество записей
+    uint8_t reserved[2];
+    scenes_entry_t entries[SCENES_TABLE_SIZE];
+} scenes_record_t;
+
+/* Вызванная сцена endpoint (CurrentScene, CurrentGroup, SceneValid) */
+typedef struct {
+    uint16_t group_id;
+    uint8_t scene_id;
+    bool valid;                      // SceneValid
+    bool has_state;                  // В сцене есть состояние реле
+    relay_state_t state;             // Состояние реле в сцене
+} scenes_current_t;
+
+/* Последний групповой Recall (объединение повторов по endpoint) */
+typedef struct {
+    uint16_t src_addr;
+    uint8_t tsn;
+    uint16_t group_id;
+    uint8_t scene_id;
+    int64_t time_us;
+} scenes_last_recall_t;
+
+static scenes_entry_t s_table[SCENES_TABLE_SIZE];
+static size_t s_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TimerHandle_t s_commit_timer = NULL;
+static scenes_current_t s_current[RELAY_COUNT];
+static scenes_last_recall_t s_last_recall;
+static atomic_uint s_invalidate_mask;    // Реле, ушедшие из состояния сцены (пишет подписчик шины)
+static scenes_server_stats_t s_stats;
+
+/**
+ * @brief Ключ записи: группа в старших битах, сцена в младших
+ */
+static uint32_t scenes_key(uint16_t group_id, uint8_t scene_id)
+{
+    return ((uint32_t)group_id << 8) | scene_id;
+}
+
+/**
+ * @brief Двоичный поиск записи
+ * @param pos Позиция вставки, если записи нет (может быть NULL)
+ * @return Индекс записи или -1
+ */
+static int scenes_find(uint16_t group_id, uint8_t scene_id, size_t *pos)
+{
+    uint32_t key = scenes_key(group_id, scene_id);
+    size_t lo = 0;
+    size_t hi = s_count;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        uint32_t mid_key = scenes_key(s_table[mid].group_id, s_table[mid].scene_id);
+        if (mid_key == key) {
+            return (int)mid;
+        }
+        if (mid_key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (pos != NULL) {
+        *pos = lo;
+    }
+    return -1;
+}
+
+/**
+ * @brief Запись сцены endpoint (NULL - сцены нет или она задана для других endpoint)
+ */
+static scenes_entry_t *scenes_lookup(uint16_t group_id, uint8_t scene_id, uint8_t relay_num)
+{
+    int index = scenes_find(group_id, scene_id, NULL);
+    if (index < 0 || (s_table[index].member_mask & (1u << (relay_num - 1))) == 0) {
+        return NULL;
+    }
+    return &s_table[index];
+}
+
+/**
+ * @brief Запись сцены с созданием (NULL - таблица заполнена)
+ */
+static scenes_entry_t *scenes_get_or_add(uint16_t group_id, uint8_t scene_id)
+{
+    size_t pos = 0;
+    int index = scenes_find(group_id, scene_id, &pos);
+    if (index >= 0) {
+        return &s_table[index];
+    }
+    if (s_count >= SCENES_TABLE_SIZE) {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    memmove(&s_table[pos + 1], &s_table[pos], (s_count - pos) * sizeof(s_table[0]));
+    memset(&s_table[pos], 0, sizeof(s_table[0]));
+    s_table[pos].group_id = group_id;
+    s_table[pos].scene_id = scene_id;
+    s_count++;
+    portEXIT_CRITICAL(&s_lock);
+
+    return &s_table[pos];
+}
+
+/**
+ * @brief Исключение endpoints из сцены; сцена без endpoint удаляется
+ * @return true - запись удалена из таблицы
+ */
+static bool scenes_drop_members(size_t index, uint8_t relay_mask)
+{
+    uint8_t removed = s_table[index].member_mask & relay_mask;
+    bool dropped = false;
+
+    portENTER_CRITICAL(&s_lock);
+    s_table[index].member_mask &= ~relay_mask;
+    s_table[index].on_off_mask &= ~relay_mask;
+    s_table[index].state_mask &= ~relay_mask;
+    if (s_table[index].member_mask == 0) {
+        memmove(&s_table[index], &s_table[index + 1], (s_count - index - 1) * sizeof(s_table[0]));
+        s_count--;
+        dropped = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    for (; removed != 0; removed &= removed - 1) {
+        s_stats.removed++;
+    }
+    return dropped;
+}
+
+/**
+ * @brief Исключение endpoints из всех сцен группы
+ * @return true - таблица изменилась
+ */
+static bool scenes_drop_group(uint16_t group_id, uint8_t relay_mask)
+{
+    /* Записи группы идут подряд (ключ начинается с группы) */
+    size_t i = 0;
+    int first = scenes_find(group_id, 0, &i);
+    if (first >= 0) {
+        i = (size_t)first;
+    }
+
+    bool changed = false;
+    while (i < s_count && s_table[i].group_id == group_id) {
+        if ((s_table[i].member_mask & relay_mask) == 0) {
+            i++;
+            continue;
+        }
+        changed = true;
+        if (!scenes_drop_members(i, relay_mask)) {
+            i++;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Изменение полей сцены (видимое снимку таблицы целиком)
+ */
+static void scenes_set_member(scenes_entry_t *entry, uint8_t relay_num, bool has_on_off, bool on,
+                              uint16_t transition_time)
+{
+    uint8_t bit = 1u << (relay_num - 1);
+
+    portENTER_CRITICAL(&s_lock);
+    entry->member_mask |= bit;
+    entry->on_off_mask = has_on_off ? (entry->on_off_mask | bit) : (entry->on_off_mask & ~bit);
+    entry->state_mask = (has_on_off && on) ? (entry->state_mask | bit) : (entry->state_mask & ~bit);
+    entry->transition_time = transition_time;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * @brief Отложенная запись таблицы в NVS (задача таймеров FreeRTOS)
+ */
+static void scenes_commit(TimerHandle_t timer)
+{
+    static scenes_record_t record;
+
+    portENTER_CRITICAL(&s_lock);
+    record.version = SCENES_FORMAT_VERSION;
+    record.count = (uint8_t)s_count;
+    memcpy(record.entries, s_table, s_count * sizeof(s_table[0]));
+    portEXIT_CRITICAL(&s_lock);
+
+    size_t size = offsetof(scenes_record_t, entries) + record.count * sizeof(record.entries[0]);
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(SCENES_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_handle, SCENES_NVS_KEY, &record, size);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+
+    if (err != ESP_OK) {
+        s_stats.nvs_errors++;
+        ESP_LOGW(TAG, "Failed to save scene table: %s", esp_err_to_name(err));
+        return;
+    }
+    s_stats.nvs_writes++;
+}
+
+/**
+ * @brief Назначение отложенной записи таблицы
+ */
+static void scenes_schedule_commit(void)
+{
+    xTimerReset(s_commit_timer, 0);
+}
+
+/**
+ * @brief Загрузка таблицы из NVS
+ */
+static void scenes_load(void)
+{
+    static scenes_record_t record;
+    nvs_handle_t nvs_handle;
+
+    if (nvs_open(SCENES_NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;  // Таблица еще не сохранялась
+    }
+
+    size_t size = sizeof(record);
+    esp_err_t err = nvs_get_blob(nvs_handle, SCENES_NVS_KEY, &record, &size);
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK || size < offsetof(scenes_record_t, entries) ||
+        record.version != SCENES_FORMAT_VERSION || record.count > SCENES_TABLE_SIZE ||
+        size != offsetof(scenes_record_t, entries) + record.count * sizeof(record.entries[0])) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGW(TAG, "Discarding saved scene table: %s",
+                     err != ESP_OK ? esp_err_to_name(err) : "format mismatch");
+        }
+        return;
+    }
+
+    /* Порядок ключей проверяется - на нем держится двоичный поиск */
+    uint8_t valid_mask = (1u << RELAY_COUNT) - 1;
+    for (size_t i = 0; i < record.count; i++) {
+        const scenes_entry_t *entry = &record.entries[i];
+        if (entry->member_mask == 0 || (entry->member_mask & ~valid_mask) != 0 ||
+            (i > 0 && scenes_key(entry->group_id, entry->scene_id) <=
+                      scenes_key(record.entries[i - 1].group_id, record.entries[i - 1].scene_id))) {
+            ESP_LOGW(TAG, "Discarding saved scene table: invalid entries");
+            return;
+        }
+    }
+
+    memcpy(s_table, record.entries, record.count * sizeof(record.entries[0]));
+    s_count = record.count;
+    ESP_LOGI(TAG, "Loaded %d scenes", (int)s_count);
+}
+
+/**
+ * @brief Подписчик шины реле: реле ушло из состояния вызванной сцены
+ */
+static void scenes_event_handler(const relay_event_t *event, void *ctx)
+{
+    const scenes_current_t *current = &s_current[event->relay_num - 1];
+    if (current->valid && (!current->has_state || event->state != current->state)) {
+        atomic_fetch_or(&s_invalidate_mask, 1u << (event->relay_num - 1));
+    }
+}
+
+/**
+ * @brief Число сцен endpoint
+ */
+static uint8_t scenes_count_for(uint8_t relay_num)
+{
+    uint8_t count = 0;
+    for (size_t i = 0; i < s_count; i++) {
+        if (s_table[i].member_mask & (1u << (relay_num - 1))) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Запись атрибутов кластера Scenes endpoint
+ */
+static void scenes_update_attrs(uint8_t relay_num)
+{
+    const scenes_current_t *current = &s_current[relay_num - 1];
+    uint8_t scene_count = scenes_count_for(relay_num);
+    uint8_t scene_id = current->scene_id;
+    uint16_t group_id = current->group_id;
+    bool valid = current->valid;
+    uint8_t endpoint = relay_channel_endpoint(relay_num);
+
+    esp_zb_zcl_set_attribute_val(endpoint, ESP_ZB_ZCL_CLUSTER_ID_SCENES, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_SCENES_SCENE_COUNT_ID, &scene_count, false);
+    esp_zb_zcl_set_attribute_val(endpoint, ESP_ZB_ZCL_CLUSTER_ID_SCENES, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_SCENES_CURRENT_SCENE_ID, &scene_id, false);
+    esp_zb_zcl_set_attribute_val(endpoint, ESP_ZB_ZCL_CLUSTER_ID_SCENES, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_SCENES_CURRENT_GROUP_ID, &group_id, false);
+    esp_zb_zcl_set_attribute_val(endpoint, ESP_ZB_ZCL_CLUSTER_ID_SCENES, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 ESP_ZB_ZCL_ATTR_SCENES_SCENE_VALID_ID, &valid, false);
+}
+
+/**
+ * @brief Сброс SceneValid у реле, ушедших из состояния сцены
+ */
+static void scenes_sync_valid(void)
+{
+    uint32_t mask = atomic_exchange(&s_invalidate_mask, 0);
+
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        if ((mask & (1u << (relay_num - 1))) && s_current[relay_num - 1].valid) {
+            s_current[relay_num - 1].valid = false;
+            scenes_update_attrs(relay_num);
+        }
+    }
+}
+
+/**
+ * @brief Установка вызванной (сохраненной) сцены endpoint
+ */
+static void scenes_set_current(uint8_t relay_num, const scenes_entry_t *entry)
+{
+    uint8_t bit = 1u << (relay_num - 1);
+    scenes_current_t *current = &s_current[relay_num - 1];
+
+    current->group_id = entry->group_id;
+    current->scene_id = entry->scene_id;
+    current->has_state = (entry->on_off_mask & bit) != 0;
+    current->state = (entry->state_mask & bit) ? RELAY_ON : RELAY_OFF;
+    current->valid = true;
+    atomic_fetch_and(&s_invalidate_mask, ~(uint32_t)bit);
+    scenes_update_attrs(relay_num);
+}
+
+/**
+ * @brief Группа задана и endpoint в ней не состоит
+ */
+static bool scenes_group_invalid(uint16_t group_id, uint8_t relay_num)
+{
+    return group_id != 0 && !groups_server_is_member(group_id, relay_num);
+}
+
+/**
+ * @brief Разбор Add Scene: время перехода и состояние On/Off из наборов расширений
+ * @return false - кадр поврежден
+ */
+static bool scenes_parse_add(const uint8_t *payload, size_t length, uint16_t *transition_time,
+                             bool *has_on_off, bool *on)
+{
+    /* group(2) scene(1) transition(2) name(1 + n) {cluster(2) length(1) data(n)}* */
+    if (length < 6 || length < 6u + payload[5]) {
+        return false;
+    }
+
+    *transition_time = (uint16_t)(payload[3] | (payload[4] << 8));
+    *has_on_off = false;
+    *on = false;
+
+    size_t offset = 6u + payload[5];
+    while (offset + 3 <= length) {
+        uint16_t cluster_id = (uint16_t)(payload[offset] | (payload[offset + 1] << 8));
+        uint8_t field_length = payload[offset + 2];
+        offset += 3;
+        if (offset + field_length > length) {
+            return false;
+        }
+        if (cluster_id == ESP_ZB_ZCL_CLUSTER_ID_ON_OFF && field_length >= 1) {
+            *has_on_off = true;
+            *on = payload[offset] != 0;
+        }
+        offset += field_length;
+    }
+    return true;
+}
+
+/**
+ * @brief Отправка ответа кластера Scenes отправителю команды (буфер команды переиспользуется)
+ */
+static void scenes_send_response(uint8_t bufid, const zb_zcl_parsed_hdr_t *cmd_info, uint8_t response_id,
+                                 const uint8_t *payload, size_t length)
+{
+    zb_uint16_t dst_addr = ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).source.u.short_addr;
+    zb_uint8_t *ptr = ZB_ZCL_START_PACKET(bufid);
+
+    ZB_ZCL_CONSTRUCT_SPECIFIC_COMMAND_RES_FRAME_CONTROL(ptr);
+    ZB_ZCL_CONSTRUCT_COMMAND_HEADER(ptr, cmd_info->seq_number, response_id);
+    memcpy(ptr, payload, length);
+    ptr += length;
+
+    ZB_ZCL_FINISH_N_SEND_PACKET(bufid, ptr, dst_addr, ZB_APS_ADDR_MODE_16_ENDP_PRESENT,
+                                ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).src_endpoint,
+                                ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).dst_endpoint,
+                                cmd_info->profile_id, ZB_ZCL_CLUSTER_ID_SCENES, NULL);
+}
+
+/**
+ * @brief Recall Scene
+ * @return Статус команды
+ */
+static zb_zcl_status_t scenes_recall(const zb_zcl_parsed_hdr_t *cmd_info, uint8_t relay_num,
+                                     uint16_t group_id, uint8_t scene_id, bool groupcast)
+{
+    const scenes_entry_t *entry = scenes_lookup(group_id, scene_id, relay_num);
+    if (entry == NULL) {
+        s_stats.not_found++;
+        return ZB_ZCL_STATUS_NOT_FOUND;
+    }
+
+    uint16_t src_addr = ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).source.u.short_addr;
+    int64_t now_us = esp_timer_get_time();
+    if (groupcast && s_last_recall.src_addr == src_addr && s_last_recall.tsn == cmd_info->seq_number &&
+        s_last_recall.group_id == group_id && s_last_recall.scene_id == scene_id &&
+        now_us - s_last_recall.time_us < SCENES_RECALL_MERGE_US) {
+        /* Тот же групповой кадр на следующем endpoint - реле уже переключены */
+        s_stats.recall_merged++;
+        scenes_set_current(relay_num, entry);
+        return ZB_ZCL_STATUS_SUCCESS;
+    }
+
+    /* Групповой вызов - все реле сцены из этой группы, одиночный - только свое */
+    uint8_t relay_mask = 0;
+    for (uint8_t num = 1; num <= RELAY_COUNT; num++) {
+        uint8_t bit = 1u << (num - 1);
+        if ((entry->member_mask & bit) &&
+            (num == relay_num || (groupcast && !scenes_group_invalid(group_id, num)))) {
+            relay_mask |= bit;
+        }
+    }
+
+    uint8_t switch_mask = relay_mask & entry->on_off_mask;
+    if (switch_mask != 0) {
+        relay_actuator_submit_batch(RELAY_ORIGIN_SCENE, switch_mask, entry->state_mask);
+    }
+
+    for (uint8_t num = 1; num <= RELAY_COUNT; num++) {
+        uint8_t bit = 1u << (num - 1);
+        if ((relay_mask & bit) == 0) {
+            continue;
+        }
+        if (switch_mask & bit) {
+            bool on = (entry->state_mask & bit) != 0;
+            esp_zb_zcl_set_attribute_val(relay_channel_endpoint(num), ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+                                         ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &on, false);
+            on_off_server_state_changed(num, on);
+        }
+        scenes_set_current(num, entry);
+    }
+
+    if (groupcast) {
+        s_last_recall = (scenes_last_recall_t){
+            .src_addr = src_addr,
+            .tsn = cmd_info->seq_number,
+            .group_id = group_id,
+            .scene_id = scene_id,
+            .time_us = now_us,
+        };
+    }
+
+    s_stats.recalled++;
+    ESP_LOGI(TAG, "Recall group 0x%04x scene %d: relays 0x%02x", group_id, scene_id, relay_mask);
+    return ZB_ZCL_STATUS_SUCCESS;
+}
+
+esp_err_t scenes_server_init(void)
+{
+    if (s_commit_timer != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    scenes_load();
+
+    s_commit_timer = xTimerCreate("scenes", pdMS_TO_TICKS(SCENES_COMMIT_MS), pdFALSE, NULL, scenes_commit);
+    if (s_commit_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create commit timer");
+        return ESP_ERR_NO_MEM;
+    }
+
+    return relay_event_bus_subscribe(scenes_event_handler, NULL);
+}
+
+void scenes_server_add_attrs(esp_zb_attribute_list_t *scenes_cluster, uint8_t relay_num)
+{
+    uint8_t scene_count = scenes_count_for(relay_num);
+    uint8_t current_scene = ESP_ZB_ZCL_SCENES_CURRENT_SCENE_DEFAULT_VALUE;
+    uint16_t current_group = ESP_ZB_ZCL_SCENES_CURRENT_GROUP_DEFAULT_VALUE;
+    uint8_t scene_valid = ESP_ZB_ZCL_SCENES_SCENE_VALID_DEFAULT_VALUE;
+    uint8_t name_support = ESP_ZB_ZCL_SCENES_NAME_SUPPORT_DEFAULT_VALUE;
+
+    esp_zb_scenes_cluster_add_attr(scenes_cluster, ESP_ZB_ZCL_ATTR_SCENES_SCENE_COUNT_ID, &scene_count);
+    esp_zb_scenes_cluster_add_attr(scenes_cluster, ESP_ZB_ZCL_ATTR_SCENES_CURRENT_SCENE_ID, &current_scene);
+    esp_zb_scenes_cluster_add_attr(scenes_cluster, ESP_ZB_ZCL_ATTR_SCENES_CURRENT_GROUP_ID, &current_group);
+    esp_zb_scenes_cluster_add_attr(scenes_cluster, ESP_ZB_ZCL_ATTR_SCENES_SCENE_VALID_ID, &scene_valid);
+    esp_zb_scenes_cluster_add_attr(scenes_cluster, ESP_ZB_ZCL_ATTR_SCENES_NAME_SUPPORT_ID, &name_support);
+}
+
+bool scenes_server_raw_command_handler(uint8_t bufid)
+{
+    /* Любая входящая команда (в том числе чтение SceneValid) видит актуальный атрибут */
+    scenes_sync_valid();
+
+    zb_zcl_parsed_hdr_t cmd_info;
+    ZB_ZCL_COPY_PARSED_HEADER(bufid, &cmd_info);
+
+    uint8_t endpoint = ZB_ZCL_PARSED_HDR_SHORT_DATA(&cmd_info).dst_endpoint;
+    uint8_t relay_num = relay_channel_by_endpoint(endpoint);
+    if (relay_num == 0 || !relay_channel_has_cluster(relay_num, RELAY_CLUSTER_SCENES) ||
+        cmd_info.cluster_id != ESP_ZB_ZCL_CLUSTER_ID_SCENES || cmd_info.is_common_command || cmd_info.is_manuf_specific ||
+        cmd_info.cmd_direction != ZB_ZCL_FRAME_DIRECTION_TO_SRV) {
+        return false;
+    }
+
+    const uint8_t *payload = (const uint8_t *)zb_buf_begin(bufid);
+    size_t length = zb_buf_len(bufid);
+    bool groupcast = SCENES_APS_DELIVERY_MODE(ZB_ZCL_PARSED_HDR_SHORT_DATA(&cmd_info).fc) == SCENES_APS_DELIVERY_GROUP;
+    uint8_t status = ZB_ZCL_STATUS_SUCCESS;
+    uint16_t group_id = (length >= 2) ? (uint16_t)(payload[0] | (payload[1] << 8)) : 0;
+    uint8_t scene_id = (length >= 3) ? payload[2] : 0;
+    uint8_t bit = 1u << (relay_num - 1);
+
+    /* Ответ: status, group(2), scene(1) и необязательная часть */
+    uint8_t response[8 + SCENES_TABLE_SIZE];
+    size_t response_length = 4;
+    uint8_t response_id = cmd_info.cmd_id;
+
+    switch (cmd_info.cmd_id) {
+    case ESP_ZB_ZCL_CMD_SCENES_ADD_SCENE:
+    case ESP_ZB_ZCL_CMD_SCENES_STORE_SCENE: {
+        uint16_t transition_time = 0;
+        bool has_on_off = true;
+        bool on = false;
+
+        if (cmd_info.cmd_id == ESP_ZB_ZCL_CMD_SCENES_ADD_SCENE) {
+            if (!scenes_parse_add(payload, length, &transition_time, &has_on_off, &on)) {
+                zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+                return true;
+            }
+        } else if (length < 3) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+
+        if (scenes_group_invalid(group_id, relay_num)) {
+            status = ZB_ZCL_STATUS_INVALID_FIELD;
+            break;
+        }
+
+        scenes_entry_t *entry = scenes_get_or_add(group_id, scene_id);
+        if (entry == NULL) {
+            s_stats.table_full++;
+            status = ZB_ZCL_STATUS_INSUFF_SPACE;
+            break;
+        }
+
+        if (cmd_info.cmd_id == ESP_ZB_ZCL_CMD_SCENES_STORE_SCENE) {
+            /* Store: текущее состояние реле, время перехода сохраняется */
+            device_status_t device;
+            device_get_status(&device);
+            on = device_relay_state(&device, relay_num) == RELAY_ON;
+            transition_time = (entry->member_mask & bit) ? entry->transition_time : 0;
+        }
+        scenes_set_member(entry, relay_num, has_on_off, on, transition_time);
+        s_stats.stored++;
+        scenes_schedule_commit();
+
+        if (cmd_info.cmd_id == ESP_ZB_ZCL_CMD_SCENES_STORE_SCENE) {
+            scenes_set_current(relay_num, entry);
+        } else {
+            scenes_update_attrs(relay_num);
+        }
+        break;
+    }
+
+    case ESP_ZB_ZCL_CMD_SCENES_VIEW_SCENE: {
+        if (length < 3) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+        if (scenes_group_invalid(group_id, relay_num)) {
+            status = ZB_ZCL_STATUS_INVALID_FIELD;
+            break;
+        }
+
+        const scenes_entry_t *entry = scenes_lookup(group_id, scene_id, relay_num);
+        if (entry == NULL) {
+            s_stats.not_found++;
+            status = ZB_ZCL_STATUS_NOT_FOUND;
+            break;
+        }
+
+        /* transition(2), пустое имя, набор расширений On/Off */
+        response[response_length++] = (uint8_t)entry->transition_time;
+        response[response_length++] = (uint8_t)(entry->transition_time >> 8);
+        response[response_length++] = 0;
+        if (entry->on_off_mask & bit) {
+            response[response_length++] = (uint8_t)ESP_ZB_ZCL_CLUSTER_ID_ON_OFF;
+            response[response_length++] = (uint8_t)(ESP_ZB_ZCL_CLUSTER_ID_ON_OFF >> 8);
+            response[response_length++] = 1;
+            response[response_length++] = (entry->state_mask & bit) ? 1 : 0;
+        }
+        break;
+    }
+
+    case ESP_ZB_ZCL_CMD_SCENES_REMOVE_SCENE: {
+        if (length < 3) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+        if (scenes_group_invalid(group_id, relay_num)) {
+            status = ZB_ZCL_STATUS_INVALID_FIELD;
+            break;
+        }
+        if (scenes_lookup(group_id, scene_id, relay_num) == NULL) {
+            s_stats.not_found++;
+            status = ZB_ZCL_STATUS_NOT_FOUND;
+            break;
+        }
+
+        scenes_drop_members((size_t)scenes_find(group_id, scene_id, NULL), bit);
+        scenes_schedule_commit();
+        scenes_update_attrs(relay_num);
+        break;
+    }
+
+    case ESP_ZB_ZCL_CMD_SCENES_REMOVE_ALL_SCENES: {
+        if (length < 2) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+        response_length = 3;  // Без scene_id
+        if (scenes_group_invalid(group_id, relay_num)) {
+            status = ZB_ZCL_STATUS_INVALID_FIELD;
+            break;
+        }
+
+        scenes_drop_group(group_id, bit);
+        scenes_schedule_commit();
+        scenes_update_attrs(relay_num);
+        break;
+    }
+
+    case ESP_ZB_ZCL_CMD_SCENES_RECALL_SCENE:
+        if (length < 3) {
+            status = ZB_ZCL_STATUS_MALFORMED_CMD;
+        } else {
+            status = scenes_recall(&cmd_info, relay_num, group_id, scene_id, groupcast);
+        }
+        zb_zcl_send_default_handler(bufid, &cmd_info, status);
+        return true;
+
+    case ESP_ZB_ZCL_CMD_SCENES_GET_SCENE_MEMBERSHIP: {
+        if (length < 2) {
+            zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_MALFORMED_CMD);
+            return true;
+        }
+
+        /* status, capacity(1), group(2)[, count(1), scene ids] */
+        response[1] = (uint8_t)(SCENES_TABLE_SIZE - s_count);
+        response[2] = (uint8_t)group_id;
+        response[3] = (uint8_t)(group_id >> 8);
+        response_length = 4;
+        if (scenes_group_invalid(group_id, relay_num)) {
+            status = ZB_ZCL_STATUS_INVALID_FIELD;
+            break;
+        }
+
+        uint8_t *count = &response[response_length++];
+        *count = 0;
+        for (size_t i = 0; i < s_count; i++) {
+            if (s_table[i].group_id == group_id && (s_table[i].member_mask & bit)) {
+                response[response_length++] = s_table[i].scene_id;
+                (*count)++;
+            }
+        }
+        response[0] = status;
+        if (!groupcast) {
+            scenes_send_response(bufid, &cmd_info, response_id, response, response_length);
+        } else {
+            zb_buf_free(bufid);
+        }
+        return true;
+    }
+
+    default:
+        /* Enhanced Add/View, Copy Scene: собственная таблица их не поддерживает */
+        zb_zcl_send_default_handler(bufid, &cmd_info, ZB_ZCL_STATUS_UNSUP_CLUST_CMD);
+        return true;
+    }
+
+    ESP_LOGD(TAG, "EP%d command 0x%02x group 0x%04x scene %d: status 0x%02x", endpoint, cmd_info.cmd_id,
+             group_id, scene_id, status);
+
+    response[0] = status;
+    if (cmd_info.cmd_id != ESP_ZB_ZCL_CMD_SCENES_GET_SCENE_MEMBERSHIP) {
+        response[1] = (uint8_t)group_id;
+        response[2] = (uint8_t)(group_id >> 8);
+        response[3] = scene_id;
+    }
+
+    /* Ответы кластера Scenes отправляются только на одиночные запросы */
+    if (!groupcast) {
+        scenes_send_response(bufid, &cmd_info, response_id, response, response_length);
+    } else {
+        zb_buf_free(bufid);
+    }
+    return true;
+}
+
+void scenes_server_remove_group(uint16_t group_id, uint8_t relay_mask)
+{
+    if (!scenes_drop_group(group_id, relay_mask)) {
+        return;
+    }
+
+    scenes_schedule_commit();
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        if (relay_mask & (1u << (relay_num - 1))) {
+            scenes_update_attrs(relay_num);
+        }
+    }
+}
+
+size_t scenes_server_get_table(scenes_entry_t *entries)
+{
+    portENTER_CRITICAL(&s_lock);
+    size_t count = s_count;
+    memcpy(entries, s_table, count * sizeof(s_table[0]));
+    portEXIT_CRITICAL(&s_lock);
+    return count;
+}
+
+void scenes_server_get_stats(scenes_server_stats_t *stats)
+{
+    *stats = s_stats;
+}
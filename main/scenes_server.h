@@ -0,0 +1,121 @@
+/*
+ * Scenes Server
+ *
+ * Кластер Scenes (0x0005) на endpoint реле: Add, View, Remove,
+ * Remove All, Store, Recall и Get Scene Membership выполняются на
+ * устройстве по собственной таблице сцен.
+ *
+ * Таблица общая для всех endpoint и фиксированной емкости
+ * SCENES_TABLE_SIZE: запись на пару (группа, сцена) хранит маску
+ * endpoint, для которых сцена задана, и состояние каждого реле в сцене.
+ * Записи отсортированы по ключу (группа, сцена), поиск - двоичный.
+ * Таблица сохраняется в NVS одним блобом через SCENES_COMMIT_MS после
+ * последнего изменения, поэтому групповой Store на оба endpoint дает
+ * одну запись во flash.
+ *
+ * Групповой Recall Scene приходит на каждый endpoint группы отдельно.
+ * Первый из них переключает все реле сцены, состоящие в группе, одной
+ * пачкой команд исполнителю (один проход задачи исполнителя); повтор
+ * того же кадра (адрес и TSN отправителя) на следующем endpoint только
+ * обновляет атрибуты. Одиночный Recall затрагивает только свой endpoint.
+ * Реле переключаются с источником RELAY_ORIGIN_SCENE, изменения
+ * отправляются в сеть отчетами.
+ *
+ * Ответы на команды отправляются только на одиночные (unicast) запросы.
+ * Имена сцен не поддерживаются (NameSupport = 0), Enhanced Add/View и
+ * Copy Scene отклоняются статусом UNSUP_CLUSTER_COMMAND.
+ *
+ * Атрибут SceneValid сбрасывается, когда реле уходит из состояния
+ * вызванной сцены: изменение приходит подписчику шины реле, а атрибут
+ * обновляется в контексте задачи Zigbee при обработке следующей входящей
+ * команды ZCL - до того, как стек ответит на чтение атрибута.
+ *
+ * Все функции, кроме scenes_server_get_table/get_stats, вызываются только
+ * из контекста задачи Zigbee.
+ */
+
+#ifndef SCENES_SERVER_H
+#define SCENES_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+#include "device_config.h"
+
+#define SCENES_NVS_NAMESPACE        "scenes"
+#define SCENES_NVS_KEY              "table"
+
+#define SCENES_TABLE_SIZE           16      // Емкость таблицы сцен (на все endpoint)
+#define SCENES_COMMIT_MS            1000    // Задержка записи таблицы после последнего изменения
+
+/* Запись таблицы сцен (формат хранения в NVS) */
+typedef struct {
+    uint16_t group_id;               // Группа (0 - сцена без группы)
+    uint8_t scene_id;                // Сцена
+    uint8_t member_mask;             // Реле, для которых сцена задана (бит 0 - реле 1)
+    uint8_t on_off_mask;             // Реле, для которых в сцене есть состояние On/Off
+    uint8_t state_mask;              // Состояние реле в сцене (бит установлен - включено)
+    uint16_t transition_time;        // Время перехода (с), не применяется к реле
+} scenes_entry_t;
+
+/* Статистика */
+typedef struct {
+    uint32_t stored;                 // Add Scene / Store Scene
+    uint32_t removed;                // Удалено сцен (Remove / Remove All)
+    uint32_t recalled;               // Выполнено Recall Scene
+    uint32_t recall_merged;          // Повторов группового Recall на следующем endpoint
+    uint32_t not_found;              // Команд к несуществующей сцене
+    uint32_t table_full;             // Отказов из-за заполненной таблицы
+    uint32_t nvs_writes;             // Записей таблицы в NVS
+    uint32_t nvs_errors;             // Ошибок записи
+} scenes_server_stats_t;
+
+/**
+ * @brief Загрузка таблицы из NVS и подписка на шину реле
+ *
+ * Вызывается после nvs_flash_init() и до запуска исполнителя реле.
+ *
+ * @return ESP_OK при успехе
+ */
+esp_err_t scenes_server_init(void);
+
+/**
+ * @brief Добавление атрибутов кластера Scenes (значения из таблицы)
+ * @param scenes_cluster Список атрибутов кластера Scenes
+ * @param relay_num Реле endpoint кластера (1..RELAY_COUNT)
+ */
+void scenes_server_add_attrs(esp_zb_attribute_list_t *scenes_cluster, uint8_t relay_num);
+
+/**
+ * @brief Обработчик raw-команд ZCL
+ *
+ * Вызывается для каждой входящей команды (сначала синхронизирует
+ * SceneValid), обрабатывает команды кластера Scenes.
+ *
+ * @param bufid Буфер команды
+ * @return true - команда обработана, ответ отправлен
+ */
+bool scenes_server_raw_command_handler(uint8_t bufid);
+
+/**
+ * @brief Удаление сцен группы (endpoint удален из группы)
+ * @param group_id Группа
+ * @param relay_mask Реле, чьи сцены удаляются (бит 0 - реле 1)
+ */
+void scenes_server_remove_group(uint16_t group_id, uint8_t relay_mask);
+
+/**
+ * @brief Копия таблицы сцен (для консоли)
+ * @param entries Буфер на SCENES_TABLE_SIZE записей
+ * @return Количество записей
+ */
+size_t scenes_server_get_table(scenes_entry_t *entries);
+
+/**
+ * @brief Получение статистики
+ * @param stats Буфер для статистики
+ */
+void scenes_server_get_stats(scenes_server_stats_t *stats);
+
+#endif // SCENES_SERVER_H
@@ -0,0 +1,108 @@
+/*
+ * Status Seqlock
+ *
+ * Счетчик версий для чтения небольшой структуры без блокировок.
+ * Писатель делает счетчик нечетным на время изменения, читатель копирует
+ * данные и повторяет копирование, если запись шла или завершилась за
+ * время копирования.
+ *
+ * Писатели сериализуются вызывающим кодом (в device_gpio.c - критической
+ * секцией). Модуль не зависит от ESP-IDF и проверяется на хосте
+ * несколькими сериализованными потоками-писателями против
+ * потоков-читателей, читающих через status_seqlock_read().
+ */
+
+#ifndef STATUS_SEQLOCK_H
+#define STATUS_SEQLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/* Действие перед повтором копирования. В прошивке писатель не вытесняется
+ * внутри критической секции и повтор сразу успешен; хостовый тест
+ * уступает процессор вытесненному писателю */
+#ifndef STATUS_SEQLOCK_RETRY_HOOK
+#define STATUS_SEQLOCK_RETRY_HOOK()     ((void)0)
+#endif
+
+/* Счетчик версий: нечетное значение - идет запись */
+typedef struct {
+    atomic_uint seq;
+} status_seqlock_t;
+
+#define STATUS_SEQLOCK_INITIALIZER  { 0 }
+
+/**
+ * @brief Начало записи (счетчик становится нечетным до изменения данных)
+ * @param lock Seqlock
+ */
+static inline void status_seqlock_write_begin(status_seqlock_t *lock)
+{
+    unsigned seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief Завершение записи (публикация новой версии)
+ * @param lock Seqlock
+ */
+static inline void status_seqlock_write_end(status_seqlock_t *lock)
+{
+    unsigned seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_release);
+}
+
+/**
+ * @brief Начало чтения
+ * @param lock Seqlock
+ * @return Версия, передаваемая в status_seqlock_read_retry()
+ */
+static inline unsigned status_seqlock_read_begin(status_seqlock_t *lock)
+{
+    return atomic_load_explicit(&lock->seq, memory_order_acquire);
+}
+
+/**
+ * @brief Проверка копии после чтения
+ * @param lock Seqlock
+ * @param seq Версия из status_seqlock_read_begin()
+ * @return true, если запись шла во время копирования и чтение нужно повторить
+ */
+static inline bool status_seqlock_read_retry(status_seqlock_t *lock, unsigned seq)
+{
+    /* Копия, начатая во время записи, недействительна */
+    if (seq & 1) {
+        return true;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&lock->seq, memory_order_relaxed) != seq;
+}
+
+/**
+ * @brief Согласованная копия данных под seqlock
+ *
+ * Копирование повторяется, пока оно не пройдет целиком между записями.
+ *
+ * @param lock Seqlock
+ * @param dst Буфер для копии
+ * @param src Данные, изменяемые писателями
+ * @param size Размер данных
+ * @return Версия копии (четная)
+ */
+static inline unsigned status_seqlock_read(status_seqlock_t *lock, void *dst, const volatile void *src, size_t size)
+{
+    for (;;) {
+        unsigned seq = status_seqlock_read_begin(lock);
+        for (size_t i = 0; i < size; i++) {
+            ((unsigned char *)dst)[i] = ((const volatile unsigned char *)src)[i];
+        }
+        if (!status_seqlock_read_retry(lock, seq)) {
+            return seq;
+        }
+        STATUS_SEQLOCK_RETRY_HOOK();
+    }
+}
+
+#endif // STATUS_SEQLOCK_H
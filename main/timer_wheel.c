@@ -0,0 +1,88 @@
+/*
+ * Timer Wheel
+ *
+ * Хешированное колесо таймеров (см. timer_wheel.h).
+ */
+
+#include <string.h>
+#include "timer_wheel.h"
+
+#define TIMER_WHEEL_MASK    (TIMER_WHEEL_SLOTS - 1)
+
+_Static_assert((TIMER_WHEEL_SLOTS & TIMER_WHEEL_MASK) == 0, "TIMER_WHEEL_SLOTS must be a power of two");
+
+void timer_wheel_init(timer_wheel_t *wheel)
+{
+    memset(wheel, 0, sizeof(*wheel));
+}
+
+void timer_wheel_entry_init(timer_wheel_entry_t *entry, timer_wheel_cb_t cb, void *arg)
+{
+    memset(entry, 0, sizeof(*entry));
+    entry->cb = cb;
+    entry->arg = arg;
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_entry_t *entry)
+{
+    if (!entry->active) {
+        return;
+    }
+
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        wheel->slots[entry->expires & TIMER_WHEEL_MASK] = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    }
+
+    entry->next = NULL;
+    entry->prev = NULL;
+    entry->active = false;
+    wheel->active--;
+}
+
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_entry_t *entry, uint32_t ticks)
+{
+    timer_wheel_cancel(wheel, entry);
+
+    entry->expires = wheel->now + (ticks != 0 ? ticks : 1);
+    timer_wheel_entry_t **slot = &wheel->slots[entry->expires & TIMER_WHEEL_MASK];
+
+    entry->prev = NULL;
+    entry->next = *slot;
+    if (*slot != NULL) {
+        (*slot)->prev = entry;
+    }
+    *slot = entry;
+    entry->active = true;
+    wheel->active++;
+}
+
+void timer_wheel_tick(timer_wheel_t *wheel)
+{
+    wheel->now++;
+
+    /* Обработчик может переставить или отменить любые таймеры слота,
+       поэтому после каждого срабатывания слот просматривается заново */
+    bool fired;
+    do {
+        fired = false;
+        for (timer_wheel_entry_t *entry = wheel->slots[wheel->now & TIMER_WHEEL_MASK];
+             entry != NULL; entry = entry->next) {
+            if (entry->expires == wheel->now) {
+                timer_wheel_cancel(wheel, entry);
+                entry->cb(entry, entry->arg);
+                fired = true;
+                break;
+            }
+        }
+    } while (fired);
+}
+
+uint32_t timer_wheel_remaining(const timer_wheel_t *wheel, const timer_wheel_entry_t *entry)
+{
+    return entry->active ? entry->expires - wheel->now : 0;
+}
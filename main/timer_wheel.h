@@ -0,0 +1,82 @@
+/*
+ * Timer Wheel
+ *
+ * Хешированное колесо таймеров: TIMER_WHEEL_SLOTS слотов по одному тику,
+ * таймер с моментом срабатывания T лежит в слоте T % TIMER_WHEEL_SLOTS в
+ * двусвязном списке. Постановка и отмена - O(1), тик просматривает
+ * только один слот. Таймеры длиннее оборота колеса остаются в слоте и
+ * срабатывают на том обороте, где совпадает момент срабатывания.
+ *
+ * Записи таймеров выделяет вызывающий код (обычно статически), колесо
+ * память не выделяет. Колесо не потокобезопасно: все вызовы выполняются
+ * из одного контекста (для кластера On/Off - задача Zigbee). Обработчик
+ * срабатывания может заново ставить или отменять любые таймеры.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMER_WHEEL_SLOTS   64      // Слотов в колесе (степень двойки)
+
+struct timer_wheel_entry;
+
+/* Обработчик срабатывания таймера */
+typedef void (*timer_wheel_cb_t)(struct timer_wheel_entry *entry, void *arg);
+
+/* Таймер */
+typedef struct timer_wheel_entry {
+    struct timer_wheel_entry *next;
+    struct timer_wheel_entry *prev;
+    uint32_t expires;                // Тик срабатывания
+    timer_wheel_cb_t cb;             // Обработчик
+    void *arg;                       // Аргумент обработчика
+    bool active;                     // Таймер стоит в колесе
+} timer_wheel_entry_t;
+
+/* Колесо таймеров */
+typedef struct {
+    timer_wheel_entry_t *slots[TIMER_WHEEL_SLOTS];
+    uint32_t now;                    // Текущий тик
+    uint32_t active;                 // Активных таймеров
+} timer_wheel_t;
+
+/**
+ * @brief Инициализация колеса
+ */
+void timer_wheel_init(timer_wheel_t *wheel);
+
+/**
+ * @brief Инициализация записи таймера
+ * @param entry Таймер
+ * @param cb Обработчик срабатывания
+ * @param arg Аргумент обработчика
+ */
+void timer_wheel_entry_init(timer_wheel_entry_t *entry, timer_wheel_cb_t cb, void *arg);
+
+/**
+ * @brief Постановка таймера (активный таймер переставляется)
+ * @param wheel Колесо
+ * @param entry Таймер
+ * @param ticks Задержка в тиках (0 - на следующем тике)
+ */
+void timer_wheel_schedule(timer_wheel_t *wheel, timer_wheel_entry_t *entry, uint32_t ticks);
+
+/**
+ * @brief Отмена таймера (неактивный таймер игнорируется)
+ */
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_entry_t *entry);
+
+/**
+ * @brief Продвижение колеса на один тик и вызов сработавших таймеров
+ */
+void timer_wheel_tick(timer_wheel_t *wheel);
+
+/**
+ * @brief Тиков до срабатывания таймера (0 - таймер неактивен)
+ */
+uint32_t timer_wheel_remaining(const timer_wheel_t *wheel, const timer_wheel_entry_t *entry);
+
+#endif // TIMER_WHEEL_H
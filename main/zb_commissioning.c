@@ -0,0 +1,228 @@
+/*
+ * Zigbee Commissioning State Machine
+ *
+ * Автомат подключения к сети (см. zb_commissioning.h).
+ */
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_zigbee_core.h"
+#include "zb_commissioning.h"
+#include "zb_network_hint.h"
+#include "boot_profile.h"
+
+static const char *TAG = "ZB_COMM";
+
+static commissioning_stats_t s_stats = {
+    .state = COMMISSIONING_STATE_IDLE,
+};
+static uint32_t s_init_failures = 0;     // Неудачных инициализаций подряд
+static int64_t s_cycle_start_us = 0;     // Начало текущего цикла подключения
+static bool s_hint_attempt = false;      // Текущая попытка ограничена подсказкой сети
+
+uint32_t commissioning_backoff_ms(uint32_t attempt, uint32_t random)
+{
+    uint32_t window = COMMISSIONING_BACKOFF_BASE_MS;
+
+    /* Окно удваивается с каждой неудачей до COMMISSIONING_BACKOFF_MAX_MS */
+    for (uint32_t i = 1; i < attempt && window < COMMISSIONING_BACKOFF_MAX_MS; i++) {
+        window *= 2;
+    }
+    if (window > COMMISSIONING_BACKOFF_MAX_MS) {
+        window = COMMISSIONING_BACKOFF_MAX_MS;
+    }
+
+    /* Равный джиттер: [window/2, window] */
+    uint32_t half = window / 2;
+    return half + (half > 0 ? random % (half + 1) : 0);
+}
+
+static void commissioning_start_steering(void);
+
+/**
+ * @brief Alarm планировщика: повтор шага подключения
+ */
+static void commissioning_alarm_cb(uint8_t mode_mask)
+{
+    if (mode_mask == ESP_ZB_BDB_MODE_INITIALIZATION) {
+        s_stats.state = COMMISSIONING_STATE_INITIALIZING;
+        esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
+    } else {
+        commissioning_start_steering();
+    }
+}
+
+/**
+ * @brief Назначение повтора шага с экспоненциальной задержкой
+ */
+static void commissioning_schedule_retry(uint8_t mode_mask, uint32_t attempt)
+{
+    uint32_t delay_ms = commissioning_backoff_ms(attempt, esp_random());
+
+    s_stats.failures_total++;
+    s_stats.last_backoff_ms = delay_ms;
+    s_stats.state = COMMISSIONING_STATE_BACKOFF;
+
+    esp_zb_scheduler_alarm_cancel(commissioning_alarm_cb, mode_mask);
+    esp_zb_scheduler_alarm(commissioning_alarm_cb, mode_mask, delay_ms);
+
+    ESP_LOGI(TAG, "%s retry #%lu in %lu ms",
+             mode_mask == ESP_ZB_BDB_MODE_INITIALIZATION ? "Initialization" : "Steering",
+             (unsigned long)attempt, (unsigned long)delay_ms);
+}
+
+/**
+ * @brief Выбор каналов и сети для попытки steering
+ *
+ * Первая попытка цикла при наличии подсказки идет на одном канале и
+ * только в сеть с сохраненным расширенным PAN ID, остальные - по всем
+ * каналам в любую сеть.
+ *
+ * @param first_attempt Первая попытка цикла подключения
+ */
+static void commissioning_apply_scan_scope(bool first_attempt)
+{
+    static const esp_zb_ieee_addr_t any_ext_pan_id = {0};
+    zb_network_hint_t hint;
+
+    s_hint_attempt = first_attempt && zb_network_hint_get(&hint);
+
+    if (s_hint_attempt) {
+        uint32_t mask = zb_network_hint_channel_mask(&hint);
+        esp_zb_set_channel_mask(mask);
+        esp_zb_set_primary_network_channel_set(mask);
+        esp_zb_set_secondary_network_channel_set(mask);
+        esp_zb_set_extended_pan_id(hint.ext_pan_id);
+        s_stats.hint_attempts++;
+    } else {
+        esp_zb_set_channel_mask(ZB_NETWORK_HINT_ALL_CHANNELS);
+        esp_zb_set_primary_network_channel_set(ZB_NETWORK_HINT_ALL_CHANNELS);
+        esp_zb_set_secondary_network_channel_set(ZB_NETWORK_HINT_ALL_CHANNELS);
+        esp_zb_set_extended_pan_id(any_ext_pan_id);
+    }
+}
+
+/**
+ * @brief Запуск очередной попытки network steering
+ */
+static void commissioning_start_steering(void)
+{
+    s_stats.state = COMMISSIONING_STATE_STEERING;
+    s_stats.attempts_total++;
+    s_stats.attempts_current++;
+
+    commissioning_apply_scan_scope(s_stats.attempts_current == 1);
+
+    ESP_LOGI(TAG, "Network steering attempt %lu (%s)", (unsigned long)s_stats.attempts_current,
+             s_hint_attempt ? "hinted channel" : "all channels");
+
+    esp_err_t err = esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start network steering: %s", esp_err_to_name(err));
+        commissioning_schedule_retry(ESP_ZB_BDB_MODE_NETWORK_STEERING, s_stats.attempts_current);
+    }
+}
+
+/**
+ * @brief Фиксация успешного подключения
+ */
+static void commissioning_joined(void)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    s_stats.state = COMMISSIONING_STATE_JOINED;
+    s_stats.joins++;
+    s_stats.last_join_hinted = s_hint_attempt;
+    if (s_hint_attempt) {
+        s_stats.hint_hits++;
+        s_hint_attempt = false;
+    }
+    s_stats.last_join_attempts = s_stats.attempts_current;
+    s_stats.last_time_to_join_ms = (uint32_t)((now_us - s_cycle_start_us) / 1000);
+    if (s_stats.boot_to_join_ms == 0) {
+        s_stats.boot_to_join_ms = (uint32_t)(now_us / 1000);
+    }
+    s_stats.attempts_current = 0;
+
+    ESP_LOGI(TAG, "Joined after %lu attempt(s), %lu ms (boot to join %lu ms%s)",
+             (unsigned long)s_stats.last_join_attempts, (unsigned long)s_stats.last_time_to_join_ms,
+             (unsigned long)s_stats.boot_to_join_ms, s_stats.last_join_hinted ? ", hinted channel" : "");
+
+    zb_network_hint_save_current();
+
+    boot_profile_mark(BOOT_MILESTONE_JOINED);
+    boot_profile_publish();
+}
+
+void commissioning_start(void)
+{
+    s_cycle_start_us = esp_timer_get_time();
+    s_stats.state = COMMISSIONING_STATE_INITIALIZING;
+    esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_INITIALIZATION);
+}
+
+void commissioning_on_init_done(bool success)
+{
+    if (!success) {
+        commissioning_schedule_retry(ESP_ZB_BDB_MODE_INITIALIZATION, ++s_init_failures);
+        return;
+    }
+
+    s_init_failures = 0;
+    commissioning_start_steering();
+}
+
+void commissioning_on_steering_done(bool success)
+{
+    if (success) {
+        commissioning_joined();
+    } else if (s_hint_attempt) {
+        /* Сеть не найдена на сохраненном канале - сразу сканируем все каналы */
+        s_stats.hint_fallbacks++;
+        ESP_LOGI(TAG, "Hinted channel failed, falling back to all channels");
+        commissioning_start_steering();
+    } else {
+        commissioning_schedule_retry(ESP_ZB_BDB_MODE_NETWORK_STEERING, s_stats.attempts_current);
+    }
+}
+
+void commissioning_on_rejoined(void)
+{
+    esp_zb_scheduler_alarm_cancel(commissioning_alarm_cb, ESP_ZB_BDB_MODE_NETWORK_STEERING);
+    commissioning_joined();
+}
+
+void commissioning_on_network_lost(void)
+{
+    if (s_stats.state != COMMISSIONING_STATE_JOINED) {
+        return;  // Цикл подключения уже идет
+    }
+
+    s_cycle_start_us = esp_timer_get_time();
+    s_stats.attempts_current = 0;
+    commissioning_start_steering();
+}
+
+void commissioning_get_stats(commissioning_stats_t *stats)
+{
+    *stats = s_stats;
+}
+
+const char *commissioning_state_to_string(commissioning_state_t state)
+{
+    switch (state) {
+    case COMMISSIONING_STATE_IDLE:
+        return "idle";
+    case COMMISSIONING_STATE_INITIALIZING:
+        return "initializing";
+    case COMMISSIONING_STATE_STEERING:
+        return "steering";
+    case COMMISSIONING_STATE_BACKOFF:
+        return "backoff";
+    case COMMISSIONING_STATE_JOINED:
+        return "joined";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * Zigbee Commissioning State Machine
+ *
+ * Автомат подключения к сети (инициализация стека -> network steering ->
+ * в сети). Все повторы выполняются через esp_zb_scheduler_alarm, поэтому
+ * задача Zigbee никогда не блокируется ожиданием.
+ *
+ * Интервал повтора растет экспоненциально с "равным" джиттером:
+ * задержка = половина окна + случайная добавка до половины окна, где
+ * окно = COMMISSIONING_BACKOFF_BASE_MS * 2^(попытка-1), но не больше
+ * COMMISSIONING_BACKOFF_MAX_MS. После перезагрузки координатора роутеры
+ * здания расходятся по времени и не повторяют steering синхронно.
+ *
+ * Первая попытка каждого цикла использует подсказку сети (zb_network_hint):
+ * один сохраненный канал и расширенный PAN ID. После ее неудачи steering
+ * по всем каналам запускается сразу, без паузы повтора.
+ *
+ * Все функции вызываются только из контекста задачи Zigbee
+ * (обработчик сигналов, alarm планировщика).
+ */
+
+#ifndef ZB_COMMISSIONING_H
+#define ZB_COMMISSIONING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Параметры повторов */
+#define COMMISSIONING_BACKOFF_BASE_MS   2000    // Окно первого повтора
+#define COMMISSIONING_BACKOFF_MAX_MS    300000  // Максимальное окно (5 минут)
+
+/* Состояние автомата */
+typedef enum {
+    COMMISSIONING_STATE_IDLE = 0,    // Стек не запущен
+    COMMISSIONING_STATE_INITIALIZING, // Инициализация BDB
+    COMMISSIONING_STATE_STEERING,    // Идет network steering
+    COMMISSIONING_STATE_BACKOFF,     // Ожидание повтора
+    COMMISSIONING_STATE_JOINED,      // Устройство в сети
+    COMMISSIONING_STATE_MAX
+} commissioning_state_t;
+
+/* Статистика подключения */
+typedef struct {
+    commissioning_state_t state;     // Текущее состояние
+    uint32_t attempts_total;         // Всего попыток steering с момента загрузки
+    uint32_t attempts_current;       // Попыток в текущем цикле подключения
+    uint32_t failures_total;         // Неудачных попыток (steering и инициализация)
+    uint32_t joins;                  // Успешных подключений
+    uint32_t last_backoff_ms;        // Последняя назначенная задержка повтора
+    uint32_t last_join_attempts;     // Попыток, потребовавшихся для последнего подключения
+    uint32_t last_time_to_join_ms;   // Длительность последнего цикла подключения
+    uint32_t boot_to_join_ms;        // Время от загрузки до первого подключения (0 - еще не было)
+    uint32_t hint_attempts;          // Попыток на канале из подсказки сети
+    uint32_t hint_hits;              // Подключений с первой попытки на канале из подсказки
+    uint32_t hint_fallbacks;         // Переходов к сканированию всех каналов
+    bool last_join_hinted;           // Последнее подключение - по подсказке
+} commissioning_stats_t;
+
+/**
+ * @brief Задержка повтора для попытки
+ *
+ * Чистая функция (без ESP-IDF), может проверяться на хосте.
+ *
+ * @param attempt Номер неудачной попытки (1 - первая)
+ * @param random Случайное число для джиттера
+ * @return Задержка в мс
+ */
+uint32_t commissioning_backoff_ms(uint32_t attempt, uint32_t random);
+
+/**
+ * @brief Запуск инициализации стека (ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP)
+ */
+void commissioning_start(void);
+
+/**
+ * @brief Результат инициализации (DEVICE_FIRST_START / DEVICE_REBOOT)
+ * @param success true - инициализация успешна, можно начинать steering
+ */
+void commissioning_on_init_done(bool success);
+
+/**
+ * @brief Результат network steering (ESP_ZB_BDB_SIGNAL_STEERING)
+ * @param success true - устройство подключилось к сети
+ */
+void commissioning_on_steering_done(bool success);
+
+/**
+ * @brief Подключение восстановлено без steering (TC rejoin)
+ */
+void commissioning_on_rejoined(void);
+
+/**
+ * @brief Устройство покинуло сеть - начать новый цикл подключения
+ */
+void commissioning_on_network_lost(void);
+
+/**
+ * @brief Получение статистики подключения
+ * @param stats Буфер для статистики
+ */
+void commissioning_get_stats(commissioning_stats_t *stats);
+
+/**
+ * @brief Название состояния автомата
+ */
+const char *commissioning_state_to_string(commissioning_state_t state);
+
+#endif // ZB_COMMISSIONING_H
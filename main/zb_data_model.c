@@ -0,0 +1,246 @@
+/*
+ * Zigbee Data Model
+ *
+ * Описания endpoints во flash и их построение (см. zb_data_model.h).
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "zb_data_model.h"
+#include "device_config.h"
+#include "boot_profile.h"
+#include "latency_trace.h"
+#include "relay_state_store.h"
+#include "on_off_server.h"
+#include "on_off_client.h"
+#include "scenes_server.h"
+#include "gesture_map.h"
+#include "zb_time_sync.h"
+
+static const char *TAG = "ZB_DATA_MODEL";
+
+/* ZCL-строка во flash: байт длины и символы без завершающего нуля */
+#define ZB_DM_STRING(name, text) \
+    static const struct { uint8_t length; char data[sizeof(text) - 1]; } name = { sizeof(text) - 1, text }
+
+/* Константный атрибут */
+typedef struct {
+    uint16_t attr_id;                // Атрибут
+    const void *value;               // Значение по умолчанию (копируется стеком)
+} zb_dm_attr_t;
+
+/* Кластер endpoint реле */
+typedef struct {
+    uint16_t cluster_id;             // Кластер
+    uint8_t role;                    // esp_zb_zcl_cluster_role_t
+    uint8_t relay_cluster;           // Нужный бит RELAY_CLUSTER_* канала (0 - на каждом канале)
+    uint8_t relay_num;               // Только на endpoint этого реле (0 - на каждом)
+    uint8_t attr_count;              // Константных атрибутов
+    const zb_dm_attr_t *attrs;       // Константные атрибуты
+    /* Добавление атрибута стандартного кластера (esp_zb_*_cluster_add_attr) */
+    esp_err_t (*add_attr)(esp_zb_attribute_list_t *attr_list, uint16_t attr_id, void *value_p);
+    /* Атрибуты со значениями времени выполнения (NULL - нет) */
+    void (*add_runtime_attrs)(esp_zb_attribute_list_t *attr_list, uint8_t relay_num);
+    /* Добавление кластера в список (esp_zb_cluster_list_add_*_cluster) */
+    esp_err_t (*add_cluster)(esp_zb_cluster_list_t *cluster_list, esp_zb_attribute_list_t *attr_list,
+                             uint8_t role_mask);
+    /* Кластер целиком строит модуль-владелец (остальные поля не используются) */
+    void (*build)(esp_zb_cluster_list_t *cluster_list);
+} zb_dm_cluster_t;
+
+/* Значения по умолчанию */
+static const uint8_t s_zcl_version = ESP_ZB_ZCL_BASIC_ZCL_VERSION_DEFAULT_VALUE;
+static const uint8_t s_power_source = ESP_ZB_ZCL_BASIC_POWER_SOURCE_MAINS_SINGLE_PHASE;  // Питание от сети 220V
+static const uint16_t s_identify_time = ESP_ZB_ZCL_IDENTIFY_IDENTIFY_TIME_DEFAULT_VALUE;
+static const uint8_t s_groups_name_support = 0;
+ZB_DM_STRING(s_manufacturer_name, DEVICE_MANUFACTURER);
+ZB_DM_STRING(s_model_identifier, DEVICE_MODEL);
+
+static const zb_dm_attr_t s_basic_attrs[] = {
+    { ESP_ZB_ZCL_ATTR_BASIC_ZCL_VERSION_ID, &s_zcl_version },
+    { ESP_ZB_ZCL_ATTR_BASIC_POWER_SOURCE_ID, &s_power_source },
+    { ESP_ZB_ZCL_ATTR_BASIC_MANUFACTURER_NAME_ID, &s_manufacturer_name },
+    { ESP_ZB_ZCL_ATTR_BASIC_MODEL_IDENTIFIER_ID, &s_model_identifier },
+};
+
+static const zb_dm_attr_t s_identify_attrs[] = {
+    { ESP_ZB_ZCL_ATTR_IDENTIFY_IDENTIFY_TIME_ID, &s_identify_time },
+};
+
+static const zb_dm_attr_t s_groups_attrs[] = {
+    { ESP_ZB_ZCL_ATTR_GROUPS_NAME_SUPPORT_ID, &s_groups_name_support },
+};
+
+static void zb_dm_basic_runtime_attrs(esp_zb_attribute_list_t *attr_list, uint8_t relay_num);
+static void zb_dm_on_off_runtime_attrs(esp_zb_attribute_list_t *attr_list, uint8_t relay_num);
+
+#define ZB_DM_ATTRS(table)  (uint8_t)(sizeof(table) / sizeof(table[0])), (table)
+
+/* Кластеры endpoint реле (в порядке добавления) */
+static const zb_dm_cluster_t s_clusters[] = {
+    { ESP_ZB_ZCL_CLUSTER_ID_BASIC, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, 0, 0, ZB_DM_ATTRS(s_basic_attrs),
+      esp_zb_basic_cluster_add_attr, zb_dm_basic_runtime_attrs, esp_zb_cluster_list_add_basic_cluster, NULL },
+    { ESP_ZB_ZCL_CLUSTER_ID_IDENTIFY, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, 0, 0, ZB_DM_ATTRS(s_identify_attrs),
+      esp_zb_identify_cluster_add_attr, NULL, esp_zb_cluster_list_add_identify_cluster, NULL },
+    { ESP_ZB_ZCL_CLUSTER_ID_GROUPS, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, RELAY_CLUSTER_GROUPS, 0,
+      ZB_DM_ATTRS(s_groups_attrs),
+      esp_zb_groups_cluster_add_attr, NULL, esp_zb_cluster_list_add_groups_cluster, NULL },
+    { ESP_ZB_ZCL_CLUSTER_ID_SCENES, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, RELAY_CLUSTER_SCENES, 0, 0, NULL,
+      NULL, scenes_server_add_attrs, esp_zb_cluster_list_add_scenes_cluster, NULL },
+    { ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, 0, 0, 0, NULL,
+      NULL, zb_dm_on_off_runtime_attrs, esp_zb_cluster_list_add_on_off_cluster, NULL },
+    /* Клиент On/Off - кнопка управляет привязанными устройствами */
+    { ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE, RELAY_CLUSTER_ON_OFF_CLIENT, 0, 0, NULL,
+      NULL, NULL, NULL, on_off_client_add_cluster },
+    /* Настройка жестов кнопки (manufacturer-specific), GESTURE_MAP_ENDPOINT */
+    { GESTURE_MAP_CLUSTER_ID, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, 0, 1, 0, NULL,
+      NULL, NULL, NULL, gesture_map_add_cluster },
+    /* Клиент Time - часы для недельного расписания, ZB_TIME_SYNC_ENDPOINT */
+    { ESP_ZB_ZCL_CLUSTER_ID_TIME, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE, 0, 1, 0, NULL,
+      NULL, NULL, NULL, zb_time_sync_add_cluster },
+};
+
+#define ZB_DM_CLUSTER_COUNT     (sizeof(s_clusters) / sizeof(s_clusters[0]))
+
+static zb_data_model_stats_t s_stats;
+
+/* Замер кучи вокруг построения */
+typedef struct {
+    int64_t start_us;
+    multi_heap_info_t before;
+} zb_dm_measure_t;
+
+/**
+ * @brief Manufacturer-specific атрибуты диагностики Basic кластера
+ */
+static void zb_dm_basic_runtime_attrs(esp_zb_attribute_list_t *attr_list, uint8_t relay_num)
+{
+    uint8_t endpoint = relay_channel_endpoint(relay_num);
+
+    /* Профиль загрузки */
+    if (endpoint == BOOT_PROFILE_ENDPOINT) {
+        boot_profile_add_attr(attr_list);
+    }
+
+    /* Гистограммы задержки команд */
+    if (endpoint == LATENCY_TRACE_ENDPOINT) {
+        latency_trace_add_attr(attr_list);
+    }
+}
+
+/**
+ * @brief Состояние реле после восстановления и StartUpOnOff, таймеры On/Off
+ *
+ * Endpoints строятся до запуска исполнителя реле, поэтому состояние
+ * берется из хранилища - то же, что применит relay_state_store_restore().
+ */
+static void zb_dm_on_off_runtime_attrs(esp_zb_attribute_list_t *attr_list, uint8_t relay_num)
+{
+    bool on_off_state = relay_state_store_startup_state(relay_num) == RELAY_ON;
+    uint8_t start_up_on_off = relay_state_store_get_startup(relay_num);
+
+    esp_zb_on_off_cluster_add_attr(attr_list, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, &on_off_state);
+    esp_zb_on_off_cluster_add_attr(attr_list, ESP_ZB_ZCL_ATTR_ON_OFF_START_UP_ON_OFF, &start_up_on_off);
+    on_off_server_add_attrs(attr_list);
+}
+
+/**
+ * @brief Кластер есть на endpoint реле
+ */
+static bool zb_dm_cluster_present(const zb_dm_cluster_t *cluster, uint8_t relay_num)
+{
+    if (cluster->relay_cluster != 0 && !relay_channel_has_cluster(relay_num, cluster->relay_cluster)) {
+        return false;
+    }
+    return cluster->relay_num == 0 || cluster->relay_num == relay_num;
+}
+
+/**
+ * @brief Создание кластера по описанию
+ */
+static void zb_dm_add_cluster(esp_zb_cluster_list_t *cluster_list, const zb_dm_cluster_t *cluster,
+                              uint8_t relay_num)
+{
+    s_stats.clusters++;
+
+    if (cluster->build != NULL) {
+        cluster->build(cluster_list);
+        return;
+    }
+
+    esp_zb_attribute_list_t *attr_list = esp_zb_zcl_attr_list_create(cluster->cluster_id);
+    for (uint8_t i = 0; i < cluster->attr_count; i++) {
+        const zb_dm_attr_t *attr = &cluster->attrs[i];
+        /* Стек копирует значение, константа во flash не изменяется */
+        cluster->add_attr(attr_list, attr->attr_id, (void *)attr->value);
+        s_stats.attrs++;
+    }
+    if (cluster->add_runtime_attrs != NULL) {
+        cluster->add_runtime_attrs(attr_list, relay_num);
+    }
+    cluster->add_cluster(cluster_list, attr_list, cluster->role);
+}
+
+/**
+ * @brief Начало замера кучи
+ */
+static void zb_dm_measure_begin(zb_dm_measure_t *measure)
+{
+    measure->start_us = esp_timer_get_time();
+    heap_caps_get_info(&measure->before, MALLOC_CAP_DEFAULT);
+}
+
+/**
+ * @brief Окончание замера кучи: занято байт, выделено блоков, время
+ */
+static void zb_dm_measure_end(const zb_dm_measure_t *measure, int32_t *heap_bytes, int32_t *heap_blocks,
+                              uint32_t *build_us)
+{
+    multi_heap_info_t after;
+
+    heap_caps_get_info(&after, MALLOC_CAP_DEFAULT);
+    *heap_bytes = (int32_t)measure->before.total_free_bytes - (int32_t)after.total_free_bytes;
+    *heap_blocks = (int32_t)after.allocated_blocks - (int32_t)measure->before.allocated_blocks;
+    *build_us = (uint32_t)(esp_timer_get_time() - measure->start_us);
+}
+
+esp_zb_ep_list_t *zb_data_model_create(void)
+{
+    zb_dm_measure_t measure;
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    zb_dm_measure_begin(&measure);
+
+    esp_zb_ep_list_t *ep_list = esp_zb_ep_list_create();
+    for (uint8_t relay_num = 1; relay_num <= RELAY_COUNT; relay_num++) {
+        esp_zb_cluster_list_t *cluster_list = esp_zb_zcl_cluster_list_create();
+        for (size_t i = 0; i < ZB_DM_CLUSTER_COUNT; i++) {
+            if (zb_dm_cluster_present(&s_clusters[i], relay_num)) {
+                zb_dm_add_cluster(cluster_list, &s_clusters[i], relay_num);
+            }
+        }
+
+        esp_zb_endpoint_config_t endpoint_config = {
+            .endpoint = relay_channel_endpoint(relay_num),
+            .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
+            .app_device_id = ESP_ZB_HA_ON_OFF_LIGHT_DEVICE_ID,
+            .app_device_version = 1,
+        };
+        esp_zb_ep_list_add_ep(ep_list, cluster_list, endpoint_config);
+        s_stats.endpoints++;
+    }
+
+    zb_dm_measure_end(&measure, &s_stats.heap_bytes, &s_stats.heap_blocks, &s_stats.build_us);
+
+    ESP_LOGI(TAG, "%d endpoints, %d clusters, %d constant attributes: %ld heap bytes in %ld blocks, %lu us",
+             s_stats.endpoints, s_stats.clusters, s_stats.attrs,
+             (long)s_stats.heap_bytes, (long)s_stats.heap_blocks, (unsigned long)s_stats.build_us);
+    return ep_list;
+}
+
+void zb_data_model_get_stats(zb_data_model_stats_t *stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,58 @@
+/*
+ * Zigbee Data Model
+ *
+ * Построение endpoints устройства за один проход по константным
+ * описаниям во flash. Таблица кластеров endpoint реле задает кластер,
+ * роль, условие по каналу (RELAY_CHANNEL_TABLE или конкретный endpoint)
+ * и константные атрибуты со значениями по умолчанию. Значения, известные
+ * только во время выполнения (состояние реле, StartUpOnOff, число сцен,
+ * таблица жестов), добавляют модули-владельцы через функции из описания
+ * кластера.
+ *
+ * Константные значения, в том числе ZCL-строки Basic кластера в готовом
+ * формате "длина + данные", лежат во flash и копируются стеком при
+ * добавлении атрибута. Набор атрибутов каждого endpoint совпадает с
+ * прежним построением, включая ManufacturerName и ModelIdentifier.
+ *
+ * Кучу таблица не экономит: esp-zigbee-lib не принимает статические
+ * описания кластеров, списки атрибутов и копии значений стек выделяет
+ * в куче так же, как при прямых вызовах *_add_attr. Затраты кучи на
+ * построение (байты и блоки) измеряются до создания задач приложения и
+ * выводятся в журнал и консоль (boot profile).
+ */
+
+#ifndef ZB_DATA_MODEL_H
+#define ZB_DATA_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_zigbee_core.h"
+
+/* Статистика построения */
+typedef struct {
+    uint8_t endpoints;               // Создано endpoints
+    uint8_t clusters;                // Создано кластеров
+    uint16_t attrs;                  // Константных атрибутов из flash
+    int32_t heap_bytes;              // Занято кучи списками endpoints (с заголовками блоков)
+    int32_t heap_blocks;             // Выделено блоков кучи
+    uint32_t build_us;               // Время построения
+} zb_data_model_stats_t;
+
+/**
+ * @brief Создание endpoints всех каналов реле
+ *
+ * Вызывается после esp_zb_init() и on_off_server_init() до создания
+ * задач приложения и восстановления реле (состояние OnOff берется из
+ * relay_state_store); результат передается в esp_zb_device_register().
+ *
+ * @return Список endpoints
+ */
+esp_zb_ep_list_t *zb_data_model_create(void);
+
+/**
+ * @brief Получение статистики построения
+ * @param stats Буфер для статистики
+ */
+void zb_data_model_get_stats(zb_data_model_stats_t *stats);
+
+#endif // ZB_DATA_MODEL_H
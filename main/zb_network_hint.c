@@ -0,0 +1,102 @@
+/*
+ * Zigbee Network Hint
+ *
+ * Подсказка канала и PAN для быстрого подключения (см. zb_network_hint.h).
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "esp_zigbee_core.h"
+#include "zb_network_hint.h"
+
+static const char *TAG = "ZB_HINT";
+
+static zb_network_hint_t s_hint;
+
+/**
+ * @brief Проверка канала подсказки
+ */
+static bool zb_network_hint_valid(const zb_network_hint_t *hint)
+{
+    return hint->channel >= ZB_NETWORK_HINT_CHANNEL_MIN && hint->channel <= ZB_NETWORK_HINT_CHANNEL_MAX;
+}
+
+esp_err_t zb_network_hint_init(void)
+{
+    memset(&s_hint, 0, sizeof(s_hint));
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(ZB_NETWORK_HINT_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;  // Устройство еще не было в сети
+    } else if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open hint storage: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    size_t size = sizeof(s_hint);
+    err = nvs_get_blob(nvs_handle, ZB_NETWORK_HINT_NVS_KEY, &s_hint, &size);
+    nvs_close(nvs_handle);
+
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    } else if (err != ESP_OK || size != sizeof(s_hint) || !zb_network_hint_valid(&s_hint)) {
+        ESP_LOGW(TAG, "Discarding network hint: %s", err != ESP_OK ? esp_err_to_name(err) : "invalid");
+        memset(&s_hint, 0, sizeof(s_hint));
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Network hint: channel %d, PAN ID 0x%04hx", s_hint.channel, s_hint.pan_id);
+    return ESP_OK;
+}
+
+bool zb_network_hint_get(zb_network_hint_t *hint)
+{
+    *hint = s_hint;
+    return zb_network_hint_valid(hint);
+}
+
+void zb_network_hint_save_current(void)
+{
+    zb_network_hint_t hint;
+
+    memset(&hint, 0, sizeof(hint));
+    hint.channel = esp_zb_get_current_channel();
+    hint.pan_id = esp_zb_get_pan_id();
+    esp_zb_get_extended_pan_id(hint.ext_pan_id);
+
+    if (!zb_network_hint_valid(&hint)) {
+        return;
+    }
+    if (hint.channel == s_hint.channel && hint.pan_id == s_hint.pan_id &&
+        memcmp(hint.ext_pan_id, s_hint.ext_pan_id, sizeof(hint.ext_pan_id)) == 0) {
+        return;  // Сеть не изменилась - не тратим ресурс flash
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(ZB_NETWORK_HINT_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open hint storage: %s", esp_err_to_name(err));
+        return;
+    }
+
+    err = nvs_set_blob(nvs_handle, ZB_NETWORK_HINT_NVS_KEY, &hint, sizeof(hint));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save network hint: %s", esp_err_to_name(err));
+        return;
+    }
+
+    s_hint = hint;
+    ESP_LOGI(TAG, "Saved network hint: channel %d, PAN ID 0x%04hx", hint.channel, hint.pan_id);
+}
+
+uint32_t zb_network_hint_channel_mask(const zb_network_hint_t *hint)
+{
+    return 1UL << hint->channel;
+}
@@ -0,0 +1,67 @@
+/*
+ * Zigbee Network Hint
+ *
+ * Подсказка для быстрого повторного подключения: канал, PAN ID и
+ * расширенный PAN ID последней сети, в которой было устройство.
+ * Сохраняется в NVS при каждом подключении, если параметры изменились.
+ *
+ * Автомат подключения (zb_commissioning) делает первую попытку steering
+ * цикла только на сохраненном канале и только в сеть с сохраненным
+ * расширенным PAN ID. Если она не удалась, все следующие попытки идут по
+ * всем каналам (ZB_NETWORK_HINT_ALL_CHANNELS) без ограничения PAN.
+ */
+
+#ifndef ZB_NETWORK_HINT_H
+#define ZB_NETWORK_HINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#define ZB_NETWORK_HINT_NVS_NAMESPACE   "zb_hint"
+#define ZB_NETWORK_HINT_NVS_KEY         "network"
+
+/* Допустимые каналы 2.4 ГГц (11..26) */
+#define ZB_NETWORK_HINT_CHANNEL_MIN     11
+#define ZB_NETWORK_HINT_CHANNEL_MAX     26
+#define ZB_NETWORK_HINT_ALL_CHANNELS    0x07FFF800UL
+
+/* Параметры последней сети */
+typedef struct {
+    uint8_t channel;                 // Канал (0 - подсказки нет)
+    uint16_t pan_id;                 // PAN ID
+    uint8_t ext_pan_id[8];           // Расширенный PAN ID (little-endian)
+} zb_network_hint_t;
+
+/**
+ * @brief Загрузка подсказки из NVS
+ *
+ * Вызывается после nvs_flash_init().
+ *
+ * @return ESP_OK при успехе (в том числе если подсказки нет)
+ */
+esp_err_t zb_network_hint_init(void);
+
+/**
+ * @brief Текущая подсказка
+ * @param hint Буфер для подсказки
+ * @return true - подсказка есть и канал допустим
+ */
+bool zb_network_hint_get(zb_network_hint_t *hint);
+
+/**
+ * @brief Сохранение параметров текущей сети
+ *
+ * Вызывается из контекста задачи Zigbee после подключения. Запись во
+ * flash выполняется только при изменении параметров.
+ */
+void zb_network_hint_save_current(void);
+
+/**
+ * @brief Маска каналов для подсказки
+ * @param hint Подсказка
+ * @return Маска из одного канала
+ */
+uint32_t zb_network_hint_channel_mask(const zb_network_hint_t *hint);
+
+#endif // ZB_NETWORK_HINT_H
@@ -0,0 +1,122 @@
+/*
+ * Zigbee Time Sync
+ *
+ * Синхронизация часов с координатором (см. zb_time_sync.h).
+ */
+
+#include <time.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "relay_scheduler.h"
+#include "zb_time_sync.h"
+
+static const char *TAG = "ZB_TIME";
+
+#define ZB_TIME_INVALID     0xFFFFFFFFU
+
+static zb_time_sync_stats_t s_stats;
+
+/**
+ * @brief Запрос атрибутов кластера Time у координатора
+ */
+static void zb_time_sync_request(void)
+{
+    uint16_t attrs[] = {
+        ESP_ZB_ZCL_ATTR_TIME_LOCAL_TIME_ID,
+        ESP_ZB_ZCL_ATTR_TIME_TIME_ID,
+        ESP_ZB_ZCL_ATTR_TIME_TIME_ZONE_ID,
+    };
+
+    esp_zb_zcl_read_attr_cmd_t read_cmd = {0};
+    read_cmd.zcl_basic_cmd.dst_addr_u.addr_short = 0x0000; // Координатор
+    read_cmd.zcl_basic_cmd.dst_endpoint = 0x01;
+    read_cmd.zcl_basic_cmd.src_endpoint = ZB_TIME_SYNC_ENDPOINT;
+    read_cmd.address_mode = ESP_ZB_APS_ADDR_MODE_16_ENDP_PRESENT;
+    read_cmd.direction = ESP_ZB_ZCL_CMD_DIRECTION_TO_SRV;
+    read_cmd.clusterID = ESP_ZB_ZCL_CLUSTER_ID_TIME;
+    read_cmd.attr_number = sizeof(attrs) / sizeof(attrs[0]);
+    read_cmd.attr_field = attrs;
+
+    esp_zb_zcl_read_attr_cmd_req(&read_cmd);
+    s_stats.requests++;
+}
+
+/**
+ * @brief Alarm синхронизации: запрос и повтор, если ответа не будет
+ */
+static void zb_time_sync_alarm_cb(uint8_t param)
+{
+    zb_time_sync_request();
+    esp_zb_scheduler_alarm(zb_time_sync_alarm_cb, 0, ZB_TIME_SYNC_RETRY_MS);
+}
+
+void zb_time_sync_add_cluster(esp_zb_cluster_list_t *cluster_list)
+{
+    esp_zb_attribute_list_t *time_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_TIME);
+    esp_zb_cluster_list_add_time_cluster(cluster_list, time_cluster, ESP_ZB_ZCL_CLUSTER_CLIENT_ROLE);
+}
+
+void zb_time_sync_start(void)
+{
+    esp_zb_scheduler_alarm_cancel(zb_time_sync_alarm_cb, 0);
+    zb_time_sync_alarm_cb(0);
+}
+
+bool zb_time_sync_read_attr_resp_handler(const esp_zb_zcl_cmd_read_attr_resp_message_t *message)
+{
+    if (message->info.cluster != ESP_ZB_ZCL_CLUSTER_ID_TIME) {
+        return false;
+    }
+
+    uint32_t local_time = ZB_TIME_INVALID;
+    uint32_t utc_time = ZB_TIME_INVALID;
+    int32_t time_zone = 0;
+
+    for (esp_zb_zcl_read_attr_resp_variable_t *var = message->variables; var != NULL; var = var->next) {
+        if (var->status != ESP_ZB_ZCL_STATUS_SUCCESS || var->attribute.data.value == NULL) {
+            continue;
+        }
+        switch (var->attribute.id) {
+        case ESP_ZB_ZCL_ATTR_TIME_LOCAL_TIME_ID:
+            local_time = *(uint32_t *)var->attribute.data.value;
+            break;
+        case ESP_ZB_ZCL_ATTR_TIME_TIME_ID:
+            utc_time = *(uint32_t *)var->attribute.data.value;
+            break;
+        case ESP_ZB_ZCL_ATTR_TIME_TIME_ZONE_ID:
+            time_zone = *(int32_t *)var->attribute.data.value;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (local_time == ZB_TIME_INVALID || local_time == 0) {
+        if (utc_time == ZB_TIME_INVALID || utc_time == 0) {
+            ESP_LOGW(TAG, "Coordinator returned no valid time");
+            return true;  // Повтор по alarm
+        }
+        local_time = utc_time + time_zone;
+    }
+
+    time_t now = time(NULL);
+    time_t synced = (time_t)local_time + ZB_TIME_SYNC_EPOCH_OFFSET;
+    if (relay_scheduler_set_time(synced) != ESP_OK) {
+        ESP_LOGW(TAG, "Coordinator time is out of range");
+        return true;
+    }
+
+    s_stats.syncs++;
+    s_stats.last_correction_s = (int32_t)(synced - now);
+    s_stats.last_sync_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    ESP_LOGI(TAG, "Clock synced with coordinator (correction %ld s)", (long)s_stats.last_correction_s);
+
+    esp_zb_scheduler_alarm_cancel(zb_time_sync_alarm_cb, 0);
+    esp_zb_scheduler_alarm(zb_time_sync_alarm_cb, 0, ZB_TIME_SYNC_PERIOD_MS);
+    return true;
+}
+
+void zb_time_sync_get_stats(zb_time_sync_stats_t *stats)
+{
+    *stats = s_stats;
+}
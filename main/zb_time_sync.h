@@ -0,0 +1,61 @@
+/*
+ * Zigbee Time Sync
+ *
+ * Часы устройства для локального планировщика (relay_scheduler): после
+ * подключения к сети устройство читает у координатора атрибуты кластера
+ * Time (0x000A) - LocalTime, а при его отсутствии Time и TimeZone - и
+ * устанавливает локальное время. Дальше часы идут по системному таймеру,
+ * чтение повторяется раз в ZB_TIME_SYNC_PERIOD_MS для коррекции ухода
+ * кварца, а при отсутствии ответа - через ZB_TIME_SYNC_RETRY_MS.
+ *
+ * Для чтения на endpoint реле 1 добавляется клиентская роль кластера Time.
+ *
+ * Все функции вызываются только из контекста задачи Zigbee.
+ */
+
+#ifndef ZB_TIME_SYNC_H
+#define ZB_TIME_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_zigbee_core.h"
+#include "device_config.h"
+
+#define ZB_TIME_SYNC_ENDPOINT       relay_channel_endpoint(1)
+#define ZB_TIME_SYNC_PERIOD_MS      (6 * 3600 * 1000)   // Период повторной синхронизации
+#define ZB_TIME_SYNC_RETRY_MS       60000               // Повтор при отсутствии ответа
+#define ZB_TIME_SYNC_EPOCH_OFFSET   946684800           // Секунд между 1970-01-01 и 2000-01-01 (эпоха ZCL)
+
+/* Статистика синхронизации */
+typedef struct {
+    uint32_t requests;               // Отправлено запросов чтения
+    uint32_t syncs;                  // Успешных установок времени
+    int32_t last_correction_s;       // Поправка часов при последней синхронизации
+    uint32_t last_sync_ms;           // Время последней синхронизации с загрузки (0 - не было)
+} zb_time_sync_stats_t;
+
+/**
+ * @brief Добавление клиентского кластера Time в список кластеров endpoint
+ * @param cluster_list Список кластеров endpoint ZB_TIME_SYNC_ENDPOINT
+ */
+void zb_time_sync_add_cluster(esp_zb_cluster_list_t *cluster_list);
+
+/**
+ * @brief Запуск синхронизации (вызывается после подключения к сети)
+ */
+void zb_time_sync_start(void);
+
+/**
+ * @brief Обработка ответа на чтение атрибутов (ESP_ZB_CORE_CMD_READ_ATTR_RESP_CB_ID)
+ * @param message Ответ
+ * @return true - ответ относится к кластеру Time и обработан
+ */
+bool zb_time_sync_read_attr_resp_handler(const esp_zb_zcl_cmd_read_attr_resp_message_t *message);
+
+/**
+ * @brief Получение статистики синхронизации
+ * @param stats Буфер для статистики
+ */
+void zb_time_sync_get_stats(zb_time_sync_stats_t *stats);
+
+#endif // ZB_TIME_SYNC_H
@@ -0,0 +1,38 @@
+/*
+ * Host Test Helpers
+ *
+ * Минимальные проверки для хостовых тестов: проверка печатает место
+ * и выражение, тест продолжается, итог возвращается из main().
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int s_host_test_failures;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            s_host_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        long long _a = (long long)(actual); \
+        long long _e = (long long)(expected); \
+        if (_a != _e) { \
+            printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, \
+                   _a, _e); \
+            s_host_test_failures++; \
+        } \
+    } while (0)
+
+/* Итог теста - код возврата main() */
+#define HOST_TEST_RESULT() \
+    (printf("%s: %s\n", __FILE__, s_host_test_failures ? "FAILED" : "OK"), s_host_test_failures ? 1 : 0)
+
+#endif // HOST_TEST_H
@@ -0,0 +1,17 @@
+/*
+ * Заглушка driver/gpio.h для хостовых тестов
+ *
+ * Только типы, которые используют заголовки main/.
+ */
+
+#ifndef HOST_STUB_DRIVER_GPIO_H
+#define HOST_STUB_DRIVER_GPIO_H
+
+typedef enum {
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_1 = 1,
+    GPIO_NUM_18 = 18,
+    GPIO_NUM_19 = 19,
+} gpio_num_t;
+
+#endif // HOST_STUB_DRIVER_GPIO_H
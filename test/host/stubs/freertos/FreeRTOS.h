@@ -0,0 +1,14 @@
+/*
+ * Заглушка freertos/FreeRTOS.h для хостовых тестов
+ *
+ * Только типы, которые используют заголовки main/.
+ */
+
+#ifndef HOST_STUB_FREERTOS_H
+#define HOST_STUB_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#endif // HOST_STUB_FREERTOS_H
@@ -0,0 +1,211 @@
+/*
+ * Host Test: Button Debounce State Machine
+ *
+ * Прогон автомата button_fsm по временным линиям фронтов. Таймер окна
+ * блокировки эмулируется: по BUTTON_FSM_ARM_TIMER таймаут срабатывает
+ * через окно дребезга и получает уровень кнопки на этот момент.
+ */
+
+#include <stddef.h>
+#include "host_test.h"
+#include "button_fsm.h"
+
+/* Пороги прошивки (device_config.h на хосте не собирается) */
+#define TEST_DEBOUNCE_MS            50      // BUTTON_DEBOUNCE_TIME_MS
+#define TEST_LONG_PRESS_MS          3000    // BUTTON_LONG_PRESS_TIME_MS
+#define TEST_VERY_LONG_PRESS_MS     5000    // BUTTON_VERY_LONG_PRESS_TIME_MS
+
+#define TEST_T0_US                  1000000LL   // Начало временной линии
+#define TEST_MAX_EVENTS             8
+
+/* Фронт кнопки */
+typedef struct {
+    uint32_t at_us;                  // Смещение от начала линии (мкс)
+    bool pressed;                    // Уровень после фронта
+} test_edge_t;
+
+#define MS(ms)  ((uint32_t)(ms) * 1000)
+
+/**
+ * @brief Прогон временной линии фронтов через автомат
+ * @return Количество сформированных событий
+ */
+static size_t replay(const test_edge_t *edges, size_t count, button_event_t *events)
+{
+    button_fsm_t fsm;
+    button_event_t event;
+    bool level = false;
+    int64_t timer_at = -1;
+    size_t produced = 0;
+
+    button_fsm_init(&fsm, TEST_DEBOUNCE_MS, TEST_LONG_PRESS_MS, TEST_VERY_LONG_PRESS_MS, false);
+
+    for (size_t i = 0; i <= count; i++) {
+        int64_t edge_at = (i < count) ? TEST_T0_US + edges[i].at_us : INT64_MAX;
+
+        /* Таймауты окна блокировки до очередного фронта */
+        while (timer_at >= 0 && timer_at <= edge_at) {
+            int64_t now = timer_at;
+            timer_at = -1;
+            uint32_t flags = button_fsm_timeout(&fsm, level, now, &event);
+            if (flags & BUTTON_FSM_EVENT) {
+                CHECK(produced < TEST_MAX_EVENTS);
+                events[produced++] = event;
+            }
+            if (flags & BUTTON_FSM_ARM_TIMER) {
+                timer_at = now + MS(TEST_DEBOUNCE_MS);
+            }
+        }
+        if (i == count) {
+            break;
+        }
+
+        level = edges[i].pressed;
+        uint32_t flags = button_fsm_edge(&fsm, level, edge_at, &event);
+        if (flags & BUTTON_FSM_EVENT) {
+            CHECK(produced < TEST_MAX_EVENTS);
+            events[produced++] = event;
+        }
+        if (flags & BUTTON_FSM_ARM_TIMER) {
+            timer_at = edge_at + MS(TEST_DEBOUNCE_MS);
+        }
+    }
+
+    return produced;
+}
+
+/**
+ * @brief Одно чистое нажатие заданной длительности
+ */
+static void check_hold(uint32_t hold_ms, button_press_class_t expected)
+{
+    const test_edge_t edges[] = {
+        { 0, true },
+        { MS(hold_ms), false },
+    };
+    button_event_t events[TEST_MAX_EVENTS];
+
+    size_t n = replay(edges, sizeof(edges) / sizeof(edges[0]), events);
+    CHECK_EQ(n, 2);
+    CHECK_EQ(events[0].type, BUTTON_EVENT_PRESS);
+    CHECK_EQ(events[0].press_class, BUTTON_PRESS_NONE);
+    CHECK_EQ(events[1].type, BUTTON_EVENT_RELEASE);
+    CHECK_EQ(events[1].duration_ms, hold_ms);
+    if (events[1].press_class != expected) {
+        printf("hold %u ms: class %d, expected %d\n", (unsigned)hold_ms, events[1].press_class, expected);
+    }
+    CHECK_EQ(events[1].press_class, expected);
+}
+
+/* Дребезг на нажатии и отпускании внутри окна - одно событие на фронт */
+static void test_bounce_inside_window(void)
+{
+    const test_edge_t edges[] = {
+        { 0, true }, { 3000, false }, { 7000, true }, { 12000, false }, { 20000, true },
+        { MS(800), false }, { MS(800) + 4000, true }, { MS(800) + 9000, false }, { MS(800) + 30000, true },
+        { MS(800) + 45000, false },
+    };
+    button_event_t events[TEST_MAX_EVENTS];
+
+    size_t n = replay(edges, sizeof(edges) / sizeof(edges[0]), events);
+    CHECK_EQ(n, 2);
+    CHECK_EQ(events[0].type, BUTTON_EVENT_PRESS);
+    CHECK_EQ(events[0].timestamp_us, TEST_T0_US);
+    CHECK_EQ(events[1].type, BUTTON_EVENT_RELEASE);
+    CHECK_EQ(events[1].timestamp_us, TEST_T0_US + MS(800));
+    CHECK_EQ(events[1].duration_ms, 800);
+    CHECK_EQ(events[1].press_class, BUTTON_PRESS_SHORT);
+}
+
+/* Импульс короче окна: отпускание пропущено и принимается по таймауту */
+static void test_glitch_shorter_than_window(void)
+{
+    const test_edge_t edges[] = {
+        { 0, true },
+        { 20000, false },
+    };
+    button_event_t events[TEST_MAX_EVENTS];
+
+    size_t n = replay(edges, sizeof(edges) / sizeof(edges[0]), events);
+    CHECK_EQ(n, 2);
+    CHECK_EQ(events[1].type, BUTTON_EVENT_RELEASE);
+    CHECK_EQ(events[1].timestamp_us, TEST_T0_US + MS(TEST_DEBOUNCE_MS));
+    CHECK_EQ(events[1].duration_ms, TEST_DEBOUNCE_MS);
+    CHECK_EQ(events[1].press_class, BUTTON_PRESS_SHORT);
+}
+
+/* Фронт сразу после окна принимается без задержки */
+static void test_edge_after_window(void)
+{
+    const test_edge_t edges[] = {
+        { 0, true },
+        { MS(TEST_DEBOUNCE_MS) + 1000, false },
+    };
+    button_event_t events[TEST_MAX_EVENTS];
+
+    size_t n = replay(edges, sizeof(edges) / sizeof(edges[0]), events);
+    CHECK_EQ(n, 2);
+    CHECK_EQ(events[1].timestamp_us, TEST_T0_US + MS(TEST_DEBOUNCE_MS) + 1000);
+    CHECK_EQ(events[1].press_class, BUTTON_PRESS_SHORT);
+}
+
+/* Отпускание на границах порогов 3000 и 5000 мс */
+static void test_thresholds(void)
+{
+    check_hold(TEST_LONG_PRESS_MS - 1, BUTTON_PRESS_SHORT);
+    check_hold(TEST_LONG_PRESS_MS, BUTTON_PRESS_LONG);
+    check_hold(TEST_LONG_PRESS_MS + 1, BUTTON_PRESS_LONG);
+    check_hold(TEST_VERY_LONG_PRESS_MS - 1, BUTTON_PRESS_LONG);
+    check_hold(TEST_VERY_LONG_PRESS_MS, BUTTON_PRESS_VERY_LONG);
+    check_hold(TEST_VERY_LONG_PRESS_MS + 1, BUTTON_PRESS_VERY_LONG);
+}
+
+/* Удержание дольше порога очень длинного нажатия */
+static void test_beyond_very_long(void)
+{
+    check_hold(TEST_VERY_LONG_PRESS_MS * 2, BUTTON_PRESS_VERY_LONG);
+    check_hold(60000, BUTTON_PRESS_VERY_LONG);
+    check_hold(3600000, BUTTON_PRESS_VERY_LONG);
+}
+
+/* Дребезг отпускания после длинного нажатия не меняет классификацию */
+static void test_long_press_with_release_bounce(void)
+{
+    const test_edge_t edges[] = {
+        { 0, true },
+        { MS(TEST_LONG_PRESS_MS) + 500, false }, { MS(TEST_LONG_PRESS_MS) + 2500, true },
+        { MS(TEST_LONG_PRESS_MS) + 6000, false },
+    };
+    button_event_t events[TEST_MAX_EVENTS];
+
+    size_t n = replay(edges, sizeof(edges) / sizeof(edges[0]), events);
+    CHECK_EQ(n, 2);
+    CHECK_EQ(events[1].type, BUTTON_EVENT_RELEASE);
+    CHECK_EQ(events[1].duration_ms, TEST_LONG_PRESS_MS);
+    CHECK_EQ(events[1].press_class, BUTTON_PRESS_LONG);
+}
+
+/* Кнопка нажата при инициализации: первое событие - отпускание */
+static void test_pressed_at_init(void)
+{
+    button_fsm_t fsm;
+    button_event_t event;
+
+    button_fsm_init(&fsm, TEST_DEBOUNCE_MS, TEST_LONG_PRESS_MS, TEST_VERY_LONG_PRESS_MS, true);
+    CHECK_EQ(button_fsm_edge(&fsm, true, TEST_T0_US, &event), 0);
+    CHECK_EQ(button_fsm_edge(&fsm, false, TEST_T0_US + 1000, &event),
+             BUTTON_FSM_EVENT | BUTTON_FSM_ARM_TIMER);
+    CHECK_EQ(event.type, BUTTON_EVENT_RELEASE);
+}
+
+int main(void)
+{
+    test_bounce_inside_window();
+    test_glitch_shorter_than_window();
+    test_edge_after_window();
+    test_thresholds();
+    test_beyond_very_long();
+    test_long_press_with_release_bounce();
+    test_pressed_at_init();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,278 @@
+/*
+ * Host Test: Button Gesture Recognizer
+ *
+ * Распознаватель прогоняется по синтетическим временным линиям нажатий.
+ * Срок button_gesture_deadline() эмулируется как таймер задачи GPIO:
+ * истекший к моменту следующего события срок обрабатывается раньше
+ * события. Класс отпускания вычисляет автомат антидребезга с порогами
+ * прошивки.
+ */
+
+#include <stddef.h>
+#include "host_test.h"
+#include "button_gesture.h"
+
+/* Пороги прошивки (device_config.h, gesture_map.h) */
+#define TEST_LONG_PRESS_MS          3000    // BUTTON_LONG_PRESS_TIME_MS
+#define TEST_VERY_LONG_PRESS_MS     5000    // BUTTON_VERY_LONG_PRESS_TIME_MS
+#define TEST_MULTI_CLICK_MS         350     // GESTURE_MAP_DEFAULT_MULTI_CLICK_MS
+#define TEST_HOLD_MS                800     // GESTURE_MAP_DEFAULT_HOLD_MS
+
+#define TEST_T0_US                  1000000LL
+#define TEST_MAX_GESTURES           8
+
+#define MS(ms)  ((int64_t)(ms) * 1000)
+
+/* Принятый фронт кнопки */
+typedef struct {
+    uint32_t at_ms;                  // Время от начала линии
+    bool pressed;                    // Нажатие или отпускание
+} test_edge_t;
+
+/* Распознанный жест */
+typedef struct {
+    button_gesture_t gesture;
+    uint32_t at_ms;                  // Время распознавания от начала линии
+} test_gesture_t;
+
+static const button_gesture_config_t s_config_default = {
+    .multi_click_ms = TEST_MULTI_CLICK_MS,
+    .hold_ms = TEST_HOLD_MS,
+    .max_clicks = 3,
+    .hold_enabled = true,
+};
+
+static void record(test_gesture_t *gestures, size_t *count, button_gesture_t gesture, int64_t now_us)
+{
+    if (gesture == BUTTON_GESTURE_NONE) {
+        return;
+    }
+    CHECK(*count < TEST_MAX_GESTURES);
+    if (*count < TEST_MAX_GESTURES) {
+        gestures[(*count)++] = (test_gesture_t){ gesture, (uint32_t)((now_us - TEST_T0_US) / 1000) };
+    }
+}
+
+/**
+ * @brief Прогон временной линии через распознаватель
+ * @return Количество распознанных жестов
+ */
+static size_t replay(const button_gesture_config_t *config, const test_edge_t *edges, size_t count,
+                     test_gesture_t *gestures)
+{
+    button_fsm_t classifier;
+    button_gesture_fsm_t fsm;
+    size_t produced = 0;
+    int64_t press_us = 0;
+
+    button_fsm_init(&classifier, 50, TEST_LONG_PRESS_MS, TEST_VERY_LONG_PRESS_MS, false);
+    button_gesture_init(&fsm, config);
+
+    for (size_t i = 0; i <= count; i++) {
+        int64_t now = (i < count) ? TEST_T0_US + MS(edges[i].at_ms) : INT64_MAX - 1;
+
+        /* Истекшие сроки до события */
+        int64_t deadline;
+        while ((deadline = button_gesture_deadline(&fsm)) != BUTTON_GESTURE_NO_DEADLINE && deadline <= now) {
+            record(gestures, &produced, button_gesture_timeout(&fsm, deadline), deadline);
+        }
+        if (i == count) {
+            break;
+        }
+
+        button_event_t event = { .timestamp_us = now };
+        if (edges[i].pressed) {
+            event.type = BUTTON_EVENT_PRESS;
+            event.press_class = BUTTON_PRESS_NONE;
+            press_us = now;
+        } else {
+            event.type = BUTTON_EVENT_RELEASE;
+            event.duration_ms = (uint32_t)((now - press_us) / 1000);
+            event.press_class = button_fsm_classify(&classifier, event.duration_ms);
+        }
+        record(gestures, &produced, button_gesture_event(&fsm, &event), now);
+    }
+
+    return produced;
+}
+
+static void check_gestures(const char *name, const test_gesture_t *actual, size_t count,
+                           const test_gesture_t *expected, size_t expected_count)
+{
+    bool ok = count == expected_count;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = actual[i].gesture == expected[i].gesture && actual[i].at_ms == expected[i].at_ms;
+    }
+    if (!ok) {
+        printf("%s: got", name);
+        for (size_t i = 0; i < count; i++) {
+            printf(" %d@%u", actual[i].gesture, (unsigned)actual[i].at_ms);
+        }
+        printf(", expected");
+        for (size_t i = 0; i < expected_count; i++) {
+            printf(" %d@%u", expected[i].gesture, (unsigned)expected[i].at_ms);
+        }
+        printf("\n");
+    }
+    CHECK(ok);
+}
+
+#define COUNT(array) (sizeof(array) / sizeof(array[0]))
+
+#define CHECK_TIMELINE(name, config, edges, expected) \
+    do { \
+        test_gesture_t _actual[TEST_MAX_GESTURES]; \
+        size_t _n = replay(config, edges, COUNT(edges), _actual); \
+        check_gestures(name, _actual, _n, expected, COUNT(expected)); \
+    } while (0)
+
+/* Одиночный, двойной и тройной клики */
+static void test_clicks(void)
+{
+    const test_edge_t single[] = { { 0, true }, { 100, false } };
+    const test_gesture_t single_expected[] = { { BUTTON_GESTURE_SINGLE, 100 + TEST_MULTI_CLICK_MS } };
+    CHECK_TIMELINE("single", &s_config_default, single, single_expected);
+
+    const test_edge_t dbl[] = { { 0, true }, { 100, false }, { 300, true }, { 400, false } };
+    const test_gesture_t dbl_expected[] = { { BUTTON_GESTURE_DOUBLE, 400 + TEST_MULTI_CLICK_MS } };
+    CHECK_TIMELINE("double", &s_config_default, dbl, dbl_expected);
+
+    /* Третий клик - максимум, сообщается при отпускании без окна ожидания */
+    const test_edge_t triple[] = {
+        { 0, true }, { 100, false }, { 250, true }, { 350, false }, { 500, true }, { 600, false },
+    };
+    const test_gesture_t triple_expected[] = { { BUTTON_GESTURE_TRIPLE, 600 } };
+    CHECK_TIMELINE("triple", &s_config_default, triple, triple_expected);
+
+    /* Четвертое нажатие начинает новую серию */
+    const test_edge_t quad[] = {
+        { 0, true }, { 100, false }, { 250, true }, { 350, false }, { 500, true }, { 600, false },
+        { 700, true }, { 800, false },
+    };
+    const test_gesture_t quad_expected[] = {
+        { BUTTON_GESTURE_TRIPLE, 600 }, { BUTTON_GESTURE_SINGLE, 800 + TEST_MULTI_CLICK_MS },
+    };
+    CHECK_TIMELINE("quad", &s_config_default, quad, quad_expected);
+
+    /* Только одиночный клик в карте - без окна ожидания */
+    button_gesture_config_t config = s_config_default;
+    config.max_clicks = 1;
+    const test_gesture_t single_now[] = { { BUTTON_GESTURE_SINGLE, 100 } };
+    CHECK_TIMELINE("single, max 1", &config, single, single_now);
+
+    /* Двойной - максимум: сообщается на втором отпускании */
+    config.max_clicks = 2;
+    const test_gesture_t double_now[] = { { BUTTON_GESTURE_DOUBLE, 400 } };
+    CHECK_TIMELINE("double, max 2", &config, dbl, double_now);
+}
+
+/* Окно между кликами */
+static void test_inter_click_timeout(void)
+{
+    /* Нажатие за 1 мс до конца окна продолжает серию */
+    const test_edge_t inside[] = {
+        { 0, true }, { 100, false }, { 100 + TEST_MULTI_CLICK_MS - 1, true }, { 550, false },
+    };
+    const test_gesture_t inside_expected[] = { { BUTTON_GESTURE_DOUBLE, 550 + TEST_MULTI_CLICK_MS } };
+    CHECK_TIMELINE("inside window", &s_config_default, inside, inside_expected);
+
+    /* Нажатие в момент окончания окна - новая серия */
+    const test_edge_t at_deadline[] = {
+        { 0, true }, { 100, false }, { 100 + TEST_MULTI_CLICK_MS, true }, { 600, false },
+    };
+    const test_gesture_t at_deadline_expected[] = {
+        { BUTTON_GESTURE_SINGLE, 100 + TEST_MULTI_CLICK_MS }, { BUTTON_GESTURE_SINGLE, 600 + TEST_MULTI_CLICK_MS },
+    };
+    CHECK_TIMELINE("at deadline", &s_config_default, at_deadline, at_deadline_expected);
+
+    /* Окно отсчитывается от последнего отпускания, а не от начала серии */
+    const test_edge_t chained[] = {
+        { 0, true }, { 100, false }, { 400, true }, { 420, false },
+    };
+    const test_gesture_t chained_expected[] = { { BUTTON_GESTURE_DOUBLE, 420 + TEST_MULTI_CLICK_MS } };
+    CHECK_TIMELINE("chained", &s_config_default, chained, chained_expected);
+
+    /* Срок до окна не вызывает жест */
+    button_gesture_fsm_t fsm;
+    button_gesture_init(&fsm, &s_config_default);
+    button_event_t press = { .type = BUTTON_EVENT_PRESS, .timestamp_us = TEST_T0_US };
+    button_event_t release = { .type = BUTTON_EVENT_RELEASE, .press_class = BUTTON_PRESS_SHORT,
+                               .timestamp_us = TEST_T0_US + MS(100), .duration_ms = 100 };
+    CHECK_EQ(button_gesture_event(&fsm, &press), BUTTON_GESTURE_NONE);
+    CHECK_EQ(button_gesture_event(&fsm, &release), BUTTON_GESTURE_NONE);
+    CHECK_EQ(button_gesture_deadline(&fsm), TEST_T0_US + MS(100 + TEST_MULTI_CLICK_MS));
+    CHECK_EQ(button_gesture_timeout(&fsm, TEST_T0_US + MS(100 + TEST_MULTI_CLICK_MS) - 1), BUTTON_GESTURE_NONE);
+    CHECK_EQ(button_gesture_timeout(&fsm, TEST_T0_US + MS(100 + TEST_MULTI_CLICK_MS)), BUTTON_GESTURE_SINGLE);
+    CHECK_EQ(button_gesture_deadline(&fsm), BUTTON_GESTURE_NO_DEADLINE);
+}
+
+/* Удержание против клика */
+static void test_hold_vs_click(void)
+{
+    /* Отпускание за 1 мс до порога - клик */
+    const test_edge_t short_press[] = { { 0, true }, { TEST_HOLD_MS - 1, false } };
+    const test_gesture_t short_expected[] = {
+        { BUTTON_GESTURE_SINGLE, TEST_HOLD_MS - 1 + TEST_MULTI_CLICK_MS },
+    };
+    CHECK_TIMELINE("below hold", &s_config_default, short_press, short_expected);
+
+    /* Порог удержания сообщается без ожидания отпускания */
+    const test_edge_t hold[] = { { 0, true }, { 2000, false } };
+    const test_gesture_t hold_expected[] = {
+        { BUTTON_GESTURE_HOLD_START, TEST_HOLD_MS }, { BUTTON_GESTURE_HOLD_RELEASE, 2000 },
+    };
+    CHECK_TIMELINE("hold", &s_config_default, hold, hold_expected);
+
+    /* Удержание дольше порога пэйринга все равно завершается HOLD_RELEASE */
+    const test_edge_t hold_long[] = { { 0, true }, { TEST_LONG_PRESS_MS + 500, false } };
+    const test_gesture_t hold_long_expected[] = {
+        { BUTTON_GESTURE_HOLD_START, TEST_HOLD_MS }, { BUTTON_GESTURE_HOLD_RELEASE, TEST_LONG_PRESS_MS + 500 },
+    };
+    CHECK_TIMELINE("hold past pairing", &s_config_default, hold_long, hold_long_expected);
+
+    /* Удержание запрещено: нажатие короче порога пэйринга - клик */
+    button_gesture_config_t config = s_config_default;
+    config.hold_enabled = false;
+    const test_gesture_t no_hold_expected[] = { { BUTTON_GESTURE_SINGLE, 2000 + TEST_MULTI_CLICK_MS } };
+    CHECK_TIMELINE("hold disabled", &config, hold, no_hold_expected);
+
+    /* Удержание запрещено: нажатие пэйринга - не клик */
+    test_gesture_t actual[TEST_MAX_GESTURES];
+    CHECK_EQ(replay(&config, hold_long, COUNT(hold_long), actual), 0);
+}
+
+/* Удержание во время серии кликов отменяет серию */
+static void test_hold_cancels_multi_click(void)
+{
+    const test_edge_t edges[] = { { 0, true }, { 100, false }, { 300, true }, { 2000, false } };
+    const test_gesture_t expected[] = {
+        { BUTTON_GESTURE_HOLD_START, 300 + TEST_HOLD_MS }, { BUTTON_GESTURE_HOLD_RELEASE, 2000 },
+    };
+    CHECK_TIMELINE("hold after click", &s_config_default, edges, expected);
+
+    /* После удержания серия начинается заново */
+    const test_edge_t after[] = {
+        { 0, true }, { 100, false }, { 300, true }, { 2000, false }, { 2200, true }, { 2300, false },
+    };
+    const test_gesture_t after_expected[] = {
+        { BUTTON_GESTURE_HOLD_START, 300 + TEST_HOLD_MS }, { BUTTON_GESTURE_HOLD_RELEASE, 2000 },
+        { BUTTON_GESTURE_SINGLE, 2300 + TEST_MULTI_CLICK_MS },
+    };
+    CHECK_TIMELINE("click after hold", &s_config_default, after, after_expected);
+
+    /* Удержание запрещено: длинное нажатие пэйринга отменяет серию без жеста */
+    button_gesture_config_t config = s_config_default;
+    config.hold_enabled = false;
+    const test_edge_t pairing[] = { { 0, true }, { 100, false }, { 300, true }, { 300 + TEST_LONG_PRESS_MS, false } };
+    test_gesture_t actual[TEST_MAX_GESTURES];
+    CHECK_EQ(replay(&config, pairing, COUNT(pairing), actual), 0);
+}
+
+int main(void)
+{
+    test_clicks();
+    test_inter_click_timeout();
+    test_hold_vs_click();
+    test_hold_cancels_multi_click();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,244 @@
+/*
+ * Host Test: LED Pattern Sequencer
+ *
+ * Секвенсор прогоняется по синтетическому времени: каждый шаг длится
+ * ровно возвращенную длительность, следующий фронт наступает по ее
+ * окончании. Проверяются длительности включения/выключения каждого
+ * паттерна, повтор по кругу, переходы однократных паттернов и момент
+ * применения запрошенного состояния.
+ */
+
+#include <stddef.h>
+#include "host_test.h"
+#include "led_pattern.h"
+
+#define TEST_MAX_SEGMENTS   64
+
+/* Отрезок времени с постоянным уровнем LED */
+typedef struct {
+    uint8_t level;                   // Уровень LED
+    uint32_t start_ms;               // Начало отрезка
+    uint32_t duration_ms;            // Длительность, 0 - уровень удерживается
+} test_segment_t;
+
+/* Ожидаемый шаг */
+typedef struct {
+    uint8_t level;
+    uint32_t duration_ms;
+} test_step_t;
+
+/**
+ * @brief Прогон секвенсора от now_ms до horizon_ms
+ *
+ * Останавливается на удержании уровня (длительность 0).
+ *
+ * @return Количество отрезков
+ */
+static size_t run(led_sequencer_t *seq, uint32_t *now_ms, uint32_t horizon_ms, test_segment_t *segments)
+{
+    size_t count = 0;
+
+    while (*now_ms < horizon_ms && count < TEST_MAX_SEGMENTS) {
+        uint8_t level = 0xFF;
+        uint32_t duration = led_sequencer_next(seq, &level);
+        segments[count++] = (test_segment_t){ level, *now_ms, duration };
+        if (duration == 0) {
+            break;
+        }
+        *now_ms += duration;
+    }
+    return count;
+}
+
+/**
+ * @brief Отрезки совпадают с ожидаемыми шагами, начиная с first
+ */
+static void check_steps(const test_segment_t *segments, size_t count, size_t first, const test_step_t *steps,
+                        size_t step_count)
+{
+    CHECK(first + step_count <= count);
+    if (first + step_count > count) {
+        return;
+    }
+    for (size_t i = 0; i < step_count; i++) {
+        const test_segment_t *segment = &segments[first + i];
+        if (segment->level != steps[i].level || segment->duration_ms != steps[i].duration_ms) {
+            printf("segment %zu at %u ms: level %u for %u ms, expected level %u for %u ms\n", first + i,
+                   (unsigned)segment->start_ms, segment->level, (unsigned)segment->duration_ms, steps[i].level,
+                   (unsigned)steps[i].duration_ms);
+        }
+        CHECK_EQ(segment->level, steps[i].level);
+        CHECK_EQ(segment->duration_ms, steps[i].duration_ms);
+        if (first + i > 0) {
+            const test_segment_t *prev = segment - 1;
+            CHECK_EQ(segment->start_ms, prev->start_ms + prev->duration_ms);
+        }
+    }
+}
+
+/**
+ * @brief Повторяющийся паттерн: три полных цикла подряд
+ */
+static void check_repeating(led_state_t state, bool relay_active, const test_step_t *cycle, size_t step_count)
+{
+    led_sequencer_t seq;
+    test_segment_t segments[TEST_MAX_SEGMENTS];
+    uint32_t now = 0;
+    uint32_t period = 0;
+
+    for (size_t i = 0; i < step_count; i++) {
+        period += cycle[i].duration_ms;
+    }
+
+    led_sequencer_init(&seq, state);
+    led_sequencer_request(&seq, state, relay_active);
+    size_t count = run(&seq, &now, 3 * period, segments);
+
+    CHECK_EQ(count, 3 * step_count);
+    for (size_t rep = 0; rep < 3; rep++) {
+        check_steps(segments, count, rep * step_count, cycle, step_count);
+        CHECK_EQ(segments[rep * step_count].start_ms, rep * period);
+    }
+}
+
+/* Повторяющиеся паттерны (тайминги README) */
+static void test_repeating_patterns(void)
+{
+    static const test_step_t searching[] = { { 1, 2000 }, { 0, 2000 } };
+    static const test_step_t connecting[] = { { 1, 500 }, { 0, 500 } };
+    static const test_step_t error[] = { { 1, 100 }, { 0, 100 } };
+    static const test_step_t pairing[] = { { 1, 5000 }, { 0, 1000 } };
+    static const test_step_t relay_active[] = { { 1, 300 }, { 0, 300 } };
+    static const test_step_t factory_reset[] = {
+        { 1, 150 }, { 0, 150 }, { 1, 150 }, { 0, 150 }, { 1, 150 }, { 0, 3050 },
+    };
+    static const test_step_t network_lost[] = { { 1, 1000 }, { 0, 500 }, { 1, 1000 }, { 0, 2000 } };
+    static const test_step_t rebooting[] = {
+        { 1, 200 }, { 0, 200 }, { 1, 200 }, { 0, 200 }, { 1, 200 },
+        { 0, 200 }, { 1, 200 }, { 0, 200 }, { 1, 200 }, { 0, 2000 },
+    };
+
+#define CHECK_REPEATING(state, relay, cycle) check_repeating(state, relay, cycle, sizeof(cycle) / sizeof(cycle[0]))
+    CHECK_REPEATING(LED_STATE_SEARCHING, false, searching);
+    CHECK_REPEATING(LED_STATE_CONNECTING, false, connecting);
+    CHECK_REPEATING(LED_STATE_ERROR, false, error);
+    CHECK_REPEATING(LED_STATE_PAIRING, false, pairing);
+    CHECK_REPEATING(LED_STATE_RELAY_ACTIVE, false, relay_active);
+    CHECK_REPEATING(LED_STATE_CONNECTED, true, relay_active);
+    CHECK_REPEATING(LED_STATE_FACTORY_RESET, false, factory_reset);
+    CHECK_REPEATING(LED_STATE_NETWORK_LOST, false, network_lost);
+    CHECK_REPEATING(LED_STATE_REBOOTING, false, rebooting);
+#undef CHECK_REPEATING
+}
+
+/* Удержание уровня: выключен и подключен без активного реле */
+static void test_hold_patterns(void)
+{
+    led_sequencer_t seq;
+    test_segment_t segments[TEST_MAX_SEGMENTS];
+    uint32_t now = 0;
+
+    led_sequencer_init(&seq, LED_STATE_OFF);
+    CHECK_EQ(run(&seq, &now, 10000, segments), 1);
+    CHECK_EQ(segments[0].level, 0);
+    CHECK_EQ(segments[0].duration_ms, 0);
+
+    led_sequencer_init(&seq, LED_STATE_CONNECTED);
+    CHECK_EQ(run(&seq, &now, 10000, segments), 1);
+    CHECK_EQ(segments[0].level, 1);
+    CHECK_EQ(segments[0].duration_ms, 0);
+
+    /* Повторный фронт без запроса не меняет уровень */
+    uint8_t level = 0;
+    CHECK_EQ(led_sequencer_next(&seq, &level), 0);
+    CHECK_EQ(level, 1);
+
+    /* Запрос того же состояния не меняет паттерн */
+    CHECK(!led_sequencer_request(&seq, LED_STATE_CONNECTED, false));
+}
+
+/* Однократные паттерны инициализации переходят к поиску сети */
+static void test_init_sequence(void)
+{
+    static const test_step_t expected[] = {
+        { 1, 200 }, { 0, 500 },                                 // INIT_GPIO
+        { 1, 200 }, { 0, 200 }, { 1, 200 }, { 0, 500 },         // INIT_ZIGBEE
+        { 1, 2000 }, { 0, 2000 }, { 1, 2000 }, { 0, 2000 },     // SEARCHING по кругу
+    };
+    led_sequencer_t seq;
+    test_segment_t segments[TEST_MAX_SEGMENTS];
+    uint32_t now = 0;
+
+    led_sequencer_init(&seq, LED_STATE_INIT_GPIO);
+    size_t count = run(&seq, &now, 700 + 1100 + 8000, segments);
+
+    CHECK_EQ(count, sizeof(expected) / sizeof(expected[0]));
+    check_steps(segments, count, 0, expected, sizeof(expected) / sizeof(expected[0]));
+    CHECK_EQ(segments[2].start_ms, 700);
+    CHECK_EQ(segments[6].start_ms, 1800);
+    CHECK_EQ(seq.state, LED_STATE_SEARCHING);
+}
+
+/* Запрос применяется на ближайшем фронте, текущий шаг не обрывается */
+static void test_request_applies_on_next_edge(void)
+{
+    led_sequencer_t seq;
+    test_segment_t segments[TEST_MAX_SEGMENTS];
+    uint32_t now = 0;
+
+    led_sequencer_init(&seq, LED_STATE_SEARCHING);
+    CHECK_EQ(run(&seq, &now, 1, segments), 1);
+    CHECK_EQ(now, 2000);
+
+    /* Запрос посреди шага 2000 мс: следующий фронт уже по новому паттерну */
+    CHECK(led_sequencer_request(&seq, LED_STATE_ERROR, false));
+    CHECK_EQ(run(&seq, &now, 2400, segments), 4);
+    CHECK_EQ(segments[0].start_ms, 2000);
+    CHECK_EQ(segments[0].level, 1);
+    CHECK_EQ(segments[0].duration_ms, 100);
+    CHECK_EQ(segments[1].level, 0);
+    CHECK_EQ(segments[1].duration_ms, 100);
+}
+
+/* Включение реле в подключенном состоянии переключает удержание на мигание */
+static void test_connected_relay_toggle(void)
+{
+    led_sequencer_t seq;
+    test_segment_t segments[TEST_MAX_SEGMENTS];
+    uint32_t now = 0;
+
+    led_sequencer_init(&seq, LED_STATE_CONNECTED);
+    CHECK_EQ(run(&seq, &now, 1000, segments), 1);
+
+    CHECK(led_sequencer_request(&seq, LED_STATE_CONNECTED, true));
+    CHECK_EQ(run(&seq, &now, 1200, segments), 4);
+    CHECK_EQ(segments[0].level, 1);
+    CHECK_EQ(segments[0].duration_ms, 300);
+    CHECK_EQ(segments[1].level, 0);
+    CHECK_EQ(segments[1].duration_ms, 300);
+
+    /* Реле выключено - снова постоянное свечение с ближайшего фронта */
+    CHECK(led_sequencer_request(&seq, LED_STATE_CONNECTED, false));
+    CHECK_EQ(run(&seq, &now, 10000, segments), 1);
+    CHECK_EQ(segments[0].level, 1);
+    CHECK_EQ(segments[0].duration_ms, 0);
+}
+
+/* Неизвестное состояние отображается как выключенный LED */
+static void test_invalid_state(void)
+{
+    CHECK(led_pattern_get(LED_STATE_MAX, false) == led_pattern_get(LED_STATE_OFF, false));
+    CHECK(led_pattern_get(LED_STATE_CONNECTED, true) != led_pattern_get(LED_STATE_CONNECTED, false));
+    CHECK(led_pattern_get(LED_STATE_SEARCHING, true) == led_pattern_get(LED_STATE_SEARCHING, false));
+}
+
+int main(void)
+{
+    test_repeating_patterns();
+    test_hold_patterns();
+    test_init_sequence();
+    test_request_applies_on_next_edge();
+    test_connected_relay_toggle();
+    test_invalid_state();
+    return HOST_TEST_RESULT();
+}
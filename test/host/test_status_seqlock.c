@@ -0,0 +1,194 @@
+/*
+ * Host Test: Status Seqlock
+ *
+ * Несколько потоков-писателей изменяют device_status_t по одному полю под
+ * seqlock, сериализуясь мьютексом так же, как device_status_write_begin()
+ * и device_status_write_end() сериализуют задачи критической секцией.
+ * Потоки-читатели копируют состояние через status_seqlock_read() - тот
+ * же цикл повтора, что в device_get_status(), - и проверяют, что каждая
+ * копия целиком относится к одной записи и версии не убывают. Перед
+ * повтором копирования читатель уступает процессор (хук
+ * STATUS_SEQLOCK_RETRY_HOOK), иначе на одном ядре он ждал бы вытесненного
+ * писателя до конца кванта.
+ *
+ * Все поля записи k выводятся из k, поэтому разорванная копия (часть
+ * полей от разных записей) обнаруживается по любому полю. Писатели
+ * периодически уступают процессор внутри записи, чтобы гонка
+ * воспроизводилась и на одном ядре, и после каждой записи.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "host_test.h"
+#include "device_config.h"
+
+/* Писатель-поток может быть вытеснен посреди записи - повтор отдает ему процессор */
+#define STATUS_SEQLOCK_RETRY_HOOK()     sched_yield()
+#include "status_seqlock.h"
+
+#define TEST_WRITERS        3
+#define TEST_READERS        3
+#define TEST_SNAPSHOTS      20000    // Копий на каждого читателя
+#define TEST_WRITE_YIELD    0x3F     // Писатель уступает процессор внутри записи раз в 64 записи
+
+static device_status_t g_status;
+static status_seqlock_t s_seq = STATUS_SEQLOCK_INITIALIZER;
+static pthread_mutex_t s_write_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int s_readers_active = TEST_READERS;
+static uint32_t s_writes;                // Номер последней записи (под s_write_lock)
+
+/* Результаты писателя */
+typedef struct {
+    unsigned long writes;            // Выполнено записей
+} test_writer_t;
+
+/* Результаты читателя */
+typedef struct {
+    unsigned long snapshots;         // Проверено копий
+    unsigned long versions;          // Смен версии между соседними копиями
+    unsigned long torn;              // Разорванных копий
+    unsigned long version_errors;    // Версия не соответствует данным или убыла
+} test_reader_t;
+
+/**
+ * @brief Начало записи (как device_status_write_begin)
+ */
+static void test_write_begin(void)
+{
+    pthread_mutex_lock(&s_write_lock);
+    status_seqlock_write_begin(&s_seq);
+}
+
+/**
+ * @brief Завершение записи (как device_status_write_end)
+ */
+static void test_write_end(void)
+{
+    status_seqlock_write_end(&s_seq);
+    pthread_mutex_unlock(&s_write_lock);
+}
+
+/**
+ * @brief Очередная запись: каждое поле выводится из ее номера k
+ */
+static void test_write(void)
+{
+    volatile device_status_t *status = &g_status;
+
+    test_write_begin();
+    uint32_t k = ++s_writes;
+    status->button_press_time = k;
+    status->state = (device_state_t)(k % DEVICE_STATE_MAX);
+    for (uint8_t i = 0; i < RELAY_COUNT; i++) {
+        status->relay_state[i] = ((k >> i) & 1) ? RELAY_ON : RELAY_OFF;
+        if ((k & TEST_WRITE_YIELD) == 0 && i == 0) {
+            sched_yield();
+        }
+    }
+    status->pairing_mode = (k & 1) != 0;
+    status->factory_reset = (k & 2) != 0;
+    status->button_pressed = (k & 4) != 0;
+    test_write_end();
+}
+
+/**
+ * @brief Копия целиком относится к записи button_press_time
+ */
+static bool test_consistent(const device_status_t *status)
+{
+    uint32_t k = status->button_press_time;
+
+    if (status->state != (device_state_t)(k % DEVICE_STATE_MAX)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < RELAY_COUNT; i++) {
+        if (status->relay_state[i] != (((k >> i) & 1) ? RELAY_ON : RELAY_OFF)) {
+            return false;
+        }
+    }
+    return status->pairing_mode == ((k & 1) != 0) && status->factory_reset == ((k & 2) != 0) &&
+           status->button_pressed == ((k & 4) != 0);
+}
+
+static void *test_writer_thread(void *arg)
+{
+    test_writer_t *writer = arg;
+
+    while (atomic_load(&s_readers_active) > 0) {
+        test_write();
+        writer->writes++;
+        /* Задачи прошивки пишут состояние по событиям: окно без записи после каждой */
+        sched_yield();
+    }
+    return NULL;
+}
+
+static void *test_reader_thread(void *arg)
+{
+    test_reader_t *reader = arg;
+    unsigned last_version = 0;
+
+    while (reader->snapshots < TEST_SNAPSHOTS) {
+        /* Чтение как в device_get_status() */
+        device_status_t status;
+        unsigned version = status_seqlock_read(&s_seq, &status, &g_status, sizeof(status)) / 2;
+
+        reader->snapshots++;
+        if (!test_consistent(&status)) {
+            reader->torn++;
+        }
+        if (version != status.button_press_time || version < last_version) {
+            reader->version_errors++;
+        }
+        if (version != last_version) {
+            reader->versions++;
+        }
+        last_version = version;
+        if ((reader->snapshots & 0x0F) == 0) {
+            sched_yield();
+        }
+    }
+
+    atomic_fetch_sub(&s_readers_active, 1);
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t writers[TEST_WRITERS];
+    pthread_t readers[TEST_READERS];
+    test_writer_t writer_results[TEST_WRITERS] = { 0 };
+    test_reader_t reader_results[TEST_READERS] = { 0 };
+
+    for (int i = 0; i < TEST_READERS; i++) {
+        CHECK_EQ(pthread_create(&readers[i], NULL, test_reader_thread, &reader_results[i]), 0);
+    }
+    for (int i = 0; i < TEST_WRITERS; i++) {
+        CHECK_EQ(pthread_create(&writers[i], NULL, test_writer_thread, &writer_results[i]), 0);
+    }
+
+    unsigned long total_writes = 0;
+    for (int i = 0; i < TEST_WRITERS; i++) {
+        CHECK_EQ(pthread_join(writers[i], NULL), 0);
+        printf("writer %d: %lu writes\n", i, writer_results[i].writes);
+        total_writes += writer_results[i].writes;
+    }
+    for (int i = 0; i < TEST_READERS; i++) {
+        CHECK_EQ(pthread_join(readers[i], NULL), 0);
+        printf("reader %d: %lu snapshots, %lu versions, %lu torn, %lu version errors\n", i,
+               reader_results[i].snapshots, reader_results[i].versions, reader_results[i].torn,
+               reader_results[i].version_errors);
+        CHECK_EQ(reader_results[i].torn, 0);
+        CHECK_EQ(reader_results[i].version_errors, 0);
+    }
+
+    /* Записи всех писателей учтены, последняя копия - последняя запись */
+    CHECK_EQ(total_writes, s_writes);
+    device_status_t status;
+    unsigned seq = status_seqlock_read(&s_seq, &status, &g_status, sizeof(status));
+    CHECK_EQ(seq / 2, s_writes);
+    CHECK(test_consistent(&status));
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Декодер отложенного журнала (main/deferred_log.h).
+
+Восстанавливает текст из сырых записей команды консоли "dlog dump":
+    DLOG <мс> <уровень> <адрес тега> <адрес формата> [аргументы...]
+Строки тега, формата и аргументы %s читаются из ELF-файла прошивки по
+адресам. Остальные строки входа выводятся без изменений, поэтому на вход
+можно подавать весь лог монитора.
+
+Использование:
+    python tools/dlog_decode.py build/RoboSR2CH10A.elf dump.txt
+    idf.py monitor | python tools/dlog_decode.py build/RoboSR2CH10A.elf
+
+Требуется pyelftools (входит в окружение ESP-IDF).
+"""
+
+import argparse
+import re
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+RECORD_RE = re.compile(r'DLOG (\d+) (\d+) ([0-9a-fA-F]{8}) ([0-9a-fA-F]{8})((?: [0-9a-fA-F]{8})*)')
+SPEC_RE = re.compile(r'%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<prec>\*|\d+))?'
+                     r'(?P<length>hh|h|ll|l|z|j|t)?(?P<conv>[diouxXcsp%])')
+LEVELS = {1: 'E', 2: 'W', 3: 'I', 4: 'D', 5: 'V'}
+
+
+class ElfStrings:
+    """Чтение строк из загружаемых секций ELF по адресу."""
+
+    def __init__(self, path):
+        self.sections = []
+        with open(path, 'rb') as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section['sh_type'] == 'SHT_PROGBITS' and section['sh_flags'] & 0x2:  # SHF_ALLOC
+                    self.sections.append((section['sh_addr'], section.data()))
+
+    def read(self, addr):
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                end = data.find(b'\0', addr - base)
+                return data[addr - base:end if end >= 0 else len(data)].decode('utf-8', 'replace')
+        return '<0x%08x>' % addr
+
+
+def to_signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def render(fmt, args, strings):
+    """Форматирование в духе printf для 32-битных аргументов."""
+    args = list(args)
+
+    def take():
+        return args.pop(0) if args else 0
+
+    def convert(match):
+        conv = match.group('conv')
+        if conv == '%':
+            return '%'
+        width = match.group('width') or ''
+        prec = match.group('prec')
+        if width == '*':
+            width = str(to_signed(take()))
+        if prec == '*':
+            prec = str(to_signed(take()))
+        spec = '%' + match.group('flags') + width + ('.' + prec if prec is not None else '')
+        value = take()
+        if conv in 'di':
+            return (spec + 'd') % to_signed(value)
+        if conv == 'u':
+            return (spec + 'd') % value
+        if conv in 'oxX':
+            return (spec + conv) % value
+        if conv == 'c':
+            return (spec + 'c') % chr(value & 0xFF)
+        if conv == 's':
+            return (spec + 's') % strings.read(value)
+        return (spec + 's') % ('0x%08x' % value)  # %p
+
+    return SPEC_RE.sub(convert, fmt)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode deferred log records using the firmware ELF')
+    parser.add_argument('elf', help='Firmware ELF file')
+    parser.add_argument('input', nargs='?', type=argparse.FileType('r'), default=sys.stdin,
+                        help='Console output with "dlog dump" records (default: stdin)')
+    args = parser.parse_args()
+
+    strings = ElfStrings(args.elf)
+    for line in args.input:
+        match = RECORD_RE.search(line)
+        if not match:
+            sys.stdout.write(line)
+            continue
+        timestamp, level, tag, fmt, raw_args = match.groups()
+        values = [int(a, 16) for a in raw_args.split()]
+        text = render(strings.read(int(fmt, 16)), values, strings)
+        print('%s (%s) %s: %s' % (LEVELS.get(int(level), '?'), timestamp, strings.read(int(tag, 16)), text))
+
+
+if __name__ == '__main__':
+    main()